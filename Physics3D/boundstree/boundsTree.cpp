@@ -157,6 +157,90 @@ std::array<float, BRANCH_FACTOR> TrunkSIMDHelperFallback::computeAllExtentionCos
 	return resultingCosts;
 }
 
+// slab test, returns the entry distance or RAY_MAX_DISTANCE if the ray misses the bounds or enters them after maxDistance
+static float rayEntryDistance(const BoundsTemplate<float>& bounds, float originX, float originY, float originZ, float invDirX, float invDirY, float invDirZ, float maxDistance) {
+	float t1x = (bounds.min.x - originX) * invDirX;
+	float t2x = (bounds.max.x - originX) * invDirX;
+	float t1y = (bounds.min.y - originY) * invDirY;
+	float t2y = (bounds.max.y - originY) * invDirY;
+	float t1z = (bounds.min.z - originZ) * invDirZ;
+	float t2z = (bounds.max.z - originZ) * invDirZ;
+
+	float tNear = std::max(std::max(std::min(t1x, t2x), std::min(t1y, t2y)), std::max(std::min(t1z, t2z), 0.0f));
+	float tFar = std::min(std::min(std::max(t1x, t2x), std::max(t1y, t2y)), std::min(std::max(t1z, t2z), maxDistance));
+
+	return (tNear <= tFar) ? tNear : RAY_MAX_DISTANCE;
+}
+
+std::array<float, BRANCH_FACTOR> TrunkSIMDHelperFallback::computeRayEntryDistances(const TreeTrunk& trunk, int trunkSize, const TreeRay& ray, float maxDistance) {
+	std::array<float, BRANCH_FACTOR> result;
+	for(int i = 0; i < trunkSize; i++) {
+		result[i] = rayEntryDistance(trunk.getBoundsOfSubNode(i), ray.origin.x, ray.origin.y, ray.origin.z, ray.invDirection.x, ray.invDirection.y, ray.invDirection.z, maxDistance);
+	}
+	return result;
+}
+
+RayPacketHits TrunkSIMDHelperFallback::computeRayPacketHits(const TreeTrunk& trunk, int trunkSize, const TreeRayPacket& packet, unsigned int activeRays) {
+	RayPacketHits result;
+	for(int i = 0; i < trunkSize; i++) {
+		BoundsTemplate<float> bounds = trunk.getBoundsOfSubNode(i);
+		unsigned int hitMask = 0;
+		float nearestEntry = RAY_MAX_DISTANCE;
+		for(int r = 0; r < RAY_PACKET_SIZE; r++) {
+			if((activeRays & (1U << r)) == 0) continue;
+			float entry = rayEntryDistance(bounds, packet.originX[r], packet.originY[r], packet.originZ[r], packet.invDirectionX[r], packet.invDirectionY[r], packet.invDirectionZ[r], packet.maxDistance[r]);
+			if(entry < RAY_MAX_DISTANCE) {
+				hitMask |= 1U << r;
+				nearestEntry = std::min(nearestEntry, entry);
+			}
+		}
+		result.hitMasks[i] = hitMask;
+		result.nearestEntry[i] = nearestEntry;
+	}
+	return result;
+}
+
+std::array<float, BRANCH_FACTOR> TrunkSIMDHelperFallback::computeDistancesSquaredTo(const TreeTrunk& trunk, int trunkSize, const Vec3f& point) {
+	std::array<float, BRANCH_FACTOR> result;
+	for(int i = 0; i < trunkSize; i++) {
+		BoundsTemplate<float> bounds = trunk.getBoundsOfSubNode(i);
+		float dx = std::max(std::max(bounds.min.x - point.x, point.x - bounds.max.x), 0.0f);
+		float dy = std::max(std::max(bounds.min.y - point.y, point.y - bounds.max.y), 0.0f);
+		float dz = std::max(std::max(bounds.min.z - point.z, point.z - bounds.max.z), 0.0f);
+		result[i] = dx * dx + dy * dy + dz * dz;
+	}
+	return result;
+}
+
+FrustumCullResult TrunkSIMDHelperFallback::computeFrustumCulling(const TreeTrunk& trunk, int trunkSize, const TreeFrustum& frustum, unsigned int activePlanes) {
+	FrustumCullResult result;
+	result.visibleMask = 0;
+	for(int i = 0; i < trunkSize; i++) {
+		BoundsTemplate<float> bounds = trunk.getBoundsOfSubNode(i);
+		bool visible = true;
+		unsigned int planesInside = 0;
+		for(int p = 0; p < FRUSTUM_PLANE_COUNT; p++) {
+			if((activePlanes & (1U << p)) == 0) continue;
+			const Vec3f& normal = frustum.normals[p];
+			// the corner furthest against the normal decides if the box is outside, the corner furthest along it if it is inside
+			float nearDot = normal.x * (((normal.x >= 0) ? bounds.min.x : bounds.max.x) - frustum.origin.x)
+				+ normal.y * (((normal.y >= 0) ? bounds.min.y : bounds.max.y) - frustum.origin.y)
+				+ normal.z * (((normal.z >= 0) ? bounds.min.z : bounds.max.z) - frustum.origin.z);
+			float farDot = normal.x * (((normal.x >= 0) ? bounds.max.x : bounds.min.x) - frustum.origin.x)
+				+ normal.y * (((normal.y >= 0) ? bounds.max.y : bounds.min.y) - frustum.origin.y)
+				+ normal.z * (((normal.z >= 0) ? bounds.max.z : bounds.min.z) - frustum.origin.z);
+			if(nearDot > frustum.offsets[p]) {
+				visible = false;
+				break;
+			}
+			if(farDot <= frustum.offsets[p]) planesInside |= 1U << p;
+		}
+		if(visible) result.visibleMask |= 1U << i;
+		result.planesInside[i] = planesInside;
+	}
+	return result;
+}
+
 int TrunkSIMDHelperFallback::transferNodes(TreeTrunk& srcTrunk, int srcTrunkStart, int srcTrunkEnd, TreeTrunk& destTrunk, int destTrunkSize) {
 	for(int i = srcTrunkStart; i < srcTrunkEnd; i++) {
 		destTrunk.setSubNode(destTrunkSize, std::move(srcTrunk.subNodes[i]), srcTrunk.getBoundsOfSubNode(i));
@@ -547,12 +631,10 @@ TrunkAllocator& TrunkAllocator::operator=(TrunkAllocator&& other) noexcept {
 
 TreeTrunk* TrunkAllocator::allocTrunk() {
 	this->allocationCount++;
-	std::cout << "allocTrunk " << this->allocationCount << std::endl;
 	return static_cast<TreeTrunk*>(aligned_malloc(sizeof(TreeTrunk), alignof(TreeTrunk)));
 }
 void TrunkAllocator::freeTrunk(TreeTrunk* trunk) {
 	this->allocationCount--;
-	std::cout << "freeTrunk " << this->allocationCount << std::endl;
 	aligned_free(trunk);
 }
 void TrunkAllocator::freeAllTrunks(TreeTrunk& baseTrunk, int baseTrunkSize) {
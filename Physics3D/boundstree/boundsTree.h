@@ -14,6 +14,9 @@
 #include <optional>
 #include <iostream>
 #include <stack>
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
 
 namespace P3D {
 constexpr int BRANCH_FACTOR = 8;
@@ -219,6 +222,75 @@ struct OverlapMatrix {
 	inline const bool* operator[](size_t idx) const {return overlapData+BRANCH_FACTOR*idx;}
 };
 
+// a ray in the float coordinates of the tree, distances along it are in multiples of the original direction
+struct TreeRay {
+	Vec3f origin;
+	Vec3f invDirection;
+
+	TreeRay() = default;
+	inline TreeRay(const Vec3f& origin, const Vec3f& direction) : origin(origin) {
+		// zero components are nudged so that the slab test never computes 0 * infinity
+		for(int i = 0; i < 3; i++) {
+			float d = direction[i];
+			if(std::abs(d) < 1E-20f) d = (d < 0.0f) ? -1E-20f : 1E-20f;
+			invDirection[i] = 1.0f / d;
+		}
+	}
+};
+
+// ray distances are capped at this, it is the entry distance of subnodes a ray misses
+// finite rather than infinity, the release build uses -Ofast which assumes finite math and may fold comparisons with infinity away
+constexpr float RAY_MAX_DISTANCE = std::numeric_limits<float>::max();
+
+constexpr int RAY_PACKET_SIZE = 8;
+
+// up to RAY_PACKET_SIZE rays tested together, preferably close together and pointing in similar directions
+struct alignas(32) TreeRayPacket {
+	float originX[RAY_PACKET_SIZE]{};
+	float originY[RAY_PACKET_SIZE]{};
+	float originZ[RAY_PACKET_SIZE]{};
+	float invDirectionX[RAY_PACKET_SIZE]{};
+	float invDirectionY[RAY_PACKET_SIZE]{};
+	float invDirectionZ[RAY_PACKET_SIZE]{};
+	// nearest hit found so far for each ray, only nodes entered before this are visited
+	float maxDistance[RAY_PACKET_SIZE]{};
+
+	inline void setRay(int index, const TreeRay& ray, float rayMaxDistance) {
+		assert(index >= 0 && index < RAY_PACKET_SIZE);
+		originX[index] = ray.origin.x;
+		originY[index] = ray.origin.y;
+		originZ[index] = ray.origin.z;
+		invDirectionX[index] = ray.invDirection.x;
+		invDirectionY[index] = ray.invDirection.y;
+		invDirectionZ[index] = ray.invDirection.z;
+		maxDistance[index] = rayMaxDistance;
+	}
+};
+
+struct RayPacketHits {
+	// bit r is set if ray r of the packet hits the subnode
+	unsigned int hitMasks[BRANCH_FACTOR];
+	// nearest entry distance of the rays that hit the subnode
+	float nearestEntry[BRANCH_FACTOR];
+};
+
+constexpr int FRUSTUM_PLANE_COUNT = 5;
+constexpr unsigned int ALL_FRUSTUM_PLANES = (1U << FRUSTUM_PLANE_COUNT) - 1;
+
+// convex region bounded by planes with outward facing normals, a point p is inside if (p - origin) * normals[i] <= offsets[i] for every plane
+struct TreeFrustum {
+	Vec3f origin;
+	Vec3f normals[FRUSTUM_PLANE_COUNT];
+	float offsets[FRUSTUM_PLANE_COUNT];
+};
+
+struct FrustumCullResult {
+	// bit i is set if subnode i is at least partially inside the frustum
+	unsigned int visibleMask;
+	// bit p of planesInside[i] is set if subnode i lies entirely on the inner side of plane p
+	unsigned int planesInside[BRANCH_FACTOR];
+};
+
 struct TrunkSIMDHelperFallback {
 	static BoundsTemplate<float> getTotalBounds(const TreeTrunk& trunk, int upTo);
 	static BoundsTemplate<float> getTotalBoundsWithout(const TreeTrunk& trunk, int upTo, int without);
@@ -239,6 +311,15 @@ struct TrunkSIMDHelperFallback {
 
 	static std::array<float, BRANCH_FACTOR> computeAllExtentionCosts(const TreeTrunk& trunk, int trunkSize, const BoundsTemplate<float>& extraBounds);
 
+	// distance at which the ray enters each subnode, RAY_MAX_DISTANCE for subnodes it misses or enters after maxDistance
+	static std::array<float, BRANCH_FACTOR> computeRayEntryDistances(const TreeTrunk& trunk, int trunkSize, const TreeRay& ray, float maxDistance);
+	// only the rays in activeRays are tested
+	static RayPacketHits computeRayPacketHits(const TreeTrunk& trunk, int trunkSize, const TreeRayPacket& packet, unsigned int activeRays);
+	// squared distance from point to the bounds of each subnode, 0 for subnodes that contain point
+	static std::array<float, BRANCH_FACTOR> computeDistancesSquaredTo(const TreeTrunk& trunk, int trunkSize, const Vec3f& point);
+	// only the planes in activePlanes are tested, the others are assumed to contain the whole trunk
+	static FrustumCullResult computeFrustumCulling(const TreeTrunk& trunk, int trunkSize, const TreeFrustum& frustum, unsigned int activePlanes);
+
 	// returns resulting destTrunk size
 	static int transferNodes(TreeTrunk& srcTrunk, int srcTrunkStart, int srcTrunkEnd, TreeTrunk& destTrunk, int destTrunkSize);
 	
@@ -248,6 +329,15 @@ struct TrunkSIMDHelperFallback {
 	static bool exchangeNodesBetween(TreeTrunk& trunkA, int& trunkASize, TreeTrunk& trunkB, int& trunkBSize);
 };
 
+// AVX versions of the query functions of TrunkSIMDHelperFallback, only usable if CPUIDCheck reports AVX
+struct TrunkSIMDHelperAVX {
+	static std::array<float, BRANCH_FACTOR> computeRayEntryDistances(const TreeTrunk& trunk, int trunkSize, const TreeRay& ray, float maxDistance);
+	static RayPacketHits computeRayPacketHits(const TreeTrunk& trunk, int trunkSize, const TreeRayPacket& packet, unsigned int activeRays);
+	static std::array<bool, BRANCH_FACTOR> computeOverlapsWith(const TreeTrunk& trunk, int trunkSize, const BoundsTemplate<float>& bounds);
+	static std::array<float, BRANCH_FACTOR> computeDistancesSquaredTo(const TreeTrunk& trunk, int trunkSize, const Vec3f& point);
+	static FrustumCullResult computeFrustumCulling(const TreeTrunk& trunk, int trunkSize, const TreeFrustum& frustum, unsigned int activePlanes);
+};
+
 template<typename CastTo, typename GetObjectBoundsFunc>
 inline BoundsTemplate<float> TreeNodeRef::recalculateBoundsRecursive(const GetObjectBoundsFunc& getObjBounds) {
 	int sizeData = getSizeData();
@@ -542,6 +632,226 @@ void forEachColissionInternalRecursive(const TreeTrunk& curTrunk, int curTrunkSi
 	}
 }
 
+// sorts the indices of the subnodes that were hit by increasing entry distance, returns the number of hit subnodes
+// subnodes with an entry distance of RAY_MAX_DISTANCE are left out
+inline int sortHitSubNodesByDistance(const float* entryDistances, int trunkSize, int* order) {
+	int hitCount = 0;
+	for(int i = 0; i < trunkSize; i++) {
+		float entry = entryDistances[i];
+		if(!(entry < RAY_MAX_DISTANCE)) continue;
+		int j = hitCount++;
+		for(; j > 0 && entryDistances[order[j - 1]] > entry; j--) {
+			order[j] = order[j - 1];
+		}
+		order[j] = i;
+	}
+	return hitCount;
+}
+
+// expects a function of the form double(Boundable& object, double maxDistance)
+// which returns the distance at which the ray hits the object, or anything >= maxDistance if it doesn't
+// Visits subnodes front to back, maxDistance is lowered to every hit found so nodes behind the nearest hit are skipped
+template<typename Boundable, typename SIMDHelper, typename Func>
+void raycastRecursive(const TreeTrunk& trunk, int trunkSize, const TreeRay& ray, double& maxDistance, const Func& func) {
+	std::array<float, BRANCH_FACTOR> entryDistances = SIMDHelper::computeRayEntryDistances(trunk, trunkSize, ray, static_cast<float>(std::min(maxDistance, static_cast<double>(RAY_MAX_DISTANCE))));
+
+	int order[BRANCH_FACTOR];
+	int hitCount = sortHitSubNodesByDistance(entryDistances.data(), trunkSize, order);
+
+	for(int k = 0; k < hitCount; k++) {
+		int i = order[k];
+		if(entryDistances[i] > maxDistance) break;
+
+		const TreeNodeRef& subNode = trunk.subNodes[i];
+		if(subNode.isTrunkNode()) {
+			raycastRecursive<Boundable, SIMDHelper, Func>(subNode.asTrunk(), subNode.getTrunkSize(), ray, maxDistance, func);
+		} else {
+			double distance = func(*static_cast<Boundable*>(subNode.asObject()), maxDistance);
+			if(distance < maxDistance) maxDistance = distance;
+		}
+	}
+}
+
+// expects a function of the form double(Boundable& object, int rayIndex, double maxDistance), like raycastRecursive but for ray rayIndex of the packet
+// maxDistances holds the nearest hit of every ray of the packet, packet.maxDistance is kept in sync with it
+// The whole packet descends into a subnode as soon as one of its active rays hits it
+template<typename Boundable, typename SIMDHelper, typename Func>
+void raycastPacketRecursive(const TreeTrunk& trunk, int trunkSize, TreeRayPacket& packet, double* maxDistances, unsigned int activeRays, const Func& func) {
+	RayPacketHits hits = SIMDHelper::computeRayPacketHits(trunk, trunkSize, packet, activeRays);
+
+	int order[BRANCH_FACTOR];
+	int hitCount = sortHitSubNodesByDistance(hits.nearestEntry, trunkSize, order);
+
+	for(int k = 0; k < hitCount; k++) {
+		int i = order[k];
+		unsigned int rays = hits.hitMasks[i];
+
+		const TreeNodeRef& subNode = trunk.subNodes[i];
+		if(subNode.isTrunkNode()) {
+			raycastPacketRecursive<Boundable, SIMDHelper, Func>(subNode.asTrunk(), subNode.getTrunkSize(), packet, maxDistances, rays, func);
+		} else {
+			Boundable& object = *static_cast<Boundable*>(subNode.asObject());
+			for(int r = 0; r < RAY_PACKET_SIZE; r++) {
+				if((rays & (1U << r)) == 0) continue;
+				double distance = func(object, r, maxDistances[r]);
+				if(distance < maxDistances[r]) {
+					maxDistances[r] = distance;
+					packet.maxDistance[r] = static_cast<float>(std::min(distance, static_cast<double>(RAY_MAX_DISTANCE)));
+				}
+			}
+		}
+	}
+}
+
+// expects a function of the form void(Boundable& object)
+// Calls the given function for each object whose bounds overlap the given bounds
+template<typename Boundable, typename SIMDHelper, typename Func>
+void forEachInBoundsRecursive(const TreeTrunk& trunk, int trunkSize, const BoundsTemplate<float>& bounds, const Func& func) {
+	std::array<bool, BRANCH_FACTOR> overlaps = SIMDHelper::computeOverlapsWith(trunk, trunkSize, bounds);
+
+	for(int i = 0; i < trunkSize; i++) {
+		if(!overlaps[i]) continue;
+
+		const TreeNodeRef& subNode = trunk.subNodes[i];
+		if(subNode.isTrunkNode()) {
+			forEachInBoundsRecursive<Boundable, SIMDHelper, Func>(subNode.asTrunk(), subNode.getTrunkSize(), bounds, func);
+		} else {
+			func(*static_cast<Boundable*>(subNode.asObject()));
+		}
+	}
+}
+
+// expects a function of the form void(Boundable& object)
+// Calls the given function for each object whose bounds are within sqrt(radiusSq) of center
+template<typename Boundable, typename SIMDHelper, typename Func>
+void forEachInSphereRecursive(const TreeTrunk& trunk, int trunkSize, const Vec3f& center, float radiusSq, const Func& func) {
+	std::array<float, BRANCH_FACTOR> distancesSq = SIMDHelper::computeDistancesSquaredTo(trunk, trunkSize, center);
+
+	for(int i = 0; i < trunkSize; i++) {
+		if(distancesSq[i] > radiusSq) continue;
+
+		const TreeNodeRef& subNode = trunk.subNodes[i];
+		if(subNode.isTrunkNode()) {
+			forEachInSphereRecursive<Boundable, SIMDHelper, Func>(subNode.asTrunk(), subNode.getTrunkSize(), center, radiusSq, func);
+		} else {
+			func(*static_cast<Boundable*>(subNode.asObject()));
+		}
+	}
+}
+
+// expects a function of the form void(Boundable& object)
+// Calls the given function for each object whose bounds are at least partially inside the frustum
+// activePlanes holds the planes the trunk is not known to be entirely inside of, subtrunks inside all planes are visited without any further tests
+template<typename Boundable, typename SIMDHelper, typename Func>
+void forEachInFrustumRecursive(const TreeTrunk& trunk, int trunkSize, const TreeFrustum& frustum, unsigned int activePlanes, const Func& func) {
+	FrustumCullResult culled = SIMDHelper::computeFrustumCulling(trunk, trunkSize, frustum, activePlanes);
+
+	for(int i = 0; i < trunkSize; i++) {
+		if((culled.visibleMask & (1U << i)) == 0) continue;
+
+		const TreeNodeRef& subNode = trunk.subNodes[i];
+		if(subNode.isTrunkNode()) {
+			unsigned int remainingPlanes = activePlanes & ~culled.planesInside[i];
+			if(remainingPlanes == 0) {
+				forEachRecurse<Boundable, Func>(subNode.asTrunk(), subNode.getTrunkSize(), func);
+			} else {
+				forEachInFrustumRecursive<Boundable, SIMDHelper, Func>(subNode.asTrunk(), subNode.getTrunkSize(), frustum, remainingPlanes, func);
+			}
+		} else {
+			func(*static_cast<Boundable*>(subNode.asObject()));
+		}
+	}
+}
+
+// The nearest objects found so far by a k nearest query, sorted by increasing distance
+// Stored in caller provided buffers of size k, so it can be shared between several trees
+template<typename Boundable>
+struct NearestObjects {
+	Boundable** objects;
+	float* distancesSq;
+	std::size_t k;
+	std::size_t count = 0;
+
+	NearestObjects(Boundable** objects, float* distancesSq, std::size_t k) : objects(objects), distancesSq(distancesSq), k(k) {}
+
+	// objects at or beyond this distance can't be part of the result anymore
+	// finite while the buffers aren't full, like RAY_MAX_DISTANCE, so -Ofast can't fold the comparisons with it away
+	inline float getMaxDistanceSq() const {
+		if(count < k) return std::numeric_limits<float>::max();
+		return (k == 0) ? 0.0f : distancesSq[k - 1];
+	}
+
+	// expects distanceSq < getMaxDistanceSq(), drops the furthest object if the buffers are full
+	inline void add(Boundable* object, float distanceSq) {
+		std::size_t i = (count < k) ? count++ : k - 1;
+		for(; i > 0 && distancesSq[i - 1] > distanceSq; i--) {
+			objects[i] = objects[i - 1];
+			distancesSq[i] = distancesSq[i - 1];
+		}
+		objects[i] = object;
+		distancesSq[i] = distanceSq;
+	}
+};
+
+// trunks waiting to be expanded by a k nearest query, the queue lives on the stack so queries don't allocate
+constexpr int NEAREST_QUEUE_CAPACITY = 128;
+
+struct NearestQueueEntry {
+	float distanceSq;
+	const TreeTrunk* trunk;
+	int trunkSize;
+};
+
+inline bool isFurtherInNearestQueue(const NearestQueueEntry& a, const NearestQueueEntry& b) {
+	return a.distanceSq > b.distanceSq;
+}
+
+// expects a function of the form float(Boundable& object, float boundsDistanceSq)
+// which returns the squared distance from the query point to the object, it must not be smaller than boundsDistanceSq
+// Objects are added to nearest directly, subtrunks that may still hold nearer objects are pushed on the queue
+// If the queue is full the subtrunk is searched depth first instead, which gives the same result
+template<typename Boundable, typename SIMDHelper, typename Func>
+void expandNearestTrunk(const TreeTrunk& trunk, int trunkSize, const Vec3f& point, NearestObjects<Boundable>& nearest, NearestQueueEntry* queue, int& queueSize, const Func& distanceSqFunc) {
+	std::array<float, BRANCH_FACTOR> distancesSq = SIMDHelper::computeDistancesSquaredTo(trunk, trunkSize, point);
+
+	for(int i = 0; i < trunkSize; i++) {
+		if(distancesSq[i] >= nearest.getMaxDistanceSq()) continue;
+
+		const TreeNodeRef& subNode = trunk.subNodes[i];
+		if(subNode.isTrunkNode()) {
+			if(queueSize < NEAREST_QUEUE_CAPACITY) {
+				queue[queueSize++] = NearestQueueEntry{distancesSq[i], &subNode.asTrunk(), subNode.getTrunkSize()};
+				std::push_heap(queue, queue + queueSize, isFurtherInNearestQueue);
+			} else {
+				expandNearestTrunk<Boundable, SIMDHelper, Func>(subNode.asTrunk(), subNode.getTrunkSize(), point, nearest, queue, queueSize, distanceSqFunc);
+			}
+		} else {
+			Boundable* object = static_cast<Boundable*>(subNode.asObject());
+			float distanceSq = distanceSqFunc(*object, distancesSq[i]);
+			if(distanceSq < nearest.getMaxDistanceSq()) {
+				nearest.add(object, distanceSq);
+			}
+		}
+	}
+}
+
+// Best first search, always expands the trunk nearest to point next and stops once that trunk is further than the k-th nearest object found
+template<typename Boundable, typename SIMDHelper, typename Func>
+void findNearestBestFirst(const TreeTrunk& baseTrunk, int baseTrunkSize, const Vec3f& point, NearestObjects<Boundable>& nearest, const Func& distanceSqFunc) {
+	NearestQueueEntry queue[NEAREST_QUEUE_CAPACITY];
+	int queueSize = 0;
+
+	expandNearestTrunk<Boundable, SIMDHelper, Func>(baseTrunk, baseTrunkSize, point, nearest, queue, queueSize, distanceSqFunc);
+
+	while(queueSize > 0) {
+		std::pop_heap(queue, queue + queueSize, isFurtherInNearestQueue);
+		NearestQueueEntry next = queue[--queueSize];
+		if(next.distanceSq >= nearest.getMaxDistanceSq()) break;
+
+		expandNearestTrunk<Boundable, SIMDHelper, Func>(*next.trunk, next.trunkSize, point, nearest, queue, queueSize, distanceSqFunc);
+	}
+}
+
 class BoundsTreeIteratorPrototype {
 	struct StackElement {
 		const TreeTrunk* trunk;
@@ -836,6 +1146,26 @@ void recalculateBoundsRecursive(TreeTrunk& curTrunk, int curTrunkSize) {
 	}
 }
 
+// leaves for which shouldRecalculate(const Boundable&) returns false keep their current bounds
+template<typename Boundable, typename Pred>
+void recalculateBoundsRecursive(TreeTrunk& curTrunk, int curTrunkSize, const Pred& shouldRecalculate) {
+	for(int i = 0; i < curTrunkSize; i++) {
+		TreeNodeRef& subNode = curTrunk.subNodes[i];
+
+		if(subNode.isTrunkNode()) {
+			TreeTrunk& subTrunk = subNode.asTrunk();
+			int subTrunkSize = subNode.getTrunkSize();
+			recalculateBoundsRecursive<Boundable>(subTrunk, subTrunkSize, shouldRecalculate);
+			curTrunk.setBoundsOfSubNode(i, TrunkSIMDHelperFallback::getTotalBounds(subTrunk, subTrunkSize));
+		} else {
+			Boundable* object = static_cast<Boundable*>(subNode.asObject());
+			if(shouldRecalculate(static_cast<const Boundable&>(*object))) {
+				curTrunk.setBoundsOfSubNode(i, object->getBounds());
+			}
+		}
+	}
+}
+
 template<typename Boundable>
 bool updateGroupBoundsRecursive(TreeTrunk& curTrunk, int curTrunkSize, const Boundable* groupRep, const BoundsTemplate<float>& originalGroupRepBounds) {
 	assert(curTrunkSize >= 0 && curTrunkSize <= BRANCH_FACTOR);
@@ -1062,10 +1392,87 @@ public:
 		forEachColissionBetweenRecursive<Boundable, TrunkSIMDHelperFallback, Func>(this->tree.baseTrunk, this->tree.baseTrunkSize, other.tree.baseTrunk, other.tree.baseTrunkSize, func);
 	}
 
+	// expects a function of the form double(Boundable& object, double maxDistance), see raycastRecursive
+	// returns the distance of the nearest hit, or maxDistance if nothing was hit
+	template<typename SIMDHelper = TrunkSIMDHelperFallback, typename Func>
+	double raycast(const TreeRay& ray, double maxDistance, const Func& func) const {
+		raycastRecursive<Boundable, SIMDHelper, Func>(this->tree.baseTrunk, this->tree.baseTrunkSize, ray, maxDistance, func);
+		return maxDistance;
+	}
+
+	// expects a function of the form double(Boundable& object, int rayIndex, double maxDistance), see raycastPacketRecursive
+	template<typename SIMDHelper = TrunkSIMDHelperFallback, typename Func>
+	void raycastPacket(TreeRayPacket& packet, double* maxDistances, unsigned int activeRays, const Func& func) const {
+		raycastPacketRecursive<Boundable, SIMDHelper, Func>(this->tree.baseTrunk, this->tree.baseTrunkSize, packet, maxDistances, activeRays, func);
+	}
+
+	// expects a function of the form void(Boundable& object), called for every object whose bounds overlap bounds
+	template<typename SIMDHelper = TrunkSIMDHelperFallback, typename Func>
+	void forEachInBounds(const BoundsTemplate<float>& bounds, const Func& func) const {
+		forEachInBoundsRecursive<Boundable, SIMDHelper, Func>(this->tree.baseTrunk, this->tree.baseTrunkSize, bounds, func);
+	}
+
+	// expects a function of the form void(Boundable& object), called for every object whose bounds are within radius of center
+	template<typename SIMDHelper = TrunkSIMDHelperFallback, typename Func>
+	void forEachInSphere(const Vec3f& center, float radius, const Func& func) const {
+		forEachInSphereRecursive<Boundable, SIMDHelper, Func>(this->tree.baseTrunk, this->tree.baseTrunkSize, center, radius * radius, func);
+	}
+
+	// expects a function of the form void(Boundable& object), called for every object whose bounds are at least partially inside frustum
+	template<typename SIMDHelper = TrunkSIMDHelperFallback, typename Func>
+	void forEachInFrustum(const TreeFrustum& frustum, const Func& func) const {
+		forEachInFrustumRecursive<Boundable, SIMDHelper, Func>(this->tree.baseTrunk, this->tree.baseTrunkSize, frustum, ALL_FRUSTUM_PLANES, func);
+	}
+
+	// writes the objects whose bounds overlap box to results, at most maxResults of them
+	// returns the total number of overlapping objects, which may be larger than maxResults
+	template<typename SIMDHelper = TrunkSIMDHelperFallback>
+	std::size_t queryBox(const BoundsTemplate<float>& box, Boundable** results, std::size_t maxResults) const {
+		std::size_t count = 0;
+		forEachInBounds<SIMDHelper>(box, [&](Boundable& object) {
+			if(count < maxResults) results[count] = &object;
+			count++;
+		});
+		return count;
+	}
+
+	// writes the objects whose bounds are within radius of center to results, at most maxResults of them
+	// returns the total number of objects found, which may be larger than maxResults
+	template<typename SIMDHelper = TrunkSIMDHelperFallback>
+	std::size_t querySphere(const Vec3f& center, float radius, Boundable** results, std::size_t maxResults) const {
+		std::size_t count = 0;
+		forEachInSphere<SIMDHelper>(center, radius, [&](Boundable& object) {
+			if(count < maxResults) results[count] = &object;
+			count++;
+		});
+		return count;
+	}
+
+	// adds the objects of this tree nearest to point to nearest, see expandNearestTrunk for distanceSqFunc
+	template<typename SIMDHelper = TrunkSIMDHelperFallback, typename Func>
+	void queryKNearest(const Vec3f& point, NearestObjects<Boundable>& nearest, const Func& distanceSqFunc) const {
+		findNearestBestFirst<Boundable, SIMDHelper, Func>(this->tree.baseTrunk, this->tree.baseTrunkSize, point, nearest, distanceSqFunc);
+	}
+
+	// writes the k objects whose bounds are nearest to point to results, sorted by distance, and their squared distances to distancesSq
+	// returns the number of objects written, less than k if the tree holds fewer objects
+	template<typename SIMDHelper = TrunkSIMDHelperFallback>
+	std::size_t queryKNearest(const Vec3f& point, std::size_t k, Boundable** results, float* distancesSq) const {
+		NearestObjects<Boundable> nearest(results, distancesSq, k);
+		queryKNearest<SIMDHelper>(point, nearest, [](Boundable&, float boundsDistanceSq) { return boundsDistanceSq; });
+		return nearest.count;
+	}
+
 	void recalculateBounds() {
 		recalculateBoundsRecursive<Boundable>(this->tree.baseTrunk, this->tree.baseTrunkSize);
 	}
 
+	// expects a predicate of type bool(const Boundable&), objects for which it returns false keep their current bounds
+	template<typename Pred>
+	void recalculateBounds(const Pred& shouldRecalculate) {
+		recalculateBoundsRecursive<Boundable>(this->tree.baseTrunk, this->tree.baseTrunkSize, shouldRecalculate);
+	}
+
 	void improveStructure() { tree.improveStructure(); }
 	void maxImproveStructure() { tree.maxImproveStructure(); }
 };
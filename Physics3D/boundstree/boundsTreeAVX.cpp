@@ -90,4 +90,151 @@ OverlapMatrix TrunkSIMDHelperFallback::computeBoundsOverlapMatrixAVX(const TreeT
 
 
 
+// slab test of 8 boxes against one ray or one box against 8 rays, RAY_MAX_DISTANCE where there is no hit before maxDistance
+static inline __m256 rayEntryDistances(__m256 xMin, __m256 yMin, __m256 zMin, __m256 xMax, __m256 yMax, __m256 zMax, __m256 originX, __m256 originY, __m256 originZ, __m256 invDirX, __m256 invDirY, __m256 invDirZ, __m256 maxDistance) {
+	__m256 t1x = _mm256_mul_ps(_mm256_sub_ps(xMin, originX), invDirX);
+	__m256 t2x = _mm256_mul_ps(_mm256_sub_ps(xMax, originX), invDirX);
+	__m256 t1y = _mm256_mul_ps(_mm256_sub_ps(yMin, originY), invDirY);
+	__m256 t2y = _mm256_mul_ps(_mm256_sub_ps(yMax, originY), invDirY);
+	__m256 t1z = _mm256_mul_ps(_mm256_sub_ps(zMin, originZ), invDirZ);
+	__m256 t2z = _mm256_mul_ps(_mm256_sub_ps(zMax, originZ), invDirZ);
+
+	__m256 tNear = _mm256_max_ps(_mm256_max_ps(_mm256_min_ps(t1x, t2x), _mm256_min_ps(t1y, t2y)), _mm256_max_ps(_mm256_min_ps(t1z, t2z), _mm256_setzero_ps()));
+	__m256 tFar = _mm256_min_ps(_mm256_min_ps(_mm256_max_ps(t1x, t2x), _mm256_max_ps(t1y, t2y)), _mm256_min_ps(_mm256_max_ps(t1z, t2z), maxDistance));
+
+	__m256 hits = _mm256_cmp_ps(tNear, tFar, _CMP_LE_OQ);
+	return _mm256_blendv_ps(_mm256_set1_ps(RAY_MAX_DISTANCE), tNear, hits);
+}
+
+std::array<float, BRANCH_FACTOR> TrunkSIMDHelperAVX::computeRayEntryDistances(const TreeTrunk& trunk, int, const TreeRay& ray, float maxDistance) {
+	static_assert(BRANCH_FACTOR == 8, "AVX ray test expects 8 subnodes per trunk");
+	const BoundsArray<BRANCH_FACTOR>& bounds = trunk.subNodeBounds;
+
+	__m256 entries = rayEntryDistances(
+		_mm256_load_ps(bounds.xMin), _mm256_load_ps(bounds.yMin), _mm256_load_ps(bounds.zMin),
+		_mm256_load_ps(bounds.xMax), _mm256_load_ps(bounds.yMax), _mm256_load_ps(bounds.zMax),
+		_mm256_set1_ps(ray.origin.x), _mm256_set1_ps(ray.origin.y), _mm256_set1_ps(ray.origin.z),
+		_mm256_set1_ps(ray.invDirection.x), _mm256_set1_ps(ray.invDirection.y), _mm256_set1_ps(ray.invDirection.z),
+		_mm256_set1_ps(maxDistance)
+	);
+
+	alignas(32) std::array<float, BRANCH_FACTOR> result;
+	_mm256_store_ps(result.data(), entries);
+	return result;
+}
+
+RayPacketHits TrunkSIMDHelperAVX::computeRayPacketHits(const TreeTrunk& trunk, int trunkSize, const TreeRayPacket& packet, unsigned int activeRays) {
+	static_assert(RAY_PACKET_SIZE == 8, "AVX packet test expects 8 rays per packet");
+	RayPacketHits result;
+
+	__m256 originX = _mm256_load_ps(packet.originX);
+	__m256 originY = _mm256_load_ps(packet.originY);
+	__m256 originZ = _mm256_load_ps(packet.originZ);
+	__m256 invDirX = _mm256_load_ps(packet.invDirectionX);
+	__m256 invDirY = _mm256_load_ps(packet.invDirectionY);
+	__m256 invDirZ = _mm256_load_ps(packet.invDirectionZ);
+	__m256 maxDistance = _mm256_load_ps(packet.maxDistance);
+
+	alignas(32) float entryBuf[RAY_PACKET_SIZE];
+
+	for(int i = 0; i < trunkSize; i++) {
+		BoundsTemplate<float> bounds = trunk.getBoundsOfSubNode(i);
+
+		__m256 entries = rayEntryDistances(
+			_mm256_set1_ps(bounds.min.x), _mm256_set1_ps(bounds.min.y), _mm256_set1_ps(bounds.min.z),
+			_mm256_set1_ps(bounds.max.x), _mm256_set1_ps(bounds.max.y), _mm256_set1_ps(bounds.max.z),
+			originX, originY, originZ, invDirX, invDirY, invDirZ, maxDistance
+		);
+
+		__m256 hits = _mm256_cmp_ps(entries, _mm256_set1_ps(RAY_MAX_DISTANCE), _CMP_LT_OQ);
+		unsigned int hitMask = static_cast<unsigned int>(_mm256_movemask_ps(hits)) & activeRays;
+		result.hitMasks[i] = hitMask;
+
+		float nearestEntry = RAY_MAX_DISTANCE;
+		if(hitMask != 0) {
+			_mm256_store_ps(entryBuf, entries);
+			for(int r = 0; r < RAY_PACKET_SIZE; r++) {
+				if((hitMask & (1U << r)) != 0 && entryBuf[r] < nearestEntry) nearestEntry = entryBuf[r];
+			}
+		}
+		result.nearestEntry[i] = nearestEntry;
+	}
+	return result;
+}
+
+std::array<bool, BRANCH_FACTOR> TrunkSIMDHelperAVX::computeOverlapsWith(const TreeTrunk& trunk, int, const BoundsTemplate<float>& bounds) {
+	const BoundsArray<BRANCH_FACTOR>& subNodeBounds = trunk.subNodeBounds;
+
+	__m256 overlapX = _mm256_and_ps(_mm256_cmp_ps(_mm256_load_ps(subNodeBounds.xMax), _mm256_set1_ps(bounds.min.x), _CMP_GE_OQ), _mm256_cmp_ps(_mm256_load_ps(subNodeBounds.xMin), _mm256_set1_ps(bounds.max.x), _CMP_LE_OQ));
+	__m256 overlapY = _mm256_and_ps(_mm256_cmp_ps(_mm256_load_ps(subNodeBounds.yMax), _mm256_set1_ps(bounds.min.y), _CMP_GE_OQ), _mm256_cmp_ps(_mm256_load_ps(subNodeBounds.yMin), _mm256_set1_ps(bounds.max.y), _CMP_LE_OQ));
+	__m256 overlapZ = _mm256_and_ps(_mm256_cmp_ps(_mm256_load_ps(subNodeBounds.zMax), _mm256_set1_ps(bounds.min.z), _CMP_GE_OQ), _mm256_cmp_ps(_mm256_load_ps(subNodeBounds.zMin), _mm256_set1_ps(bounds.max.z), _CMP_LE_OQ));
+	int mask = _mm256_movemask_ps(_mm256_and_ps(_mm256_and_ps(overlapX, overlapY), overlapZ));
+
+	std::array<bool, BRANCH_FACTOR> result;
+	for(int i = 0; i < BRANCH_FACTOR; i++) {
+		result[i] = (mask & (1 << i)) != 0;
+	}
+	return result;
+}
+
+std::array<float, BRANCH_FACTOR> TrunkSIMDHelperAVX::computeDistancesSquaredTo(const TreeTrunk& trunk, int, const Vec3f& point) {
+	const BoundsArray<BRANCH_FACTOR>& bounds = trunk.subNodeBounds;
+	__m256 zero = _mm256_setzero_ps();
+
+	__m256 px = _mm256_set1_ps(point.x);
+	__m256 py = _mm256_set1_ps(point.y);
+	__m256 pz = _mm256_set1_ps(point.z);
+	__m256 dx = _mm256_max_ps(_mm256_max_ps(_mm256_sub_ps(_mm256_load_ps(bounds.xMin), px), _mm256_sub_ps(px, _mm256_load_ps(bounds.xMax))), zero);
+	__m256 dy = _mm256_max_ps(_mm256_max_ps(_mm256_sub_ps(_mm256_load_ps(bounds.yMin), py), _mm256_sub_ps(py, _mm256_load_ps(bounds.yMax))), zero);
+	__m256 dz = _mm256_max_ps(_mm256_max_ps(_mm256_sub_ps(_mm256_load_ps(bounds.zMin), pz), _mm256_sub_ps(pz, _mm256_load_ps(bounds.zMax))), zero);
+
+	__m256 distanceSq = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+
+	alignas(32) std::array<float, BRANCH_FACTOR> result;
+	_mm256_store_ps(result.data(), distanceSq);
+	return result;
+}
+
+FrustumCullResult TrunkSIMDHelperAVX::computeFrustumCulling(const TreeTrunk& trunk, int trunkSize, const TreeFrustum& frustum, unsigned int activePlanes) {
+	const BoundsArray<BRANCH_FACTOR>& bounds = trunk.subNodeBounds;
+	__m256 xMin = _mm256_sub_ps(_mm256_load_ps(bounds.xMin), _mm256_set1_ps(frustum.origin.x));
+	__m256 yMin = _mm256_sub_ps(_mm256_load_ps(bounds.yMin), _mm256_set1_ps(frustum.origin.y));
+	__m256 zMin = _mm256_sub_ps(_mm256_load_ps(bounds.zMin), _mm256_set1_ps(frustum.origin.z));
+	__m256 xMax = _mm256_sub_ps(_mm256_load_ps(bounds.xMax), _mm256_set1_ps(frustum.origin.x));
+	__m256 yMax = _mm256_sub_ps(_mm256_load_ps(bounds.yMax), _mm256_set1_ps(frustum.origin.y));
+	__m256 zMax = _mm256_sub_ps(_mm256_load_ps(bounds.zMax), _mm256_set1_ps(frustum.origin.z));
+
+	FrustumCullResult result;
+	for(int i = 0; i < BRANCH_FACTOR; i++) {
+		result.planesInside[i] = 0;
+	}
+
+	__m256 outside = _mm256_setzero_ps();
+	for(int p = 0; p < FRUSTUM_PLANE_COUNT; p++) {
+		if((activePlanes & (1U << p)) == 0) continue;
+		const Vec3f& normal = frustum.normals[p];
+		__m256 nx = _mm256_set1_ps(normal.x);
+		__m256 ny = _mm256_set1_ps(normal.y);
+		__m256 nz = _mm256_set1_ps(normal.z);
+
+		// the sign of the normal is the same for all 8 subnodes, so picking the near and far corners is a scalar choice
+		__m256 nearDot = _mm256_add_ps(_mm256_add_ps(
+			_mm256_mul_ps(nx, (normal.x >= 0) ? xMin : xMax),
+			_mm256_mul_ps(ny, (normal.y >= 0) ? yMin : yMax)),
+			_mm256_mul_ps(nz, (normal.z >= 0) ? zMin : zMax));
+		__m256 farDot = _mm256_add_ps(_mm256_add_ps(
+			_mm256_mul_ps(nx, (normal.x >= 0) ? xMax : xMin),
+			_mm256_mul_ps(ny, (normal.y >= 0) ? yMax : yMin)),
+			_mm256_mul_ps(nz, (normal.z >= 0) ? zMax : zMin));
+
+		__m256 offset = _mm256_set1_ps(frustum.offsets[p]);
+		outside = _mm256_or_ps(outside, _mm256_cmp_ps(nearDot, offset, _CMP_GT_OQ));
+		unsigned int insideMask = static_cast<unsigned int>(_mm256_movemask_ps(_mm256_cmp_ps(farDot, offset, _CMP_LE_OQ)));
+		for(int i = 0; i < BRANCH_FACTOR; i++) {
+			result.planesInside[i] |= ((insideMask >> i) & 1U) << p;
+		}
+	}
+	result.visibleMask = ~static_cast<unsigned int>(_mm256_movemask_ps(outside)) & ((1U << trunkSize) - 1);
+	return result;
+}
 }
\ No newline at end of file
@@ -103,6 +103,27 @@ bool VisibilityFilter::operator()(const Bounds& bounds) const {
 bool VisibilityFilter::operator()(const Part& part) const {
 	return true;
 }
+
+std::array<bool, BRANCH_FACTOR> VisibilityFilter::operator()(const TreeTrunk& trunk, int trunkSize) const {
+	FrustumCullResult culled = TrunkSIMDHelperFallback::computeFrustumCulling(trunk, trunkSize, getTreeFrustum(), ALL_FRUSTUM_PLANES);
+	std::array<bool, BRANCH_FACTOR> results;
+	for(int i = 0; i < trunkSize; i++) {
+		results[i] = (culled.visibleMask & (1U << i)) != 0;
+	}
+	return results;
+}
+
+TreeFrustum VisibilityFilter::getTreeFrustum() const {
+	TreeFrustum result;
+	result.origin = castPositionToVec3f(origin);
+	Vec3 normals[FRUSTUM_PLANE_COUNT]{up, down, left, right, forward};
+	for(int i = 0; i < FRUSTUM_PLANE_COUNT; i++) {
+		result.normals[i] = static_cast<Vec3f>(normals[i]);
+		result.offsets[i] = 0.0f;
+	}
+	result.offsets[4] = static_cast<float>(maxDepth);
+	return result;
+}
 };
 /*   A
 	/
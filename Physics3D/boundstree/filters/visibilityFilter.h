@@ -3,6 +3,7 @@
 #include "../../math/linalg/vec.h"
 #include "../../math/bounds.h"
 #include "../../part.h"
+#include "../boundsTree.h"
 
 namespace P3D {
 class VisibilityFilter {
@@ -66,6 +67,11 @@ public:
 	bool operator()(const Position& point) const;
 	bool operator()(const Part& part) const;
 	bool operator()(const Bounds& bounds) const;
+	// trunk level test for BoundsTree::forEachFiltered
+	std::array<bool, BRANCH_FACTOR> operator()(const TreeTrunk& trunk, int trunkSize) const;
+
+	// the same planes in the form used by BoundsTree::forEachInFrustum and WorldPrototype::forEachPartInFrustum
+	TreeFrustum getTreeFrustum() const;
 
 	Vec3 getForwardStep() const { return forward; }
 	Vec3 getTopOfViewPort() const { return projectToPlaneNormal(forward, up); }
@@ -10,6 +10,14 @@ struct Colission {
 	Vec3 exitVector;
 };
 
+// what handling a colission did, impulse and force act on p1, p2 gets the opposite
+struct ColissionResponse {
+	Vec3 impulse;
+	Vec3 force;
+	// velocity of p1 relative to p2 at the colission before it was handled
+	Vec3 relativeVelocity;
+};
+
 struct ColissionBuffer {
 	std::vector<Colission> freePartColissions;
 	std::vector<Colission> freeTerrainColissions;
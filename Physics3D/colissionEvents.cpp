@@ -0,0 +1,114 @@
+#include "colissionEvents.h"
+
+#include "part.h"
+#include "layer.h"
+#include "colissionBuffer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+#include <utility>
+
+namespace P3D {
+typedef std::pair<std::uintptr_t, std::uintptr_t> PartPairKey;
+
+// the order of p1 and p2 may differ between ticks, the key doesn't
+static PartPairKey getPairKey(const Part* p1, const Part* p2) {
+	std::uintptr_t a = reinterpret_cast<std::uintptr_t>(p1);
+	std::uintptr_t b = reinterpret_cast<std::uintptr_t>(p2);
+	return (a < b) ? PartPairKey(a, b) : PartPairKey(b, a);
+}
+
+static PartPairKey getPairKey(const ColissionEvent& e) {
+	return getPairKey(e.p1, e.p2);
+}
+
+static bool isPartInMask(const Part* part, LayerMask layerMask) {
+	return part->layer != nullptr && isLayerInMask(part->layer->parent->getID(), layerMask);
+}
+
+void ColissionEventStream::recordColission(const Colission& colission, const ColissionResponse& response, double deltaT) {
+	if(!isPartInMask(colission.p1, layerMask) && !isPartInMask(colission.p2, layerMask)) return;
+
+	double exitLengthSq = lengthSquared(colission.exitVector);
+	Vec3 normal = (exitLengthSq > 0.0) ? colission.exitVector / std::sqrt(exitLengthSq) : Vec3(0.0, 0.0, 0.0);
+	newContacts.push_back(ColissionEvent{ColissionEventType::BEGIN, colission.p1, colission.p2, colission.intersection, normal, response.impulse + response.force * deltaT, response.relativeVelocity});
+}
+
+void ColissionEventStream::recordSleepingColission(const Colission& colission) {
+	sleepingPairs.push_back(getPairKey(colission.p1, colission.p2));
+}
+
+void ColissionEventStream::finishTick() {
+	auto byPairKey = [](const ColissionEvent& a, const ColissionEvent& b) {
+		return getPairKey(a) < getPairKey(b);
+	};
+	std::sort(newContacts.begin(), newContacts.end(), byPairKey);
+	std::sort(sleepingPairs.begin(), sleepingPairs.end());
+
+	tickEvents.clear();
+	// sleeping contacts are appended to newContacts, so they stay active
+	std::size_t newCount = newContacts.size();
+	std::size_t newIndex = 0;
+	std::size_t activeIndex = 0;
+	while(newIndex < newCount || activeIndex < activeContacts.size()) {
+		if(activeIndex == activeContacts.size() || (newIndex < newCount && getPairKey(newContacts[newIndex]) < getPairKey(activeContacts[activeIndex]))) {
+			ColissionEvent& e = newContacts[newIndex++];
+			e.type = ColissionEventType::BEGIN;
+			tickEvents.push_back(e);
+		} else if(newIndex == newCount || getPairKey(activeContacts[activeIndex]) < getPairKey(newContacts[newIndex])) {
+			ColissionEvent e = activeContacts[activeIndex++];
+			e.impulse = Vec3(0.0, 0.0, 0.0);
+			if(std::binary_search(sleepingPairs.begin(), sleepingPairs.end(), getPairKey(e))) {
+				e.type = ColissionEventType::PERSIST;
+				newContacts.push_back(e);
+			} else {
+				e.type = ColissionEventType::END;
+			}
+			tickEvents.push_back(e);
+		} else {
+			ColissionEvent& e = newContacts[newIndex++];
+			e.type = ColissionEventType::PERSIST;
+			tickEvents.push_back(e);
+			activeIndex++;
+		}
+	}
+	std::inplace_merge(newContacts.begin(), newContacts.begin() + newCount, newContacts.end(), byPairKey);
+	activeContacts.swap(newContacts);
+	newContacts.clear();
+	sleepingPairs.clear();
+
+	std::lock_guard<std::mutex> lock(publishMutex);
+	if(hasConsumer) {
+		publishedEvents.insert(publishedEvents.end(), tickEvents.begin(), tickEvents.end());
+		publishedTicks++;
+	}
+}
+
+std::size_t ColissionEventStream::takeEvents(std::vector<ColissionEvent>& events) {
+	events.clear();
+	std::lock_guard<std::mutex> lock(publishMutex);
+	hasConsumer = true;
+	// the consumer's old buffer becomes the new publishing buffer, so neither side reallocates once warmed up
+	events.swap(publishedEvents);
+	std::size_t ticks = publishedTicks;
+	publishedTicks = 0;
+	return ticks;
+}
+
+void ColissionEventStream::forgetPart(const Part* part) {
+	activeContacts.erase(std::remove_if(activeContacts.begin(), activeContacts.end(), [part](const ColissionEvent& e) {
+		return e.p1 == part || e.p2 == part;
+	}), activeContacts.end());
+}
+
+void ColissionEventStream::clear() {
+	tickEvents.clear();
+	activeContacts.clear();
+	newContacts.clear();
+	sleepingPairs.clear();
+	std::lock_guard<std::mutex> lock(publishMutex);
+	publishedEvents.clear();
+	publishedTicks = 0;
+}
+};
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "math/linalg/vec.h"
+#include "math/position.h"
+#include "layerMask.h"
+
+namespace P3D {
+class Part;
+struct Colission;
+struct ColissionResponse;
+
+enum class ColissionEventType : char {
+	BEGIN,
+	PERSIST,
+	END
+};
+
+struct ColissionEvent {
+	ColissionEventType type;
+	Part* p1;
+	Part* p2;
+	// END events repeat the contact of the last tick the parts collided in
+	Position intersection;
+	// direction p2 must move in to separate the parts
+	Vec3 normal;
+	// total impulse colission handling gave p1 this tick, p2 got the opposite. Zero for END events
+	Vec3 impulse;
+	// velocity of p1 relative to p2 at intersection, before the colission was handled
+	Vec3 relativeVelocity;
+};
+
+/*
+	Turns the colissions of every tick into begin, persist and end events per colliding pair of parts
+	Opt-in per world with enabled, a disabled stream costs nothing during the tick
+
+	Pairs are matched against the colissions of the previous tick, kept sorted by part pointers
+	Only pairs where at least one of the parts is in a layer of layerMask produce events
+
+	After tick(), getEvents() holds the events of that tick, to be read on the thread calling tick()
+	Other threads use takeEvents(), once it has been called events accumulate until its next call
+	Contacts of parts removed from the world are dropped without an END event
+	Contacts of sleeping islands skip the narrow phase, they keep producing PERSIST events with the contact of the last awake tick
+*/
+class ColissionEventStream {
+	std::vector<ColissionEvent> tickEvents;
+	std::vector<ColissionEvent> activeContacts;
+	std::vector<ColissionEvent> newContacts;
+	std::vector<std::pair<std::uintptr_t, std::uintptr_t>> sleepingPairs;
+
+	std::mutex publishMutex;
+	std::vector<ColissionEvent> publishedEvents;
+	std::size_t publishedTicks = 0;
+	bool hasConsumer = false;
+
+public:
+	bool enabled = false;
+	LayerMask layerMask = ALL_LAYERS;
+
+	ColissionEventStream() = default;
+	ColissionEventStream(const ColissionEventStream&) = delete;
+	ColissionEventStream& operator=(const ColissionEventStream&) = delete;
+
+	void recordColission(const Colission& colission, const ColissionResponse& response, double deltaT);
+	// colissions set aside because both parts sleep, active contacts between them persist rather than end
+	void recordSleepingColission(const Colission& colission);
+	// matches the recorded colissions against the previous tick and publishes the resulting events
+	void finishTick();
+
+	const std::vector<ColissionEvent>& getEvents() const { return tickEvents; }
+	// swaps the events published since the last call into events, returns the number of ticks they span
+	std::size_t takeEvents(std::vector<ColissionEvent>& events);
+
+	void forgetPart(const Part* part);
+	void clear();
+};
+};
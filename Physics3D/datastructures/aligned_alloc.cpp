@@ -3,8 +3,13 @@
 #include <malloc.h>
 #include <stdlib.h>
 
+#include "../misc/allocationTracker.h"
+
 namespace P3D {
 void* aligned_malloc(size_t size, size_t align) {
+#if P3D_ALLOCATION_TRACKING
+	AllocationTracker::recordAllocation(size);
+#endif
 #ifdef _MSC_VER
 	return _aligned_malloc(size, align);
 #else
@@ -12,6 +17,9 @@ void* aligned_malloc(size_t size, size_t align) {
 #endif
 }
 void aligned_free(void* ptr) {
+#if P3D_ALLOCATION_TRACKING
+	if(ptr != nullptr) AllocationTracker::recordFree();
+#endif
 #ifdef _MSC_VER
 	_aligned_free(ptr);
 #else
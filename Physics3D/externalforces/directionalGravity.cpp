@@ -8,6 +8,7 @@
 namespace P3D {
 void DirectionalGravity::apply(WorldPrototype* world) {
 	for(MotorizedPhysical* p : world->physicals) {
+		if(p->isAsleep) continue; // resting on something that cancels gravity, applying it would wake it
 		p->applyForceAtCenterOfMass(gravity * p->totalMass);
 	}
 }
@@ -13,6 +13,7 @@
 #include "../misc/catchable_assert.h"
 
 #include <stdexcept>
+#include <algorithm>
 
 
 #define GJK_MAX_ITER 200
@@ -29,6 +30,18 @@ inline static void incDebugTally(HistoricTally<long long, IterationTime>& tally,
 	}
 }
 
+thread_local IntersectionIterations lastIntersectionIterations;
+
+inline static void incGJKTally(HistoricTally<long long, IterationTime>& tally, int iterTime) {
+	lastIntersectionIterations.gjk = iterTime;
+	incDebugTally(tally, iterTime);
+}
+
+inline static void incEPATally(HistoricTally<long long, IterationTime>& tally, int iterTime) {
+	lastIntersectionIterations.epa = iterTime;
+	incDebugTally(tally, iterTime);
+}
+
 static Vec3f getNormalVec(Triangle t, Vec3f* vertices) {
 	Vec3f v0 = vertices[t[0]];
 	Vec3f v1 = vertices[t[1]];
@@ -93,7 +106,7 @@ std::optional<Tetrahedron> runGJKTransformed(const ColissionPair& info, Vec3f se
 	// Just one test, to see if the line segment or A is closer
 	B = getSupport(info, searchDirection);
 	if (B.p * searchDirection < 0) {
-		incDebugTally(GJKNoCollidesIterationStatistics, 0);
+		incGJKTally(GJKNoCollidesIterationStatistics, 0);
 		return std::optional<Tetrahedron>();
 	}
 
@@ -103,7 +116,7 @@ std::optional<Tetrahedron> runGJKTransformed(const ColissionPair& info, Vec3f se
 
 	C = getSupport(info, searchDirection);
 	if (C.p * searchDirection < 0) {
-		incDebugTally(GJKNoCollidesIterationStatistics, 1);
+		incGJKTally(GJKNoCollidesIterationStatistics, 1);
 		return std::optional<Tetrahedron>();
 	}
 	// s.A is C.p  newest
@@ -125,7 +138,7 @@ std::optional<Tetrahedron> runGJKTransformed(const ColissionPair& info, Vec3f se
 			searchDirection = -(AO % AB) % AB;
 			C = getSupport(info, searchDirection);
 			if(C.p * searchDirection < 0) {
-				incDebugTally(GJKNoCollidesIterationStatistics, iter+2);
+				incGJKTally(GJKNoCollidesIterationStatistics, iter+2);
 				return std::optional<Tetrahedron>();
 			}
 		} else {
@@ -135,7 +148,7 @@ std::optional<Tetrahedron> runGJKTransformed(const ColissionPair& info, Vec3f se
 				searchDirection = -(AO % AC) % AC;
 				C = getSupport(info, searchDirection);
 				if(C.p * searchDirection < 0) {
-					incDebugTally(GJKNoCollidesIterationStatistics, iter + 2);
+					incGJKTally(GJKNoCollidesIterationStatistics, iter + 2);
 					return std::optional<Tetrahedron>();
 				}
 			} else {
@@ -158,7 +171,7 @@ std::optional<Tetrahedron> runGJKTransformed(const ColissionPair& info, Vec3f se
 				// s.D is A.p
 				D = getSupport(info, searchDirection);
 				if(D.p * searchDirection < 0) {
-					incDebugTally(GJKNoCollidesIterationStatistics, iter + 2);
+					incGJKTally(GJKNoCollidesIterationStatistics, iter + 2);
 					return std::optional<Tetrahedron>();
 				}
 				Vec3f AO = -D.p;
@@ -190,7 +203,7 @@ std::optional<Tetrahedron> runGJKTransformed(const ColissionPair& info, Vec3f se
 						} else {
 							// GOTCHA! TETRAHEDRON COVERS THE ORIGIN!
 
-							incDebugTally(GJKCollidesIterationStatistics, iter + 2);
+							incGJKTally(GJKCollidesIterationStatistics, iter + 2);
 							return std::optional<Tetrahedron>(Tetrahedron{D, C, B, A});
 						}
 					}
@@ -200,10 +213,213 @@ std::optional<Tetrahedron> runGJKTransformed(const ColissionPair& info, Vec3f se
 	}
 
 	Debug::logWarn("GJK iteration limit reached!");
-	incDebugTally(GJKNoCollidesIterationStatistics, GJK_MAX_ITER + 2);
+	incGJKTally(GJKNoCollidesIterationStatistics, GJK_MAX_ITER + 2);
 	return std::optional<Tetrahedron>();
 }
 
+// relative squared distance at which the cast is considered to touch the Minkowski difference
+#define GJK_CAST_TOLERANCE 1E-10
+
+struct CastSupportPoint {
+	Vec3 p;
+	Vec3 originFirst;
+};
+
+static Vec3 closestOnTriangleToOrigin(const Vec3& a, const Vec3& b, const Vec3& c, double weights[3]) {
+	Vec3 ab = b - a;
+	Vec3 ac = c - a;
+	double d1 = ab * -a;
+	double d2 = ac * -a;
+	if(d1 <= 0 && d2 <= 0) {
+		weights[0] = 1; weights[1] = 0; weights[2] = 0;
+		return a;
+	}
+	double d3 = ab * -b;
+	double d4 = ac * -b;
+	if(d3 >= 0 && d4 <= d3) {
+		weights[0] = 0; weights[1] = 1; weights[2] = 0;
+		return b;
+	}
+	double vc = d1 * d4 - d3 * d2;
+	if(vc <= 0 && d1 >= 0 && d3 <= 0) {
+		double v = d1 / (d1 - d3);
+		weights[0] = 1 - v; weights[1] = v; weights[2] = 0;
+		return a + ab * v;
+	}
+	double d5 = ab * -c;
+	double d6 = ac * -c;
+	if(d6 >= 0 && d5 <= d6) {
+		weights[0] = 0; weights[1] = 0; weights[2] = 1;
+		return c;
+	}
+	double vb = d5 * d2 - d1 * d6;
+	if(vb <= 0 && d2 >= 0 && d6 <= 0) {
+		double w = d2 / (d2 - d6);
+		weights[0] = 1 - w; weights[1] = 0; weights[2] = w;
+		return a + ac * w;
+	}
+	double va = d3 * d6 - d5 * d4;
+	if(va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0) {
+		double w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+		weights[0] = 0; weights[1] = 1 - w; weights[2] = w;
+		return b + (c - b) * w;
+	}
+	double denom = 1.0 / (va + vb + vc);
+	double v = vb * denom;
+	double w = vc * denom;
+	weights[0] = 1 - v - w; weights[1] = v; weights[2] = w;
+	return a + ab * v + ac * w;
+}
+
+/*
+	Returns the point of the convex hull of points closest to the origin, weights receives the barycentric coordinates of it
+	A weight of 0 means the point can be dropped from the simplex
+*/
+static Vec3 closestOnSimplexToOrigin(const Vec3* points, int count, double weights[4]) {
+	switch(count) {
+	case 1:
+		weights[0] = 1;
+		return points[0];
+	case 2: {
+		Vec3 ab = points[1] - points[0];
+		double lengthSq = lengthSquared(ab);
+		double t = (lengthSq > 0) ? std::min(std::max((-points[0] * ab) / lengthSq, 0.0), 1.0) : 0.0;
+		weights[0] = 1 - t;
+		weights[1] = t;
+		return points[0] + ab * t;
+	}
+	case 3:
+		return closestOnTriangleToOrigin(points[0], points[1], points[2], weights);
+	default: {
+		static const int faces[4][4]{{0, 1, 2, 3}, {0, 2, 3, 1}, {0, 3, 1, 2}, {1, 3, 2, 0}};
+		bool foundOutsideFace = false;
+		double bestDistSq = 0;
+		Vec3 best;
+		for(const int* face : faces) {
+			const Vec3& a = points[face[0]];
+			const Vec3& b = points[face[1]];
+			const Vec3& c = points[face[2]];
+			Vec3 normal = (b - a) % (c - a);
+			// a flat tetrahedron has no inside, every face must then be tested
+			if((-a * normal) * ((points[face[3]] - a) * normal) > 0) continue;
+			double faceWeights[3];
+			Vec3 closest = closestOnTriangleToOrigin(a, b, c, faceWeights);
+			double distSq = lengthSquared(closest);
+			if(!foundOutsideFace || distSq < bestDistSq) {
+				foundOutsideFace = true;
+				bestDistSq = distSq;
+				best = closest;
+				weights[face[0]] = faceWeights[0];
+				weights[face[1]] = faceWeights[1];
+				weights[face[2]] = faceWeights[2];
+				weights[face[3]] = 0;
+			}
+		}
+		if(!foundOutsideFace) {
+			// origin is inside the tetrahedron, its weights are the volumes of the tetrahedra it forms with the opposite faces
+			double volume = (points[1] - points[0]) * ((points[2] - points[0]) % (points[3] - points[0]));
+			for(const int* face : faces) {
+				const Vec3& a = points[face[0]];
+				const Vec3& b = points[face[1]];
+				const Vec3& c = points[face[2]];
+				weights[face[3]] = (volume != 0) ? std::abs(a * (b % c) / volume) : 0.25;
+			}
+			return Vec3(0.0, 0.0, 0.0);
+		}
+		return best;
+	}
+	}
+}
+
+/*
+	GJK ray cast (van den Bergen) of the origin along motion against the Minkowski difference first - second
+	Moving second by t * motion makes the shapes touch when t * motion enters this difference
+	timeOfImpact is the fraction of motion at first contact, point and normal are local to first, normal points from first towards second
+	Returns false if the shapes don't touch within the motion
+*/
+bool runGJKRaycastTransformed(const ColissionPair& info, const Vec3f& motion, double& timeOfImpact, Vec3f& point, Vec3f& normal) {
+	Vec3 ray(motion);
+	double lambda = 0.0;
+	Vec3 x(0.0, 0.0, 0.0);
+	Vec3 hitNormal(0.0, 0.0, 0.0);
+
+	CastSupportPoint simplex[4];
+	Vec3 offsets[4];
+	double weights[4]{1.0, 0.0, 0.0, 0.0};
+	int simplexSize = 0;
+
+	MinkPoint initial = getSupport(info, motion);
+	Vec3 v = x - Vec3(initial.p);
+	double maxOffsetSq = lengthSquared(v);
+
+	for(int iter = 0; iter < GJK_MAX_ITER; iter++) {
+		double distSq = lengthSquared(v);
+		if(distSq <= GJK_CAST_TOLERANCE * maxOffsetSq) break;
+
+		MinkPoint support = getSupport(info, Vec3f(v));
+		Vec3 p(support.p);
+		Vec3 w = x - p;
+		double vw = v * w;
+		bool advanced = false;
+		if(vw > 0) {
+			double vr = v * ray;
+			if(vr >= 0) return false;
+			lambda -= vw / vr;
+			if(lambda > 1.0) return false;
+			x = ray * lambda;
+			hitNormal = v;
+			advanced = true;
+		}
+
+		bool alreadyInSimplex = false;
+		for(int i = 0; i < simplexSize; i++) {
+			if(lengthSquared(simplex[i].p - p) <= GJK_CAST_TOLERANCE * maxOffsetSq) alreadyInSimplex = true;
+		}
+		if(!alreadyInSimplex) {
+			simplex[simplexSize++] = CastSupportPoint{p, Vec3(support.originFirst)};
+		} else if(!advanced) {
+			// the support function can't get any closer, x is on the surface up to float precision
+			break;
+		}
+		maxOffsetSq = 0.0;
+		for(int i = 0; i < simplexSize; i++) {
+			offsets[i] = x - simplex[i].p;
+			maxOffsetSq = std::max(maxOffsetSq, lengthSquared(offsets[i]));
+		}
+		v = closestOnSimplexToOrigin(offsets, simplexSize, weights);
+
+		int newSize = 0;
+		for(int i = 0; i < simplexSize; i++) {
+			if(weights[i] > 0) {
+				simplex[newSize] = simplex[i];
+				weights[newSize] = weights[i];
+				newSize++;
+			}
+		}
+		if(newSize == 0) break;
+		simplexSize = newSize;
+		// origin is enclosed, x lies in the Minkowski difference
+		if(newSize == 4) break;
+		// no more progress can be made at the float precision of the support points, the first v doesn't come from the simplex
+		if(!advanced && iter != 0 && distSq <= lengthSquared(v)) break;
+	}
+
+	Vec3 contact(0.0, 0.0, 0.0);
+	if(simplexSize == 0) {
+		contact = Vec3(initial.originFirst);
+	} else {
+		double totalWeight = 0.0;
+		for(int i = 0; i < simplexSize; i++) totalWeight += weights[i];
+		for(int i = 0; i < simplexSize; i++) contact += simplex[i].originFirst * (weights[i] / totalWeight);
+	}
+
+	timeOfImpact = lambda;
+	point = Vec3f(contact);
+	// shapes overlapping at the start have no separating direction, push back against the motion
+	normal = (lengthSquared(hitNormal) > 0) ? Vec3f(normalize(hitNormal)) : Vec3f(-normalize(ray));
+	return true;
+}
+
 void initializeBuffer(const Tetrahedron& s, ComputationBuffers& b) {
 	b.vertBuf[0] = s.A.p;
 	b.vertBuf[1] = s.B.p;
@@ -286,13 +502,13 @@ bool runEPATransformed(const ColissionPair& info, const Tetrahedron& s, Vec3f& i
 
 			// intersection = (avgFirst + relativeCFrame.localToGlobal(avgSecond)) / 2;
 			intersection = (avgFirst + avgSecond) * 0.5f;
-			incDebugTally(EPAIterationStatistics, iter);
+			incEPATally(EPAIterationStatistics, iter);
 			return true;
 		}
 	}
 
 	Debug::logWarn("EPA iteration limit exceeded! ");
-	incDebugTally(EPAIterationStatistics, EPA_MAX_ITER);
+	incEPATally(EPAIterationStatistics, EPA_MAX_ITER);
 	return false;
 }
 };
@@ -56,6 +56,14 @@ struct ColissionPair {
 	DiagonalMat3f scaleSecond;
 };
 
+// iterations of the last runGJKTransformed and runEPATransformed on this thread, see IntersectionPairStatistics
+struct IntersectionIterations {
+	int gjk = 0;
+	int epa = 0;
+};
+extern thread_local IntersectionIterations lastIntersectionIterations;
+
 std::optional<Tetrahedron> runGJKTransformed(const ColissionPair& colissionPair, Vec3f initialSearchDirection);
 bool runEPATransformed(const ColissionPair& colissionPair, const Tetrahedron& s, Vec3f& intersection, Vec3f& exitVector, ComputationBuffers& bufs);
+bool runGJKRaycastTransformed(const ColissionPair& colissionPair, const Vec3f& motion, double& timeOfImpact, Vec3f& point, Vec3f& normal);
 };
\ No newline at end of file
@@ -17,13 +17,36 @@
 
 namespace P3D {
 std::optional<Intersection> intersectsTransformed(const Shape& first, const Shape& second, const CFrame& relativeTransform) {
+#if P3D_PROFILING
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	lastIntersectionIterations = IntersectionIterations{};
+	std::optional<Intersection> result = intersectsTransformed(*first.baseShape, *second.baseShape, relativeTransform, first.scale, second.scale);
+	std::chrono::nanoseconds timeTaken = std::chrono::high_resolution_clock::now() - start;
+	intersectionPairStatistics.record(first.baseShape->intersectionClassID, second.baseShape->intersectionClassID, result.has_value(), timeTaken, lastIntersectionIterations.gjk, lastIntersectionIterations.epa);
+	return result;
+#else
 	return intersectsTransformed(*first.baseShape, *second.baseShape, relativeTransform, first.scale, second.scale);
+#endif
+}
+
+std::optional<CastIntersection> castTransformed(const Shape& first, const Shape& second, const CFrame& relativeTransform, const Vec3& motion) {
+	ColissionPair info{*first.baseShape, *second.baseShape, relativeTransform, first.scale, second.scale};
+	double timeOfImpact;
+	Vec3f point;
+	Vec3f normal;
+	if(runGJKRaycastTransformed(info, Vec3f(motion), timeOfImpact, point, normal)) {
+		return CastIntersection{timeOfImpact, Vec3(point), Vec3(normal)};
+	} else {
+		return std::optional<CastIntersection>();
+	}
 }
 
 thread_local ComputationBuffers buffers(1000, 2000);
 
 std::optional<Intersection> intersectsTransformed(const GenericCollidable& first, const GenericCollidable& second, const CFrame& relativeTransform, const DiagonalMat3& scaleFirst, const DiagonalMat3& scaleSecond) {
 	ColissionPair info{first, second, relativeTransform, scaleFirst, scaleSecond};
+	// worker threads go idle again when this returns
+	PhysicsProcess previousProcess = physicsMeasure.getCurrentProcess();
 	physicsMeasure.mark(PhysicsProcess::GJK_COL);
 	std::optional collides = runGJKTransformed(info, -relativeTransform.position);
 
@@ -39,6 +62,7 @@ std::optional<Intersection> intersectsTransformed(const GenericCollidable& first
 			float minOfScaleSecond = float(std::min(scaleSecond[0], std::min(scaleSecond[1], scaleSecond[2])));
 			exitVector = Vec3f(std::min(minOfScaleFirst, minOfScaleSecond), 0.0f, 0.0f);
 
+			physicsMeasure.mark(previousProcess);
 			return Intersection(intersection, exitVector);
 		}
 
@@ -58,13 +82,14 @@ std::optional<Intersection> intersectsTransformed(const GenericCollidable& first
 		bool epaResult = runEPATransformed(info, result, intersection, exitVector, buffers);
 
 		catchable_assert(isVecValid(exitVector));
+		physicsMeasure.mark(previousProcess);
 		if(!epaResult) {
 			return std::optional<Intersection>();
 		} else {
 			return std::optional<Intersection>(Intersection(intersection, exitVector));
 		}
 	} else {
-		physicsMeasure.mark(PhysicsProcess::OTHER, PhysicsProcess::GJK_NO_COL);
+		physicsMeasure.mark(previousProcess, PhysicsProcess::GJK_NO_COL);
 		return std::optional<Intersection>();
 	}
 }
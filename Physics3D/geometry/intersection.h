@@ -21,6 +21,17 @@ struct Intersection {
 		exitVector(exitVector) {}
 };
 
+struct CastIntersection {
+	// Fraction of the motion travelled before the shapes touch
+	double timeOfImpact;
+	// Local to first
+	Vec3 point;
+	// Local to first, surface normal of first pointing towards second
+	Vec3 normal;
+};
+
 std::optional<Intersection> intersectsTransformed(const Shape& first, const Shape& second, const CFrame& relativeTransform);
+// second is moved along motion (local to first) starting from relativeTransform
+std::optional<CastIntersection> castTransformed(const Shape& first, const Shape& second, const CFrame& relativeTransform, const Vec3& motion);
 std::optional<Intersection> intersectsTransformed(const GenericCollidable& first, const GenericCollidable& second, const CFrame& relativeTransform, const DiagonalMat3& scaleFirst, const DiagonalMat3& scaleSecond);
 };
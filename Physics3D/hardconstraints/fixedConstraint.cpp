@@ -5,4 +5,5 @@ void FixedConstraint::update(double deltaT) {}
 void FixedConstraint::invert() {}
 CFrame FixedConstraint::getRelativeCFrame() const { return CFrame(0.0, 0.0, 0.0); }
 RelativeMotion FixedConstraint::getRelativeMotion() const { return RelativeMotion(Motion(Vec3(0.0, 0.0, 0.0), Vec3(0.0, 0.0, 0.0)), CFrame(0.0, 0.0, 0.0)); }
+bool FixedConstraint::isStatic() const { return true; }
 };
\ No newline at end of file
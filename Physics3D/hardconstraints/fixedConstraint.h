@@ -12,5 +12,7 @@ public:
 
 	virtual CFrame getRelativeCFrame() const override;
 	virtual RelativeMotion getRelativeMotion() const override;
+
+	virtual bool isStatic() const override;
 };
 };
\ No newline at end of file
@@ -18,6 +18,9 @@ public:
 
 	virtual CFrame getRelativeCFrame() const = 0;
 
+	// returns true if getRelativeCFrame() can never change, allows the owning physical to keep its cached mass properties
+	virtual bool isStatic() const { return false; }
+
 	virtual ~HardConstraint();
 };
 };
\ No newline at end of file
@@ -19,6 +19,7 @@ RelativeMotion HardPhysicalConnection::getRelativeMotion() const {
 
 void HardPhysicalConnection::update(double deltaT) {
 	constraintWithParent->update(deltaT);
+	if(!constraintWithParent->isStatic()) relativeCFrameChanged = true;
 }
 
 HardPhysicalConnection HardPhysicalConnection::inverted()&& {
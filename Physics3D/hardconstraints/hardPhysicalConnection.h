@@ -12,6 +12,8 @@ struct HardPhysicalConnection {
 	CFrame attachOnChild;
 	CFrame attachOnParent;
 	std::unique_ptr<HardConstraint> constraintWithParent;
+	// set when the relative CFrame to the parent may have changed since the parent last combined its mass properties
+	bool relativeCFrameChanged = true;
 
 	HardPhysicalConnection(std::unique_ptr<HardConstraint> constraintWithParent, const CFrame& attachOnChild, const CFrame& attachOnParent);
 
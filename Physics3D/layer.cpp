@@ -96,6 +96,8 @@ void WorldLayer::moveOutOfGroup(Part* part) {
 void WorldLayer::removePart(Part* partToRemove) {
 	assert(partToRemove->layer == this);
 	tree.remove(partToRemove);
+	parent->world->colissionEvents.forgetPart(partToRemove);
+	parent->world->snapshots.forgetPart(partToRemove);
 	parent->world->onPartRemoved(partToRemove);
 	partToRemove->layer = nullptr;
 }
@@ -109,6 +111,7 @@ void WorldLayer::notifyPartGroupBoundsUpdated(const Part* mainPart, const Bounds
 
 void WorldLayer::notifyPartStdMoved(Part* oldPartPtr, Part* newPartPtr) noexcept {
 	tree.findAndReplaceObject(oldPartPtr, newPartPtr, newPartPtr->getBounds());
+	parent->world->snapshots.notifyPartStdMoved(oldPartPtr, newPartPtr);
 }
 
 void WorldLayer::mergeGroups(Part* first, Part* second) {
@@ -170,6 +173,21 @@ void ColissionLayer::refresh() {
 	subLayers[FREE_PARTS_LAYER].refresh();
 }
 
+void ColissionLayer::recalculateBounds() {
+	if(world != nullptr && world->useSleeping) {
+		// sleeping parts don't move
+		subLayers[FREE_PARTS_LAYER].tree.recalculateBounds([](const Part& part) {
+			return !isPartAsleep(part);
+		});
+	} else {
+		subLayers[FREE_PARTS_LAYER].tree.recalculateBounds();
+	}
+}
+
+void ColissionLayer::improveStructure() {
+	subLayers[FREE_PARTS_LAYER].tree.improveStructure();
+}
+
 
 
 static bool boundsSphereEarlyEnd(const DiagonalMat3& scale, const Vec3& sphereCenter, double sphereRadius) {
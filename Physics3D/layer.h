@@ -66,6 +66,11 @@ public:
 		tree.forEachFiltered(filter, funcToRun);
 	}
 
+	template<typename SIMDHelper = TrunkSIMDHelperFallback, typename Func>
+	void forEachInFrustum(const TreeFrustum& frustum, const Func& funcToRun) const {
+		tree.template forEachInFrustum<SIMDHelper>(frustum, funcToRun);
+	}
+
 	int getID() const;
 };
 
@@ -92,6 +97,9 @@ public:
 	ColissionLayer& operator=(ColissionLayer&& other) noexcept;
 
 	void refresh();
+	// the two phases of refresh() without profiler marks, different layers may run these concurrently
+	void recalculateBounds();
+	void improveStructure();
 
 	void getInternalColissions(ColissionBuffer& curColissions) const;
 
@@ -109,6 +117,13 @@ public:
 		}
 	}
 
+	template<typename SIMDHelper = TrunkSIMDHelperFallback, typename Func>
+	void forEachInFrustum(const TreeFrustum& frustum, const Func& funcToRun) const {
+		for(const WorldLayer& subLayer : this->subLayers) {
+			subLayer.template forEachInFrustum<SIMDHelper>(frustum, funcToRun);
+		}
+	}
+
 	int getID() const;
 };
 void getColissionsBetween(const ColissionLayer& a, const ColissionLayer& b, ColissionBuffer& curColissions);
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace P3D {
+// bit i selects layers[i], layers past the 64th can't be masked and are always included
+typedef std::uint64_t LayerMask;
+constexpr LayerMask ALL_LAYERS = ~LayerMask(0);
+
+inline bool isLayerInMask(std::size_t layerIndex, LayerMask layerMask) {
+	return layerIndex >= 64 || (layerMask & (LayerMask(1) << layerIndex)) != 0;
+}
+};
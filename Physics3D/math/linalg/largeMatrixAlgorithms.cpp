@@ -0,0 +1,218 @@
+#include "largeMatrixAlgorithms.h"
+
+#include "largeMatrixKernels.h"
+#include "../../misc/cpuid.h"
+
+#include <algorithm>
+
+namespace P3D {
+// Block sizes chosen so that a block of b (GEMM_INNER_BLOCK x GEMM_COL_BLOCK) stays in L2, and a block of a in L1
+#define GEMM_ROW_BLOCK 64
+#define GEMM_COL_BLOCK 256
+#define GEMM_INNER_BLOCK 128
+#define LU_PANEL_SIZE 32
+
+struct DenseKernels {
+	void(*multiplyAccumulateBlock)(const double*, std::size_t, const double*, std::size_t, double*, std::size_t, std::size_t, std::size_t, std::size_t, double);
+	void(*rowMultiplyAdd)(double*, const double*, std::size_t, double);
+	double(*dotProduct)(const double*, const double*, std::size_t);
+};
+
+static DenseKernels getKernels() {
+	if(CPUIDCheck::hasTechnology(CPUIDCheck::AVX | CPUIDCheck::AVX2 | CPUIDCheck::FMA)) {
+		return DenseKernels{multiplyAccumulateBlockAVX, rowMultiplyAddAVX, dotProductAVX};
+	} else {
+		return DenseKernels{multiplyAccumulateBlockScalar, rowMultiplyAddScalar, dotProductScalar};
+	}
+}
+
+void multiplyAccumulateBlockScalar(const double* a, std::size_t aStride, const double* b, std::size_t bStride, double* c, std::size_t cStride, std::size_t rows, std::size_t cols, std::size_t inner, double factor) {
+	for(std::size_t row = 0; row < rows; row++) {
+		double* cRow = c + row * cStride;
+		for(std::size_t i = 0; i < inner; i++) {
+			double aFactor = factor * a[row * aStride + i];
+			const double* bRow = b + i * bStride;
+			for(std::size_t col = 0; col < cols; col++) {
+				cRow[col] += aFactor * bRow[col];
+			}
+		}
+	}
+}
+
+void rowMultiplyAddScalar(double* dest, const double* src, std::size_t count, double factor) {
+	for(std::size_t i = 0; i < count; i++) {
+		dest[i] += src[i] * factor;
+	}
+}
+
+double dotProductScalar(const double* a, const double* b, std::size_t count) {
+	double total = 0.0;
+	for(std::size_t i = 0; i < count; i++) {
+		total += a[i] * b[i];
+	}
+	return total;
+}
+
+static void multiplyAccumulateBlocked(const DenseKernels& kernels, const double* a, std::size_t aStride, const double* b, std::size_t bStride, double* c, std::size_t cStride, std::size_t rows, std::size_t cols, std::size_t inner, double factor) {
+	for(std::size_t innerStart = 0; innerStart < inner; innerStart += GEMM_INNER_BLOCK) {
+		std::size_t innerSize = std::min<std::size_t>(GEMM_INNER_BLOCK, inner - innerStart);
+		for(std::size_t colStart = 0; colStart < cols; colStart += GEMM_COL_BLOCK) {
+			std::size_t colSize = std::min<std::size_t>(GEMM_COL_BLOCK, cols - colStart);
+			for(std::size_t rowStart = 0; rowStart < rows; rowStart += GEMM_ROW_BLOCK) {
+				std::size_t rowSize = std::min<std::size_t>(GEMM_ROW_BLOCK, rows - rowStart);
+				kernels.multiplyAccumulateBlock(
+					a + rowStart * aStride + innerStart, aStride,
+					b + innerStart * bStride + colStart, bStride,
+					c + rowStart * cStride + colStart, cStride,
+					rowSize, colSize, innerSize, factor);
+			}
+		}
+	}
+}
+
+void denseMatrixMultiply(const UnmanagedLargeMatrix<double>& a, const UnmanagedLargeMatrix<double>& b, UnmanagedLargeMatrix<double>& result) {
+	assert(a.h == result.h);
+	assert(b.w == result.w);
+	assert(a.w == b.h);
+
+	for(double& d : result) d = 0.0;
+
+	multiplyAccumulateBlocked(getKernels(), a.data, a.w, b.data, b.w, result.data, result.w, result.h, result.w, a.w, 1.0);
+}
+
+/*
+	Right looking blocked LU decomposition
+	Each panel of LU_PANEL_SIZE columns is factored with the unblocked algorithm, after which
+	the rows to the right of it are solved against L11 and the trailing matrix gets a single GEMM update
+	onSwap(a, b) is called for every row swap so that right hand sides or pivot arrays can follow along
+*/
+template<typename SwapHandler>
+static void blockedLUDecompose(const DenseKernels& kernels, UnmanagedLargeMatrix<double>& m, SwapHandler&& onSwap) {
+	assert(m.w == m.h);
+	std::size_t size = m.h;
+	std::size_t stride = m.w;
+	double* data = m.data;
+
+	for(std::size_t panelStart = 0; panelStart < size; panelStart += LU_PANEL_SIZE) {
+		std::size_t panelEnd = std::min<std::size_t>(panelStart + LU_PANEL_SIZE, size);
+
+		for(std::size_t i = panelStart; i < panelEnd; i++) {
+			double bestPivot = std::abs(data[i * stride + i]);
+			std::size_t bestPivotIndex = i;
+			for(std::size_t j = i + 1; j < size; j++) {
+				double newPivot = std::abs(data[j * stride + i]);
+				if(newPivot > bestPivot) {
+					bestPivot = newPivot;
+					bestPivotIndex = j;
+				}
+			}
+
+			if(bestPivotIndex != i) {
+				std::swap_ranges(data + i * stride, data + (i + 1) * stride, data + bestPivotIndex * stride);
+			}
+			onSwap(i, bestPivotIndex);
+
+			double* pivotRow = data + i * stride;
+			double pivot = pivotRow[i];
+			for(std::size_t j = i + 1; j < size; j++) {
+				double* editRow = data + j * stride;
+				double factor = editRow[i] / pivot;
+				editRow[i] = factor;
+				kernels.rowMultiplyAdd(editRow + i + 1, pivotRow + i + 1, panelEnd - i - 1, -factor);
+			}
+		}
+
+		if(panelEnd < size) {
+			std::size_t trailingSize = size - panelEnd;
+
+			// U12 = L11^-1 * A12
+			for(std::size_t row = panelStart + 1; row < panelEnd; row++) {
+				for(std::size_t i = panelStart; i < row; i++) {
+					kernels.rowMultiplyAdd(data + row * stride + panelEnd, data + i * stride + panelEnd, trailingSize, -data[row * stride + i]);
+				}
+			}
+
+			// A22 -= L21 * U12
+			multiplyAccumulateBlocked(kernels,
+				data + panelEnd * stride + panelStart, stride,
+				data + panelStart * stride + panelEnd, stride,
+				data + panelEnd * stride + panelEnd, stride,
+				trailingSize, trailingSize, panelEnd - panelStart, -1.0);
+		}
+	}
+}
+
+static void solveLowerUnitTriangular(const DenseKernels& kernels, const UnmanagedLargeMatrix<double>& l, double* rhs, std::size_t rhsWidth) {
+	std::size_t size = l.h;
+	for(std::size_t row = 1; row < size; row++) {
+		const double* lRow = l.data + row * l.w;
+		if(rhsWidth == 1) {
+			rhs[row] -= kernels.dotProduct(lRow, rhs, row);
+		} else {
+			for(std::size_t i = 0; i < row; i++) {
+				kernels.rowMultiplyAdd(rhs + row * rhsWidth, rhs + i * rhsWidth, rhsWidth, -lRow[i]);
+			}
+		}
+	}
+}
+
+static void solveUpperTriangular(const DenseKernels& kernels, const UnmanagedLargeMatrix<double>& u, double* rhs, std::size_t rhsWidth) {
+	std::size_t size = u.h;
+	for(std::size_t row = size; row-- > 0;) {
+		const double* uRow = u.data + row * u.w;
+		double inverseDiagonal = 1 / uRow[row];
+		if(rhsWidth == 1) {
+			rhs[row] = (rhs[row] - kernels.dotProduct(uRow + row + 1, rhs + row + 1, size - row - 1)) * inverseDiagonal;
+		} else {
+			double* rhsRow = rhs + row * rhsWidth;
+			for(std::size_t i = row + 1; i < size; i++) {
+				kernels.rowMultiplyAdd(rhsRow, rhs + i * rhsWidth, rhsWidth, -uRow[i]);
+			}
+			for(std::size_t i = 0; i < rhsWidth; i++) {
+				rhsRow[i] *= inverseDiagonal;
+			}
+		}
+	}
+}
+
+void luDecompose(UnmanagedLargeMatrix<double>& m, std::size_t* pivots) {
+	blockedLUDecompose(getKernels(), m, [pivots](std::size_t row, std::size_t swappedWith) {
+		pivots[row] = swappedWith;
+	});
+}
+
+void luSolve(const UnmanagedLargeMatrix<double>& lu, const std::size_t* pivots, double* rhs, std::size_t rhsWidth) {
+	DenseKernels kernels = getKernels();
+	for(std::size_t row = 0; row < lu.h; row++) {
+		if(pivots[row] != row) {
+			std::swap_ranges(rhs + row * rhsWidth, rhs + (row + 1) * rhsWidth, rhs + pivots[row] * rhsWidth);
+		}
+	}
+	solveLowerUnitTriangular(kernels, lu, rhs, rhsWidth);
+	solveUpperTriangular(kernels, lu, rhs, rhsWidth);
+}
+
+void luSolve(const UnmanagedLargeMatrix<double>& lu, const std::size_t* pivots, UnmanagedLargeVector<double>& v) {
+	assert(v.n == lu.h);
+	luSolve(lu, pivots, v.data, 1);
+}
+
+void solveLowerUnitTriangular(const UnmanagedLargeMatrix<double>& l, double* rhs, std::size_t rhsWidth) {
+	solveLowerUnitTriangular(getKernels(), l, rhs, rhsWidth);
+}
+
+void solveUpperTriangular(const UnmanagedLargeMatrix<double>& u, double* rhs, std::size_t rhsWidth) {
+	solveUpperTriangular(getKernels(), u, rhs, rhsWidth);
+}
+
+void destructiveSolveDense(UnmanagedLargeMatrix<double>& m, double* rhs, std::size_t rhsWidth) {
+	DenseKernels kernels = getKernels();
+	blockedLUDecompose(kernels, m, [rhs, rhsWidth](std::size_t row, std::size_t swappedWith) {
+		if(row != swappedWith) {
+			std::swap_ranges(rhs + row * rhsWidth, rhs + (row + 1) * rhsWidth, rhs + swappedWith * rhsWidth);
+		}
+	});
+	solveLowerUnitTriangular(kernels, m, rhs, rhsWidth);
+	solveUpperTriangular(kernels, m, rhs, rhsWidth);
+}
+};
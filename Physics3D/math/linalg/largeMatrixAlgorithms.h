@@ -5,6 +5,7 @@
 
 #include <utility>
 #include <cmath>
+#include <type_traits>
 #include <assert.h>
 #include <stddef.h>
 
@@ -95,9 +96,54 @@ static std::size_t getHeight(UnmanagedVerticalFixedMatrix<T, Rows>& m) {
 	return Rows;
 }
 
+/*
+	Dense kernels for double matrices
+	These are cache blocked and are dispatched at runtime to AVX2/FMA implementations when CPUIDCheck reports them
+	Solution blocks are row-major: rhsWidth values per row, one row per equation
+*/
+
+// result = a * b
+void denseMatrixMultiply(const UnmanagedLargeMatrix<double>& a, const UnmanagedLargeMatrix<double>& b, UnmanagedLargeMatrix<double>& result);
+
+// In place LU decomposition with partial pivoting
+// Afterwards m holds U on and above the diagonal and L below it, L has an implicit unit diagonal
+// In step i row i was swapped with row pivots[i], pivots must have room for m.h elements
+void luDecompose(UnmanagedLargeMatrix<double>& m, std::size_t* pivots);
+// Solves m * x = rhs in place given the result of luDecompose
+void luSolve(const UnmanagedLargeMatrix<double>& lu, const std::size_t* pivots, double* rhs, std::size_t rhsWidth);
+void luSolve(const UnmanagedLargeMatrix<double>& lu, const std::size_t* pivots, UnmanagedLargeVector<double>& v);
+
+// Solves L * x = rhs in place, using only the part of l below the diagonal, the diagonal is assumed to be 1
+void solveLowerUnitTriangular(const UnmanagedLargeMatrix<double>& l, double* rhs, std::size_t rhsWidth);
+// Solves U * x = rhs in place, using only the part of u on and above the diagonal
+void solveUpperTriangular(const UnmanagedLargeMatrix<double>& u, double* rhs, std::size_t rhsWidth);
+
+// Equivalent to luDecompose followed by luSolve, but applies the row swaps to rhs directly, without needing a pivot buffer
+void destructiveSolveDense(UnmanagedLargeMatrix<double>& m, double* rhs, std::size_t rhsWidth);
+
+inline std::size_t getRowMajorWidth(const UnmanagedLargeVector<double>&) {
+	return 1;
+}
+template<std::size_t Cols>
+inline std::size_t getRowMajorWidth(const UnmanagedHorizontalFixedMatrix<double, Cols>&) {
+	return Cols;
+}
+
+// true for the solution types the dense kernels can solve for, those with a getRowMajorWidth overload
+template<typename SolutionType, typename = void>
+struct HasRowMajorWidth : std::false_type {};
+template<typename SolutionType>
+struct HasRowMajorWidth<SolutionType, std::void_t<decltype(getRowMajorWidth(std::declval<const SolutionType&>()))>> : std::true_type {};
+
 template<typename System, typename SolutionType>
 void destructiveSolve(System& m, SolutionType& v) {
 	assert(getHeight(v) == m.w && m.w == m.h);
+
+	if constexpr(std::is_base_of_v<UnmanagedLargeMatrix<double>, System> && HasRowMajorWidth<SolutionType>::value) {
+		destructiveSolveDense(m, v.data, getRowMajorWidth(v));
+		return;
+	}
+
 	std::size_t size = getHeight(v);
 
 	// make matrix upper triangular
@@ -0,0 +1,102 @@
+#include "largeMatrixKernels.h"
+
+#include <immintrin.h>
+
+// AVX2/FMA implementations of the dense kernels
+namespace P3D {
+inline static double horizontalSum(__m256d v) {
+	__m128d sum = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+	return _mm_cvtsd_f64(_mm_add_sd(sum, _mm_unpackhi_pd(sum, sum)));
+}
+
+// Computes a Rows x (4 * Vecs) tile of c, keeping all accumulators in registers
+template<int Rows, int Vecs>
+inline static void multiplyAccumulateTile(const double* a, std::size_t aStride, const double* b, std::size_t bStride, double* c, std::size_t cStride, std::size_t inner, __m256d factor) {
+	__m256d accumulators[Rows][Vecs];
+	for(int r = 0; r < Rows; r++) {
+		for(int v = 0; v < Vecs; v++) {
+			accumulators[r][v] = _mm256_setzero_pd();
+		}
+	}
+
+	for(std::size_t i = 0; i < inner; i++) {
+		__m256d bValues[Vecs];
+		for(int v = 0; v < Vecs; v++) {
+			bValues[v] = _mm256_loadu_pd(b + i * bStride + 4 * v);
+		}
+		for(int r = 0; r < Rows; r++) {
+			__m256d aValue = _mm256_broadcast_sd(a + r * aStride + i);
+			for(int v = 0; v < Vecs; v++) {
+				accumulators[r][v] = _mm256_fmadd_pd(aValue, bValues[v], accumulators[r][v]);
+			}
+		}
+	}
+
+	for(int r = 0; r < Rows; r++) {
+		for(int v = 0; v < Vecs; v++) {
+			double* cPtr = c + r * cStride + 4 * v;
+			_mm256_storeu_pd(cPtr, _mm256_fmadd_pd(factor, accumulators[r][v], _mm256_loadu_pd(cPtr)));
+		}
+	}
+}
+
+template<int Rows>
+inline static void multiplyAccumulateRows(const double* a, std::size_t aStride, const double* b, std::size_t bStride, double* c, std::size_t cStride, std::size_t cols, std::size_t inner, double factor) {
+	__m256d factorVec = _mm256_set1_pd(factor);
+	std::size_t col = 0;
+	for(; col + 8 <= cols; col += 8) {
+		multiplyAccumulateTile<Rows, 2>(a, aStride, b + col, bStride, c + col, cStride, inner, factorVec);
+	}
+	for(; col + 4 <= cols; col += 4) {
+		multiplyAccumulateTile<Rows, 1>(a, aStride, b + col, bStride, c + col, cStride, inner, factorVec);
+	}
+	for(; col < cols; col++) {
+		for(int r = 0; r < Rows; r++) {
+			double total = 0.0;
+			for(std::size_t i = 0; i < inner; i++) {
+				total += a[r * aStride + i] * b[i * bStride + col];
+			}
+			c[r * cStride + col] += factor * total;
+		}
+	}
+}
+
+void multiplyAccumulateBlockAVX(const double* a, std::size_t aStride, const double* b, std::size_t bStride, double* c, std::size_t cStride, std::size_t rows, std::size_t cols, std::size_t inner, double factor) {
+	std::size_t row = 0;
+	for(; row + 4 <= rows; row += 4) {
+		multiplyAccumulateRows<4>(a + row * aStride, aStride, b, bStride, c + row * cStride, cStride, cols, inner, factor);
+	}
+	for(; row < rows; row++) {
+		multiplyAccumulateRows<1>(a + row * aStride, aStride, b, bStride, c + row * cStride, cStride, cols, inner, factor);
+	}
+}
+
+void rowMultiplyAddAVX(double* dest, const double* src, std::size_t count, double factor) {
+	__m256d factorVec = _mm256_set1_pd(factor);
+	std::size_t i = 0;
+	for(; i + 4 <= count; i += 4) {
+		_mm256_storeu_pd(dest + i, _mm256_fmadd_pd(_mm256_loadu_pd(src + i), factorVec, _mm256_loadu_pd(dest + i)));
+	}
+	for(; i < count; i++) {
+		dest[i] += src[i] * factor;
+	}
+}
+
+double dotProductAVX(const double* a, const double* b, std::size_t count) {
+	__m256d total0 = _mm256_setzero_pd();
+	__m256d total1 = _mm256_setzero_pd();
+	std::size_t i = 0;
+	for(; i + 8 <= count; i += 8) {
+		total0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), total0);
+		total1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4), total1);
+	}
+	for(; i + 4 <= count; i += 4) {
+		total0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), total0);
+	}
+	double total = horizontalSum(_mm256_add_pd(total0, total1));
+	for(; i < count; i++) {
+		total += a[i] * b[i];
+	}
+	return total;
+}
+};
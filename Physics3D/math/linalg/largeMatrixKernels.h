@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+
+// Raw strided kernels used by the dense algorithms in largeMatrixAlgorithms.cpp
+// All matrices are row-major, strides are given in elements
+namespace P3D {
+// c += factor * (a * b), a is rows x inner, b is inner x cols, c is rows x cols
+void multiplyAccumulateBlockScalar(const double* a, std::size_t aStride, const double* b, std::size_t bStride, double* c, std::size_t cStride, std::size_t rows, std::size_t cols, std::size_t inner, double factor);
+void multiplyAccumulateBlockAVX(const double* a, std::size_t aStride, const double* b, std::size_t bStride, double* c, std::size_t cStride, std::size_t rows, std::size_t cols, std::size_t inner, double factor);
+
+// dest += factor * src
+void rowMultiplyAddScalar(double* dest, const double* src, std::size_t count, double factor);
+void rowMultiplyAddAVX(double* dest, const double* src, std::size_t count, double factor);
+
+double dotProductScalar(const double* a, const double* b, std::size_t count);
+double dotProductAVX(const double* a, const double* b, std::size_t count);
+};
@@ -0,0 +1,167 @@
+#include "allocationTracker.h"
+
+#include "physicsProfiler.h"
+
+#if P3D_ALLOCATION_TRACKING
+#include <new>
+#include <cstdlib>
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
+#endif
+
+namespace P3D {
+namespace AllocationTracker {
+std::atomic<bool> enabled{false};
+
+// processes beyond this and unmarked allocations share the last slot
+static constexpr std::size_t MAX_PROCESS_COUNT = 32;
+static constexpr std::size_t UNMARKED = MAX_PROCESS_COUNT;
+
+struct AtomicCounts {
+	std::atomic<std::uint64_t> allocations{0};
+	std::atomic<std::uint64_t> bytes{0};
+	std::atomic<std::uint64_t> frees{0};
+};
+
+static AtomicCounts processCounts[MAX_PROCESS_COUNT + 1];
+
+static AllocationCounts loadCounts(const AtomicCounts& counts) {
+	AllocationCounts result;
+	result.allocations = counts.allocations.load(std::memory_order_relaxed);
+	result.bytes = counts.bytes.load(std::memory_order_relaxed);
+	result.frees = counts.frees.load(std::memory_order_relaxed);
+	return result;
+}
+
+AllocationCounts getCounts(PhysicsProcess process) {
+	std::size_t index = static_cast<std::size_t>(process);
+	if(index >= MAX_PROCESS_COUNT) return AllocationCounts();
+	return loadCounts(processCounts[index]);
+}
+
+AllocationCounts getUnmarkedCounts() {
+	return loadCounts(processCounts[UNMARKED]);
+}
+
+AllocationCounts getTotalCounts() {
+	AllocationCounts total;
+	for(const AtomicCounts& counts : processCounts) {
+		AllocationCounts c = loadCounts(counts);
+		total.allocations += c.allocations;
+		total.bytes += c.bytes;
+		total.frees += c.frees;
+	}
+	return total;
+}
+
+void reset() {
+	for(AtomicCounts& counts : processCounts) {
+		counts.allocations.store(0, std::memory_order_relaxed);
+		counts.bytes.store(0, std::memory_order_relaxed);
+		counts.frees.store(0, std::memory_order_relaxed);
+	}
+}
+
+#if P3D_ALLOCATION_TRACKING
+// constant initialized, so reading it never allocates
+static thread_local std::size_t currentProcess = UNMARKED;
+
+void setCurrentProcess(int processIndex) {
+	currentProcess = (processIndex < 0 || processIndex >= static_cast<int>(MAX_PROCESS_COUNT)) ? UNMARKED : static_cast<std::size_t>(processIndex);
+}
+
+void recordAllocation(std::size_t bytes) {
+	if(!enabled.load(std::memory_order_relaxed)) return;
+	AtomicCounts& counts = processCounts[currentProcess];
+	counts.allocations.fetch_add(1, std::memory_order_relaxed);
+	counts.bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void recordFree() {
+	if(!enabled.load(std::memory_order_relaxed)) return;
+	processCounts[currentProcess].frees.fetch_add(1, std::memory_order_relaxed);
+}
+#endif
+};
+};
+
+#if P3D_ALLOCATION_TRACKING
+static void* trackedAlloc(std::size_t size) {
+	P3D::AllocationTracker::recordAllocation(size);
+	return std::malloc(size == 0 ? 1 : size);
+}
+
+static void* trackedAlignedAlloc(std::size_t size, std::size_t align) {
+	P3D::AllocationTracker::recordAllocation(size);
+#ifdef _MSC_VER
+	return _aligned_malloc(size == 0 ? 1 : size, align);
+#else
+	// aligned_alloc requires a size that is a multiple of align
+	std::size_t roundedSize = (size + align - 1) / align * align;
+	return std::aligned_alloc(align, roundedSize == 0 ? align : roundedSize);
+#endif
+}
+
+static void trackedFree(void* ptr) {
+	if(ptr == nullptr) return;
+	P3D::AllocationTracker::recordFree();
+	std::free(ptr);
+}
+
+static void trackedAlignedFree(void* ptr) {
+	if(ptr == nullptr) return;
+	P3D::AllocationTracker::recordFree();
+#ifdef _MSC_VER
+	_aligned_free(ptr);
+#else
+	std::free(ptr);
+#endif
+}
+
+void* operator new(std::size_t size) {
+	void* ptr = trackedAlloc(size);
+	if(ptr == nullptr) throw std::bad_alloc();
+	return ptr;
+}
+void* operator new[](std::size_t size) {
+	void* ptr = trackedAlloc(size);
+	if(ptr == nullptr) throw std::bad_alloc();
+	return ptr;
+}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+	return trackedAlloc(size);
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+	return trackedAlloc(size);
+}
+void* operator new(std::size_t size, std::align_val_t align) {
+	void* ptr = trackedAlignedAlloc(size, static_cast<std::size_t>(align));
+	if(ptr == nullptr) throw std::bad_alloc();
+	return ptr;
+}
+void* operator new[](std::size_t size, std::align_val_t align) {
+	void* ptr = trackedAlignedAlloc(size, static_cast<std::size_t>(align));
+	if(ptr == nullptr) throw std::bad_alloc();
+	return ptr;
+}
+void* operator new(std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+	return trackedAlignedAlloc(size, static_cast<std::size_t>(align));
+}
+void* operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+	return trackedAlignedAlloc(size, static_cast<std::size_t>(align));
+}
+
+void operator delete(void* ptr) noexcept { trackedFree(ptr); }
+void operator delete[](void* ptr) noexcept { trackedFree(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { trackedFree(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { trackedFree(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { trackedFree(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { trackedFree(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { trackedAlignedFree(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { trackedAlignedFree(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { trackedAlignedFree(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { trackedAlignedFree(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { trackedAlignedFree(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { trackedAlignedFree(ptr); }
+#endif
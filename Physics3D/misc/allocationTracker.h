@@ -0,0 +1,43 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "buildOptions.h"
+
+namespace P3D {
+enum class PhysicsProcess;
+
+struct AllocationCounts {
+	std::uint64_t allocations = 0;
+	std::uint64_t bytes = 0;
+	std::uint64_t frees = 0;
+};
+
+/*
+	Counts the allocations made through the global operator new and through aligned_malloc, by the process the allocating thread is in
+	The process of a thread is the one it last marked in a ThreadedBreakdownProfiler such as physicsMeasure, allocations of threads outside of any process are unmarked
+
+	Compiled in with P3D_ALLOCATION_TRACKING, which replaces the global operator new and delete of the whole program
+	Without it, nothing is counted and all counts stay 0
+	Opt-in at runtime with enabled, a disabled tracker costs one atomic load per allocation
+*/
+namespace AllocationTracker {
+extern std::atomic<bool> enabled;
+
+constexpr bool isCompiledIn() { return P3D_ALLOCATION_TRACKING != 0; }
+
+AllocationCounts getCounts(PhysicsProcess process);
+AllocationCounts getUnmarkedCounts();
+AllocationCounts getTotalCounts();
+void reset();
+
+#if P3D_ALLOCATION_TRACKING
+// called by ThreadedBreakdownProfiler::mark, -1 when the thread goes idle
+void setCurrentProcess(int processIndex);
+void recordAllocation(std::size_t bytes);
+void recordFree();
+#endif
+};
+};
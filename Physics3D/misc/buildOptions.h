@@ -0,0 +1,18 @@
+#pragma once
+
+// Set by the options of the CMake build, builds without them get these defaults
+
+// physicsMeasure, physicsTracer and TraceScope, disabled they keep their APIs but record nothing
+#ifndef P3D_PROFILING
+#define P3D_PROFILING 1
+#endif
+
+// Debug::logVector, logPoint, logCFrame and logShape, disabled they compile to empty inline functions
+#ifndef P3D_DEBUG_VIS
+#define P3D_DEBUG_VIS 1
+#endif
+
+// AllocationTracker, replaces the global operator new and delete to count allocations per physics process, off by default
+#ifndef P3D_ALLOCATION_TRACKING
+#define P3D_ALLOCATION_TRACKING 0
+#endif
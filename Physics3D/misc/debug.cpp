@@ -20,10 +20,44 @@ void(*logAction)(const char*, std::va_list) = [](const char* format, std::va_lis
 void(*logWarnAction)(const char*, std::va_list) = [](const char* format, std::va_list args) { std::cout << "WARN: ";  vprintf(format, args); };
 void(*logErrorAction)(const char*, std::va_list) = [](const char* format, std::va_list args) { std::cout << "ERROR: ";  vprintf(format, args); };
 
-void logVector(Position origin, Vec3 vec, VectorType type) { logVecAction(origin, vec, type); };
-void logPoint(Position point, PointType type) { logPointAction(point, type); }
+#if P3D_DEBUG_VIS
+static thread_local VisualLogBuffer* redirectBuffer = nullptr;
+
+void VisualLogBuffer::flush() {
+	for(const LoggedVector& v : vectors) {
+		logVecAction(v.origin, v.vec, v.type);
+	}
+	for(const LoggedPoint& p : points) {
+		logPointAction(p.point, p.type);
+	}
+	vectors.clear();
+	points.clear();
+}
+
+VisualLogRedirect::VisualLogRedirect(VisualLogBuffer& buffer) : previous(redirectBuffer) {
+	redirectBuffer = &buffer;
+}
+VisualLogRedirect::~VisualLogRedirect() {
+	redirectBuffer = previous;
+}
+
+void logVector(Position origin, Vec3 vec, VectorType type) {
+	if(redirectBuffer != nullptr) {
+		redirectBuffer->vectors.push_back(VisualLogBuffer::LoggedVector{origin, vec, type});
+	} else {
+		logVecAction(origin, vec, type);
+	}
+}
+void logPoint(Position point, PointType type) {
+	if(redirectBuffer != nullptr) {
+		redirectBuffer->points.push_back(VisualLogBuffer::LoggedPoint{point, type});
+	} else {
+		logPointAction(point, type);
+	}
+}
 void logCFrame(CFrame frame, CFrameType type) { logCFrameAction(frame, type); };
 void logShape(const Polyhedron& shape, const GlobalCFrame& location) { logShapeAction(shape, location); };
+#endif
 void log(const char* format, ...) {
 	std::va_list args;
 	va_start(args, format);
@@ -1,11 +1,13 @@
 #pragma once
 
 #include <cstdarg>
+#include <vector>
 
 #include "../math/linalg/vec.h"
 #include "../math/position.h"
 #include "../math/cframe.h"
 #include "../math/globalCFrame.h"
+#include "buildOptions.h"
 
 namespace P3D {
 class Part;
@@ -37,10 +39,60 @@ enum CFrameType {
 	INERTIAL_CFRAME
 };
 
+#if P3D_DEBUG_VIS
+/*
+	Holds the vectors and points logged on a thread while a VisualLogRedirect to it is alive
+	The log actions aren't thread safe, so work on other threads logs into buffers that are flushed after it is joined
+*/
+class VisualLogBuffer {
+	struct LoggedVector {
+		Position origin;
+		Vec3 vec;
+		VectorType type;
+	};
+	struct LoggedPoint {
+		Position point;
+		PointType type;
+	};
+	std::vector<LoggedVector> vectors;
+	std::vector<LoggedPoint> points;
+
+	friend void logVector(Position origin, Vec3 vec, VectorType type);
+	friend void logPoint(Position point, PointType type);
+public:
+	// passes everything logged into this buffer to the log actions and empties it, only call this on the thread that owns the log actions
+	void flush();
+};
+
+// redirects logVector and logPoint of the calling thread into buffer for the lifetime of this object
+class VisualLogRedirect {
+	VisualLogBuffer* previous;
+public:
+	explicit VisualLogRedirect(VisualLogBuffer& buffer);
+	~VisualLogRedirect();
+	VisualLogRedirect(const VisualLogRedirect&) = delete;
+	VisualLogRedirect& operator=(const VisualLogRedirect&) = delete;
+};
+
 void logVector(Position origin, Vec3 vec, VectorType type);
 void logPoint(Position point, PointType type);
 void logCFrame(CFrame frame, CFrameType type);
 void logShape(const Polyhedron& shape, const GlobalCFrame& location);
+#else
+class VisualLogBuffer {
+public:
+	void flush() {}
+};
+class VisualLogRedirect {
+public:
+	explicit VisualLogRedirect(VisualLogBuffer&) {}
+};
+
+inline void logVector(Position, Vec3, VectorType) {}
+inline void logPoint(Position, PointType) {}
+inline void logCFrame(CFrame, CFrameType) {}
+inline void logShape(const Polyhedron&, const GlobalCFrame&) {}
+#endif
 void log(const char* format, ...);
 void logWarn(const char* format, ...);
 void logError(const char* format, ...);
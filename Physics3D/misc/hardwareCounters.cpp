@@ -0,0 +1,135 @@
+#include "hardwareCounters.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+namespace P3D {
+const char* const hardwareCounterLabels[HARDWARE_COUNTER_COUNT]{
+	"cycles",
+	"instructions",
+	"llc_misses",
+	"branch_misses"
+};
+
+ThreadHardwareCounters::ThreadHardwareCounters() {
+	for(std::size_t i = 0; i < HARDWARE_COUNTER_COUNT; i++) {
+		readIndex[i] = -1;
+		fds[i] = -1;
+	}
+}
+
+ThreadHardwareCounters::~ThreadHardwareCounters() {
+	close();
+}
+
+#ifdef __linux__
+static const std::uint64_t perfEventConfigs[HARDWARE_COUNTER_COUNT]{
+	PERF_COUNT_HW_CPU_CYCLES,
+	PERF_COUNT_HW_INSTRUCTIONS,
+	PERF_COUNT_HW_CACHE_MISSES,
+	PERF_COUNT_HW_BRANCH_MISSES
+};
+
+static int openPerfEvent(std::uint64_t config, int groupFD) {
+	perf_event_attr attr;
+	std::memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.config = config;
+	attr.disabled = groupFD == -1 ? 1 : 0;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	attr.read_format = PERF_FORMAT_GROUP;
+	return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, groupFD, 0));
+}
+
+bool ThreadHardwareCounters::open() {
+	close();
+	for(std::size_t i = 0; i < HARDWARE_COUNTER_COUNT; i++) {
+		int fd = openPerfEvent(perfEventConfigs[i], groupFD);
+		if(fd == -1) continue;
+		fds[i] = fd;
+		readIndex[i] = openCount++;
+		if(groupFD == -1) groupFD = fd;
+	}
+	if(groupFD == -1) return false;
+	ioctl(groupFD, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+	ioctl(groupFD, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+	return true;
+}
+
+void ThreadHardwareCounters::close() {
+	for(std::size_t i = 0; i < HARDWARE_COUNTER_COUNT; i++) {
+		if(fds[i] != -1) ::close(fds[i]);
+		fds[i] = -1;
+		readIndex[i] = -1;
+	}
+	groupFD = -1;
+	openCount = 0;
+}
+
+HardwareCounterValues ThreadHardwareCounters::read() const {
+	HardwareCounterValues result;
+	if(groupFD == -1) return result;
+	// PERF_FORMAT_GROUP: the number of counters, followed by their values in the order they were opened
+	std::uint64_t buffer[1 + HARDWARE_COUNTER_COUNT];
+	ssize_t bytesRead = ::read(groupFD, buffer, sizeof(std::uint64_t) * (1 + openCount));
+	if(bytesRead != static_cast<ssize_t>(sizeof(std::uint64_t) * (1 + openCount))) return result;
+	for(std::size_t i = 0; i < HARDWARE_COUNTER_COUNT; i++) {
+		if(readIndex[i] != -1) result.values[i] = buffer[1 + readIndex[i]];
+	}
+	return result;
+}
+#else
+bool ThreadHardwareCounters::open() {
+	return false;
+}
+
+void ThreadHardwareCounters::close() {}
+
+HardwareCounterValues ThreadHardwareCounters::read() const {
+	return HardwareCounterValues();
+}
+#endif
+
+HardwareCounterTotals::HardwareCounterTotals() {
+	reset();
+}
+
+void HardwareCounterTotals::addTick(const HardwareCounterValues& tickValues) {
+	for(std::size_t i = 0; i < HARDWARE_COUNTER_COUNT; i++) {
+		totals[i].fetch_add(tickValues.values[i], std::memory_order_relaxed);
+	}
+	tickCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void HardwareCounterTotals::reset() {
+	for(std::atomic<std::uint64_t>& total : totals) {
+		total.store(0, std::memory_order_relaxed);
+	}
+	tickCount.store(0, std::memory_order_relaxed);
+}
+
+std::uint64_t HardwareCounterTotals::getTickCount() const {
+	return tickCount.load(std::memory_order_relaxed);
+}
+
+HardwareCounterValues HardwareCounterTotals::getTotals() const {
+	HardwareCounterValues result;
+	for(std::size_t i = 0; i < HARDWARE_COUNTER_COUNT; i++) {
+		result.values[i] = totals[i].load(std::memory_order_relaxed);
+	}
+	return result;
+}
+
+double HardwareCounterTotals::getMeanPerTick(HardwareCounter counter) const {
+	std::uint64_t ticks = getTickCount();
+	if(ticks == 0) return 0.0;
+	return static_cast<double>(totals[static_cast<std::size_t>(counter)].load(std::memory_order_relaxed)) / ticks;
+}
+};
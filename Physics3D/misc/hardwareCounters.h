@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace P3D {
+enum class HardwareCounter {
+	CYCLES,
+	INSTRUCTIONS,
+	LLC_MISSES,
+	BRANCH_MISSES,
+	COUNT
+};
+
+static constexpr std::size_t HARDWARE_COUNTER_COUNT = static_cast<std::size_t>(HardwareCounter::COUNT);
+
+// names as used in the latency exports
+extern const char* const hardwareCounterLabels[HARDWARE_COUNTER_COUNT];
+
+struct HardwareCounterValues {
+	std::uint64_t values[HARDWARE_COUNTER_COUNT]{};
+
+	inline std::uint64_t& operator[](HardwareCounter counter) { return values[static_cast<std::size_t>(counter)]; }
+	inline std::uint64_t operator[](HardwareCounter counter) const { return values[static_cast<std::size_t>(counter)]; }
+};
+
+/*
+	Hardware counters of the thread that opened them, using perf_event_open on Linux
+
+	open() returns false when no counters can be opened: on other platforms, without a PMU as in many VMs and containers, or with a too high perf_event_paranoid
+	Counters that the CPU doesn't support are left out, and read as 0
+	Only kernel and hypervisor time is excluded, so the counters work with perf_event_paranoid up to 2
+	A read is a system call, about a microsecond
+*/
+class ThreadHardwareCounters {
+	int groupFD = -1;
+	// index of each counter in the group read, -1 when it could not be opened
+	int readIndex[HARDWARE_COUNTER_COUNT];
+	int fds[HARDWARE_COUNTER_COUNT];
+	int openCount = 0;
+public:
+	ThreadHardwareCounters();
+	~ThreadHardwareCounters();
+	ThreadHardwareCounters(const ThreadHardwareCounters&) = delete;
+	ThreadHardwareCounters& operator=(const ThreadHardwareCounters&) = delete;
+
+	// starts counting on the calling thread
+	bool open();
+	void close();
+	inline bool isOpen() const { return groupFD != -1; }
+	// counts since open(), all 0 when not open
+	HardwareCounterValues read() const;
+};
+
+// counts added up over ticks, one thread adds while any thread may read
+class HardwareCounterTotals {
+	std::atomic<std::uint64_t> totals[HARDWARE_COUNTER_COUNT];
+	std::atomic<std::uint64_t> tickCount{0};
+public:
+	HardwareCounterTotals();
+	HardwareCounterTotals(const HardwareCounterTotals&) = delete;
+	HardwareCounterTotals& operator=(const HardwareCounterTotals&) = delete;
+
+	void addTick(const HardwareCounterValues& tickValues);
+	void reset();
+
+	std::uint64_t getTickCount() const;
+	HardwareCounterValues getTotals() const;
+	// 0 when no ticks were counted
+	double getMeanPerTick(HardwareCounter counter) const;
+};
+};
@@ -0,0 +1,123 @@
+#include "intersectionPairStatistics.h"
+
+#include <algorithm>
+#include <string>
+
+#include "../geometry/builtinShapeClasses.h"
+
+namespace P3D {
+IntersectionPairStatistics::ThreadCounts::ThreadCounts(std::thread::id threadID) : threadID(threadID) {
+	for(auto& row : counts) {
+		for(auto& pair : row) {
+			for(std::atomic<std::uint64_t>& field : pair) {
+				field.store(0, std::memory_order_relaxed);
+			}
+		}
+	}
+}
+
+IntersectionPairStatistics::ThreadCounts& IntersectionPairStatistics::getThreadCounts() {
+	ThreadCounts* cached = countsCache.get();
+	if(cached != nullptr) return *cached;
+
+	std::thread::id thisThread = std::this_thread::get_id();
+	std::lock_guard<std::mutex> lock(threadsMutex);
+	ThreadCounts* found = nullptr;
+	for(std::unique_ptr<ThreadCounts>& threadCounts : threads) {
+		if(threadCounts->threadID == thisThread) {
+			found = threadCounts.get();
+			break;
+		}
+	}
+	if(found == nullptr) {
+		threads.push_back(std::make_unique<ThreadCounts>(thisThread));
+		found = threads.back().get();
+	}
+	countsCache.set(found);
+	return *found;
+}
+
+static void orderPair(std::size_t& first, std::size_t& second) {
+	if(first >= IntersectionPairStatistics::CLASS_COUNT) first = IntersectionPairStatistics::CLASS_COUNT - 1;
+	if(second >= IntersectionPairStatistics::CLASS_COUNT) second = IntersectionPairStatistics::CLASS_COUNT - 1;
+	if(first > second) std::swap(first, second);
+}
+
+void IntersectionPairStatistics::record(std::size_t firstClassID, std::size_t secondClassID, bool isHit, std::chrono::nanoseconds time, int gjkIterations, int epaIterations) {
+	orderPair(firstClassID, secondClassID);
+	std::atomic<std::uint64_t>* fields = getThreadCounts().counts[firstClassID][secondClassID];
+	fields[CALLS].fetch_add(1, std::memory_order_relaxed);
+	if(isHit) fields[HITS].fetch_add(1, std::memory_order_relaxed);
+	fields[TIME].fetch_add(time.count(), std::memory_order_relaxed);
+	fields[GJK_ITERATIONS].fetch_add(gjkIterations, std::memory_order_relaxed);
+	fields[EPA_ITERATIONS].fetch_add(epaIterations, std::memory_order_relaxed);
+}
+
+IntersectionPairCounts IntersectionPairStatistics::getCounts(std::size_t firstClassID, std::size_t secondClassID) {
+	orderPair(firstClassID, secondClassID);
+	IntersectionPairCounts result;
+	std::lock_guard<std::mutex> lock(threadsMutex);
+	for(std::unique_ptr<ThreadCounts>& threadCounts : threads) {
+		std::atomic<std::uint64_t>* fields = threadCounts->counts[firstClassID][secondClassID];
+		result.calls += fields[CALLS].load(std::memory_order_relaxed);
+		result.hits += fields[HITS].load(std::memory_order_relaxed);
+		result.time += std::chrono::nanoseconds(fields[TIME].load(std::memory_order_relaxed));
+		result.gjkIterations += fields[GJK_ITERATIONS].load(std::memory_order_relaxed);
+		result.epaIterations += fields[EPA_ITERATIONS].load(std::memory_order_relaxed);
+	}
+	return result;
+}
+
+std::vector<IntersectionPair> IntersectionPairStatistics::getPairs() {
+	std::vector<IntersectionPair> result;
+	for(std::size_t first = 0; first < CLASS_COUNT; first++) {
+		for(std::size_t second = first; second < CLASS_COUNT; second++) {
+			IntersectionPairCounts counts = getCounts(first, second);
+			if(counts.calls != 0) result.push_back(IntersectionPair{first, second, counts});
+		}
+	}
+	std::sort(result.begin(), result.end(), [](const IntersectionPair& a, const IntersectionPair& b) {
+		return a.counts.time > b.counts.time;
+	});
+	return result;
+}
+
+void IntersectionPairStatistics::writeCSV(std::ostream& out) {
+	out << std::fixed;
+	out.precision(3);
+	out << "first,second,calls,hits,hit_rate,total_ms,mean_us,gjk_iterations_mean,epa_iterations_mean\n";
+	for(const IntersectionPair& pair : getPairs()) {
+		const IntersectionPairCounts& c = pair.counts;
+		double calls = static_cast<double>(c.calls);
+		out << getClassName(pair.firstClassID) << ',' << getClassName(pair.secondClassID) << ',' << c.calls << ',' << c.hits << ',' << c.hits / calls << ',';
+		out << std::chrono::duration<double, std::milli>(c.time).count() << ',' << std::chrono::duration<double, std::micro>(c.time).count() / calls << ',';
+		out << c.gjkIterations / calls << ',' << (c.hits == 0 ? 0.0 : c.epaIterations / static_cast<double>(c.hits)) << '\n';
+	}
+}
+
+void IntersectionPairStatistics::reset() {
+	std::lock_guard<std::mutex> lock(threadsMutex);
+	for(std::unique_ptr<ThreadCounts>& threadCounts : threads) {
+		for(auto& row : threadCounts->counts) {
+			for(auto& pair : row) {
+				for(std::atomic<std::uint64_t>& field : pair) {
+					field.store(0, std::memory_order_relaxed);
+				}
+			}
+		}
+	}
+}
+
+std::string IntersectionPairStatistics::getClassName(std::size_t classID) {
+	switch(classID) {
+		case CUBE_CLASS_ID: return "Cube";
+		case SPHERE_CLASS_ID: return "Sphere";
+		case CYLINDER_CLASS_ID: return "Cylinder";
+		case WEDGE_CLASS_ID: return "Wedge";
+		case CORNER_CLASS_ID: return "Corner";
+		case CONVEX_POLYHEDRON_CLASS_ID: return "Polyhedron";
+		case CLASS_COUNT - 1: return "Other";
+		default: return "Class " + std::to_string(classID);
+	}
+}
+};
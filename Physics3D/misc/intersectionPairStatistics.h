@@ -0,0 +1,83 @@
+#pragma once
+
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <vector>
+#include <ostream>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "threadLocalCache.h"
+
+namespace P3D {
+struct IntersectionPairCounts {
+	std::uint64_t calls = 0;
+	std::uint64_t hits = 0;
+	std::chrono::nanoseconds time{0};
+	std::uint64_t gjkIterations = 0;
+	std::uint64_t epaIterations = 0;
+};
+
+struct IntersectionPair {
+	std::size_t firstClassID;
+	std::size_t secondClassID;
+	IntersectionPairCounts counts;
+};
+
+/*
+	Narrowphase calls, hits, time and GJK and EPA iterations, per pair of ShapeClass::intersectionClassID
+	Pairs are unordered, the first class ID of a pair is the smaller one
+	Class IDs from CLASS_COUNT - 1 on are counted together, as "Other"
+
+	Every thread counts into its own matrix, registered on its first record, they are added up when read
+	Counts are kept until reset()
+*/
+class IntersectionPairStatistics {
+public:
+	static constexpr std::size_t CLASS_COUNT = 16;
+
+private:
+	enum Field {
+		CALLS,
+		HITS,
+		TIME,
+		GJK_ITERATIONS,
+		EPA_ITERATIONS,
+		FIELD_COUNT
+	};
+
+	struct ThreadCounts {
+		std::thread::id threadID;
+		// only added to by the owning thread
+		std::atomic<std::uint64_t> counts[CLASS_COUNT][CLASS_COUNT][FIELD_COUNT];
+
+		ThreadCounts(std::thread::id threadID);
+	};
+
+	std::mutex threadsMutex;
+	std::vector<std::unique_ptr<ThreadCounts>> threads;
+	ThreadLocalCache<ThreadCounts> countsCache;
+
+	ThreadCounts& getThreadCounts();
+public:
+	IntersectionPairStatistics() = default;
+	IntersectionPairStatistics(const IntersectionPairStatistics&) = delete;
+	IntersectionPairStatistics& operator=(const IntersectionPairStatistics&) = delete;
+
+	void record(std::size_t firstClassID, std::size_t secondClassID, bool isHit, std::chrono::nanoseconds time, int gjkIterations, int epaIterations);
+
+	IntersectionPairCounts getCounts(std::size_t firstClassID, std::size_t secondClassID);
+	// every pair with at least one call, by descending time
+	std::vector<IntersectionPair> getPairs();
+	// one row per pair of getPairs: first,second,calls,hits,hit_rate,total_ms,mean_us,gjk_iterations_mean,epa_iterations_mean
+	void writeCSV(std::ostream& out);
+	void reset();
+
+	// the name of a builtin class, such as "Polyhedron", or "Class <id>"
+	static std::string getClassName(std::size_t classID);
+};
+};
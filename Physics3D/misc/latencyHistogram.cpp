@@ -0,0 +1,196 @@
+#include "latencyHistogram.h"
+
+#include <cmath>
+#include <fstream>
+
+#include "debug.h"
+#include "hardwareCounters.h"
+
+namespace P3D {
+LatencyHistogram::LatencyHistogram() {
+	for(std::atomic<std::uint64_t>& count : counts) {
+		count.store(0, std::memory_order_relaxed);
+	}
+}
+
+// the number of bits needed to represent value, 0 for 0
+static int getBitWidth(std::uint64_t value) {
+	int width = 0;
+	for(int step = 32; step > 0; step /= 2) {
+		if((value >> step) != 0) {
+			value >>= step;
+			width += step;
+		}
+	}
+	return width + static_cast<int>(value);
+}
+
+std::size_t LatencyHistogram::getBucketIndex(std::uint64_t value) {
+	int bitWidth = getBitWidth(value);
+	int shift = bitWidth > SUB_BUCKET_BITS ? bitWidth - SUB_BUCKET_BITS : 0;
+	return (static_cast<std::size_t>(shift) << (SUB_BUCKET_BITS - 1)) + static_cast<std::size_t>(value >> shift);
+}
+
+std::uint64_t LatencyHistogram::getBucketMaxValue(std::size_t index) {
+	if(index < (std::size_t(1) << SUB_BUCKET_BITS)) return index;
+	int shift = static_cast<int>(index >> (SUB_BUCKET_BITS - 1)) - 1;
+	std::uint64_t subBucket = index - (static_cast<std::size_t>(shift) << (SUB_BUCKET_BITS - 1));
+	return ((subBucket + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(std::chrono::nanoseconds value) {
+	std::uint64_t v = value.count() < 0 ? 0 : static_cast<std::uint64_t>(value.count());
+	if(v > MAX_VALUE) v = MAX_VALUE;
+	counts[getBucketIndex(v)].fetch_add(1, std::memory_order_relaxed);
+	totalCount.fetch_add(1, std::memory_order_relaxed);
+	totalValue.fetch_add(v, std::memory_order_relaxed);
+	// only one thread records, so no compare exchange loop is needed
+	if(v < minValue.load(std::memory_order_relaxed)) minValue.store(v, std::memory_order_relaxed);
+	if(v > maxValue.load(std::memory_order_relaxed)) maxValue.store(v, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::reset() {
+	for(std::atomic<std::uint64_t>& count : counts) {
+		count.store(0, std::memory_order_relaxed);
+	}
+	totalCount.store(0, std::memory_order_relaxed);
+	totalValue.store(0, std::memory_order_relaxed);
+	minValue.store(MAX_VALUE, std::memory_order_relaxed);
+	maxValue.store(0, std::memory_order_relaxed);
+}
+
+std::uint64_t LatencyHistogram::getCount() const {
+	return totalCount.load(std::memory_order_relaxed);
+}
+
+std::chrono::nanoseconds LatencyHistogram::getMin() const {
+	if(getCount() == 0) return std::chrono::nanoseconds(0);
+	return std::chrono::nanoseconds(minValue.load(std::memory_order_relaxed));
+}
+
+std::chrono::nanoseconds LatencyHistogram::getMax() const {
+	return std::chrono::nanoseconds(maxValue.load(std::memory_order_relaxed));
+}
+
+std::chrono::nanoseconds LatencyHistogram::getMean() const {
+	std::uint64_t count = getCount();
+	if(count == 0) return std::chrono::nanoseconds(0);
+	return std::chrono::nanoseconds(totalValue.load(std::memory_order_relaxed) / count);
+}
+
+std::chrono::nanoseconds LatencyHistogram::getPercentile(double percentile) const {
+	std::uint64_t count = getCount();
+	if(count == 0) return std::chrono::nanoseconds(0);
+	if(percentile > 100.0) percentile = 100.0;
+	std::uint64_t target = static_cast<std::uint64_t>(std::ceil(percentile / 100.0 * count));
+	if(target == 0) target = 1;
+
+	std::uint64_t max = maxValue.load(std::memory_order_relaxed);
+	std::uint64_t seen = 0;
+	for(std::size_t i = 0; i < BUCKET_COUNT; i++) {
+		seen += counts[i].load(std::memory_order_relaxed);
+		if(seen >= target) {
+			std::uint64_t bucketMax = getBucketMaxValue(i);
+			return std::chrono::nanoseconds(bucketMax < max ? bucketMax : max);
+		}
+	}
+	return std::chrono::nanoseconds(max);
+}
+
+LatencySummary LatencyHistogram::getSummary() const {
+	return LatencySummary{
+		getCount(),
+		getMin(),
+		getMean(),
+		getPercentile(50.0),
+		getPercentile(90.0),
+		getPercentile(99.0),
+		getPercentile(99.9),
+		getMax()
+	};
+}
+
+static double toMicroseconds(std::chrono::nanoseconds time) {
+	return std::chrono::duration<double, std::micro>(time).count();
+}
+
+static bool hasCountedTicks(const NamedLatencyHistogram& named) {
+	return named.counters != nullptr && named.counters->getTickCount() != 0;
+}
+
+static double getInstructionsPerCycle(const HardwareCounterTotals& counters) {
+	HardwareCounterValues totals = counters.getTotals();
+	if(totals[HardwareCounter::CYCLES] == 0) return 0.0;
+	return static_cast<double>(totals[HardwareCounter::INSTRUCTIONS]) / totals[HardwareCounter::CYCLES];
+}
+
+void writeLatencyCSV(std::ostream& out, const std::vector<NamedLatencyHistogram>& histograms) {
+	bool withCounters = false;
+	for(const NamedLatencyHistogram& named : histograms) {
+		if(hasCountedTicks(named)) withCounters = true;
+	}
+
+	out << std::fixed;
+	out.precision(3);
+	out << "name,count,min_us,mean_us,p50_us,p90_us,p99_us,p999_us,max_us";
+	if(withCounters) {
+		for(const char* label : hardwareCounterLabels) {
+			out << ',' << label << "_per_tick";
+		}
+		out << ",ipc";
+	}
+	out << '\n';
+	for(const NamedLatencyHistogram& named : histograms) {
+		LatencySummary s = named.histogram->getSummary();
+		out << named.name << ',' << s.count << ',' << toMicroseconds(s.min) << ',' << toMicroseconds(s.mean) << ',' << toMicroseconds(s.p50) << ',' << toMicroseconds(s.p90) << ',' << toMicroseconds(s.p99) << ',' << toMicroseconds(s.p999) << ',' << toMicroseconds(s.max);
+		if(withCounters) {
+			if(hasCountedTicks(named)) {
+				for(std::size_t i = 0; i < HARDWARE_COUNTER_COUNT; i++) {
+					out << ',' << named.counters->getMeanPerTick(static_cast<HardwareCounter>(i));
+				}
+				out << ',' << getInstructionsPerCycle(*named.counters);
+			} else {
+				out << std::string(HARDWARE_COUNTER_COUNT + 1, ',');
+			}
+		}
+		out << '\n';
+	}
+}
+
+void writeLatencyJSON(std::ostream& out, const std::vector<NamedLatencyHistogram>& histograms) {
+	out << std::fixed;
+	out.precision(3);
+	out << '{';
+	bool isFirst = true;
+	for(const NamedLatencyHistogram& named : histograms) {
+		LatencySummary s = named.histogram->getSummary();
+		if(!isFirst) out << ',';
+		isFirst = false;
+		out << "\n\"" << named.name << "\":{\"count\":" << s.count << ",\"min_us\":" << toMicroseconds(s.min) << ",\"mean_us\":" << toMicroseconds(s.mean) << ",\"p50_us\":" << toMicroseconds(s.p50) << ",\"p90_us\":" << toMicroseconds(s.p90) << ",\"p99_us\":" << toMicroseconds(s.p99) << ",\"p999_us\":" << toMicroseconds(s.p999) << ",\"max_us\":" << toMicroseconds(s.max);
+		if(hasCountedTicks(named)) {
+			for(std::size_t i = 0; i < HARDWARE_COUNTER_COUNT; i++) {
+				out << ",\"" << hardwareCounterLabels[i] << "_per_tick\":" << named.counters->getMeanPerTick(static_cast<HardwareCounter>(i));
+			}
+			out << ",\"ipc\":" << getInstructionsPerCycle(*named.counters);
+		}
+		out << '}';
+	}
+	out << "\n}\n";
+}
+
+bool saveLatencyReport(const std::string& path, const std::vector<NamedLatencyHistogram>& histograms) {
+	std::ofstream file(path);
+	if(!file.is_open()) {
+		Debug::logWarn("Could not open %s to write a latency report", path.c_str());
+		return false;
+	}
+	const std::string jsonExtension = ".json";
+	bool isJSON = path.size() >= jsonExtension.size() && path.compare(path.size() - jsonExtension.size(), jsonExtension.size(), jsonExtension) == 0;
+	if(isJSON) {
+		writeLatencyJSON(file, histograms);
+	} else {
+		writeLatencyCSV(file, histograms);
+	}
+	return true;
+}
+};
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <chrono>
+#include <atomic>
+#include <vector>
+#include <string>
+#include <ostream>
+#include <cstddef>
+#include <cstdint>
+
+namespace P3D {
+class HardwareCounterTotals;
+
+struct LatencySummary {
+	std::uint64_t count;
+	std::chrono::nanoseconds min;
+	std::chrono::nanoseconds mean;
+	std::chrono::nanoseconds p50;
+	std::chrono::nanoseconds p90;
+	std::chrono::nanoseconds p99;
+	std::chrono::nanoseconds p999;
+	std::chrono::nanoseconds max;
+};
+
+/*
+	HDR style histogram of durations, recording is constant time and the memory use is fixed
+	Buckets are exact up to 2^SUB_BUCKET_BITS ns, above that every power of two is split in 2^(SUB_BUCKET_BITS-1) buckets
+	So percentiles are at most 1/64th above the real value, values above MAX_VALUE are counted as MAX_VALUE
+
+	record() is called by one thread while any number of threads may read, a read during a record may miss that one value
+*/
+class LatencyHistogram {
+public:
+	static constexpr int SUB_BUCKET_BITS = 7;
+	static constexpr int MAX_VALUE_BITS = 43;
+	// about 2.4 hours
+	static constexpr std::uint64_t MAX_VALUE = (std::uint64_t(1) << MAX_VALUE_BITS) - 1;
+	static constexpr std::size_t BUCKET_COUNT = (MAX_VALUE_BITS - SUB_BUCKET_BITS + 2) << (SUB_BUCKET_BITS - 1);
+
+private:
+	std::atomic<std::uint64_t> counts[BUCKET_COUNT];
+	std::atomic<std::uint64_t> totalCount{0};
+	std::atomic<std::uint64_t> totalValue{0};
+	std::atomic<std::uint64_t> minValue{MAX_VALUE};
+	std::atomic<std::uint64_t> maxValue{0};
+
+	static std::size_t getBucketIndex(std::uint64_t value);
+	// the highest value counted in the given bucket
+	static std::uint64_t getBucketMaxValue(std::size_t index);
+
+public:
+	LatencyHistogram();
+	LatencyHistogram(const LatencyHistogram&) = delete;
+	LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+	void record(std::chrono::nanoseconds value);
+	void reset();
+
+	std::uint64_t getCount() const;
+	std::chrono::nanoseconds getMin() const;
+	std::chrono::nanoseconds getMax() const;
+	std::chrono::nanoseconds getMean() const;
+	// percentile in [0, 100], the value below which that percentage of the recorded values lies, 0 when nothing was recorded
+	std::chrono::nanoseconds getPercentile(double percentile) const;
+	LatencySummary getSummary() const;
+};
+
+struct NamedLatencyHistogram {
+	const char* name;
+	const LatencyHistogram* histogram;
+	// exported next to the latencies when any ticks were counted
+	const HardwareCounterTotals* counters = nullptr;
+};
+
+// one row per histogram: name,count,min,mean,p50,p90,p99,p999,max in microseconds
+// followed by the mean hardware counts per tick and the instructions per cycle, when any histogram has counted ticks
+void writeLatencyCSV(std::ostream& out, const std::vector<NamedLatencyHistogram>& histograms);
+// an object with the same fields as writeLatencyCSV per histogram name, hardware counts only for histograms with counted ticks
+void writeLatencyJSON(std::ostream& out, const std::vector<NamedLatencyHistogram>& histograms);
+// JSON if path ends with .json, CSV otherwise
+bool saveLatencyReport(const std::string& path, const std::vector<NamedLatencyHistogram>& histograms);
+};
@@ -14,6 +14,7 @@ const char * physicsLabels[]{
 	"Wait for lock",
 	"Updates",
 	"Queue",
+	"Snapshot",
 	"Other"
 };
 
@@ -44,8 +45,10 @@ const char* iterationLabels[]{
 	"MAX",
 };
 
-BreakdownAverageProfiler<PhysicsProcess> physicsMeasure(physicsLabels, 100);
+EventTracer physicsTracer(1 << 16);
+ThreadedBreakdownProfiler<PhysicsProcess> physicsMeasure(physicsLabels, 100, &physicsTracer);
 HistoricTally<long long, IntersectionResult> intersectionStatistics(intersectionLabels, 1);
+IntersectionPairStatistics intersectionPairStatistics;
 CircularBuffer<int> gjkCollideIterStats(1);
 CircularBuffer<int> gjkNoCollideIterStats(1);
 
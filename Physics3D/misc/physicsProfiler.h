@@ -1,6 +1,7 @@
 #pragma once
 
 #include "profiling.h"
+#include "intersectionPairStatistics.h"
 
 namespace P3D {
 enum class PhysicsProcess {
@@ -16,6 +17,7 @@ enum class PhysicsProcess {
 	WAIT_FOR_LOCK,
 	UPDATING,
 	QUEUE,
+	PUBLISH_SNAPSHOT,
 	OTHER,
 	COUNT
 };
@@ -36,8 +38,12 @@ enum class IterationTime {
 	COUNT = 17
 };
 
-extern BreakdownAverageProfiler<PhysicsProcess> physicsMeasure;
+// records the processes marked in physicsMeasure as trace events when enabled, see EventTracer
+extern EventTracer physicsTracer;
+extern ThreadedBreakdownProfiler<PhysicsProcess> physicsMeasure;
 extern HistoricTally<long long, IntersectionResult> intersectionStatistics;
+// narrowphase statistics per pair of shape classes, only recorded with P3D_PROFILING
+extern IntersectionPairStatistics intersectionPairStatistics;
 extern CircularBuffer<int> gjkCollideIterStats;
 extern CircularBuffer<int> gjkNoCollideIterStats;
 extern HistoricTally<long long, IterationTime> GJKCollidesIterationStatistics;
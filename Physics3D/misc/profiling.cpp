@@ -0,0 +1,24 @@
+#include "profiling.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+namespace P3D {
+std::chrono::nanoseconds getThreadCPUTime() {
+#ifdef _WIN32
+	FILETIME creationTime, exitTime, kernelTime, userTime;
+	GetThreadTimes(GetCurrentThread(), &creationTime, &exitTime, &kernelTime, &userTime);
+	unsigned long long kernel = (static_cast<unsigned long long>(kernelTime.dwHighDateTime) << 32) | kernelTime.dwLowDateTime;
+	unsigned long long user = (static_cast<unsigned long long>(userTime.dwHighDateTime) << 32) | userTime.dwLowDateTime;
+	// FILETIME counts in units of 100 nanoseconds
+	return std::chrono::nanoseconds((kernel + user) * 100);
+#else
+	timespec time;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+	return std::chrono::seconds(time.tv_sec) + std::chrono::nanoseconds(time.tv_nsec);
+#endif
+}
+};
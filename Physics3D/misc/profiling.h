@@ -2,9 +2,22 @@
 
 #include <chrono>
 #include <map>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <vector>
+#include <string>
 
 #include "../datastructures/buffers.h"
 #include "../datastructures/parallelArray.h"
+#include "tracing.h"
+#include "latencyHistogram.h"
+#include "hardwareCounters.h"
+#include "allocationTracker.h"
+#include "threadLocalCache.h"
+#include "debug.h"
+#include "buildOptions.h"
 
 namespace P3D {
 class TimerMeasure {
@@ -113,4 +126,286 @@ public:
 		return 0.0;
 	}
 };
+
+
+// CPU time used by the calling thread since it started
+std::chrono::nanoseconds getThreadCPUTime();
+
+struct ThreadTimes {
+	std::chrono::nanoseconds wallTime;
+	std::chrono::nanoseconds cpuTime;
+};
+
+/*
+	BreakdownAverageProfiler that may be marked from any number of threads at once
+	Every thread marks its own profile, registered with this profiler on its first mark, no locks are taken after that
+	end() is called by the thread running the tick, it merges the profiles of all threads into history, adding up the time of every thread
+
+	A thread is idle until its first mark, and again after marking NO_PROCESS or after end() on that thread
+	CPU time is sampled only when a thread goes from idle to active and back, as it is much slower to read than the wall clock
+	Code that may run on worker threads should mark back to the process it found with getCurrentProcess(), so workers go idle again when done
+
+	With a tracer, every marked process is also recorded as a trace event named by its label, and end() finishes a tick of the tracer
+	Every tick is also recorded into latency histograms, of the whole tick and of each process, which keep percentiles over all ticks since resetLatency()
+
+	With hardwareCountersEnabled, every mark also reads the hardware counters of its thread, and attributes the counts since the previous mark to the process that ended
+	Their totals per process are kept next to the latency histograms and exported with them, see ThreadHardwareCounters
+	Threads without counters are left out, when no thread has them a warning is logged once and the profiler keeps measuring time only
+	Compiled without P3D_PROFILING, marks do nothing and end() only keeps the tick times for getAvgTPS()
+*/
+template<typename ProcessType>
+class ThreadedBreakdownProfiler : public BreakdownAverageProfiler<ProcessType> {
+	static constexpr size_t PROCESS_COUNT = static_cast<size_t>(ProcessType::COUNT);
+
+	struct ThreadProfile {
+		std::thread::id threadID;
+		// getThreadSerial() of the thread using this profile, which changes when a new thread reuses the id of an ended one
+		std::uint64_t threadSerial;
+		// only used by the owning thread
+		std::chrono::high_resolution_clock::time_point startTime;
+		std::chrono::high_resolution_clock::time_point activeSinceTime;
+		std::chrono::nanoseconds activeSinceCPUTime;
+		ProcessType currentProcess = static_cast<ProcessType>(-1);
+		ThreadHardwareCounters counters;
+		HardwareCounterValues lastCounterValues;
+		bool hasLastCounterValues = false;
+		bool countersUnavailable = false;
+		// added to by the owning thread, taken by end()
+		std::atomic<long long> wallTally[PROCESS_COUNT];
+		std::atomic<long long> cpuTime{0};
+		std::atomic<std::uint64_t> counterTally[PROCESS_COUNT][HARDWARE_COUNTER_COUNT];
+		std::atomic<bool> isCounting{false};
+
+		ThreadProfile(std::thread::id threadID, std::uint64_t threadSerial) : threadID(threadID), threadSerial(threadSerial) {
+			for(std::atomic<long long>& t : wallTally) {
+				t.store(0);
+			}
+			for(std::atomic<std::uint64_t>(&processTally)[HARDWARE_COUNTER_COUNT] : counterTally) {
+				for(std::atomic<std::uint64_t>& t : processTally) {
+					t.store(0);
+				}
+			}
+		}
+	};
+
+	std::mutex profilesMutex;
+	std::vector<std::unique_ptr<ThreadProfile>> threadProfiles;
+	ThreadLocalCache<ThreadProfile> profileCache;
+	EventTracer* tracer;
+	// one per process, followed by the one of whole ticks, on the heap as they are large
+	std::unique_ptr<LatencyHistogram[]> latencyHistograms;
+	// laid out like latencyHistograms
+	std::unique_ptr<HardwareCounterTotals[]> counterTotals;
+	bool warnedCountersUnavailable = false;
+
+	ThreadProfile& getThreadProfile() {
+		ThreadProfile* cached = profileCache.get();
+		if(cached != nullptr) return *cached;
+
+		std::thread::id thisThread = std::this_thread::get_id();
+		std::uint64_t thisThreadSerial = getThreadSerial();
+		std::lock_guard<std::mutex> lock(profilesMutex);
+		ThreadProfile* found = nullptr;
+		// ids of threads that ended are reused, their profile is idle
+		for(std::unique_ptr<ThreadProfile>& profile : threadProfiles) {
+			if(profile->threadID == thisThread) {
+				found = profile.get();
+				break;
+			}
+		}
+		if(found == nullptr) {
+			threadProfiles.push_back(std::make_unique<ThreadProfile>(thisThread, thisThreadSerial));
+			found = threadProfiles.back().get();
+		} else if(found->threadSerial != thisThreadSerial) {
+			// the counters count the thread that opened them, which has ended
+			found->threadSerial = thisThreadSerial;
+			found->isCounting.store(false, std::memory_order_relaxed);
+			found->counters.close();
+			found->hasLastCounterValues = false;
+			found->countersUnavailable = false;
+		}
+		profileCache.set(found);
+		return *found;
+	}
+
+	void markCounters(ThreadProfile& profile, bool wasActive, ProcessType oldProcess) {
+		if(!profile.counters.isOpen()) {
+			if(profile.countersUnavailable) return;
+			if(!profile.counters.open()) {
+				profile.countersUnavailable = true;
+				return;
+			}
+			profile.isCounting.store(true, std::memory_order_relaxed);
+		}
+		HardwareCounterValues values = profile.counters.read();
+		if(wasActive && profile.hasLastCounterValues) {
+			for(size_t i = 0; i < HARDWARE_COUNTER_COUNT; i++) {
+				profile.counterTally[static_cast<size_t>(oldProcess)][i].fetch_add(values.values[i] - profile.lastCounterValues.values[i], std::memory_order_relaxed);
+			}
+		}
+		profile.lastCounterValues = values;
+		profile.hasLastCounterValues = true;
+	}
+
+public:
+	static constexpr ProcessType NO_PROCESS = static_cast<ProcessType>(-1);
+
+	// may be changed from any thread, takes effect at the next mark of each thread
+	std::atomic<bool> hardwareCountersEnabled{false};
+
+	// CPU time of all threads during each tick
+	CircularBuffer<std::chrono::nanoseconds> cpuTimeHistory;
+	// wall and CPU time of every thread that was active during the last tick
+	std::vector<ThreadTimes> lastTickThreadTimes;
+
+	inline ThreadedBreakdownProfiler(char const* const labels[PROCESS_COUNT], size_t capacity, EventTracer* tracer = nullptr) : BreakdownAverageProfiler<ProcessType>(labels, capacity), tracer(tracer), latencyHistograms(new LatencyHistogram[PROCESS_COUNT + 1]), counterTotals(new HardwareCounterTotals[PROCESS_COUNT + 1]), cpuTimeHistory(capacity) {}
+
+	// wall time from the first mark of the thread running the tick to end()
+	inline const LatencyHistogram& getTickLatency() const {
+		return latencyHistograms[PROCESS_COUNT];
+	}
+	// wall time of the process per tick, added up over all threads
+	inline const LatencyHistogram& getProcessLatency(ProcessType process) const {
+		return latencyHistograms[static_cast<size_t>(process)];
+	}
+	// hardware counts of all processes in the ticks that were counted
+	inline const HardwareCounterTotals& getTickCounters() const {
+		return counterTotals[PROCESS_COUNT];
+	}
+	inline const HardwareCounterTotals& getProcessCounters(ProcessType process) const {
+		return counterTotals[static_cast<size_t>(process)];
+	}
+	// "Tick" followed by every process by label
+	inline std::vector<NamedLatencyHistogram> getLatencyHistograms() const {
+		std::vector<NamedLatencyHistogram> result;
+		result.push_back(NamedLatencyHistogram{"Tick", &getTickLatency(), &getTickCounters()});
+		for(size_t i = 0; i < PROCESS_COUNT; i++) {
+			result.push_back(NamedLatencyHistogram{this->labels[i], &latencyHistograms[i], &counterTotals[i]});
+		}
+		return result;
+	}
+	// see saveLatencyReport, may be called from any thread
+	inline bool saveLatency(const std::string& path) const {
+		return saveLatencyReport(path, getLatencyHistograms());
+	}
+	// called by the thread running the tick, or while no ticks are running
+	inline void resetLatency() {
+		for(size_t i = 0; i < PROCESS_COUNT + 1; i++) {
+			latencyHistograms[i].reset();
+			counterTotals[i].reset();
+		}
+	}
+
+	inline ProcessType getCurrentProcess() {
+#if P3D_PROFILING
+		return getThreadProfile().currentProcess;
+#else
+		return NO_PROCESS;
+#endif
+	}
+
+	inline void mark(ProcessType process, ProcessType overrideOldProcess) {
+#if P3D_PROFILING
+		ThreadProfile& profile = getThreadProfile();
+		std::chrono::high_resolution_clock::time_point curTime = std::chrono::high_resolution_clock::now();
+		bool wasActive = profile.currentProcess != NO_PROCESS;
+		if(wasActive) {
+			std::chrono::nanoseconds timeTaken = curTime - profile.startTime;
+			profile.wallTally[static_cast<size_t>(overrideOldProcess)].fetch_add(timeTaken.count(), std::memory_order_relaxed);
+			if(tracer != nullptr) tracer->record(this->labels[static_cast<size_t>(overrideOldProcess)], profile.startTime, curTime);
+		}
+		bool isActive = process != NO_PROCESS;
+		if(isActive && !wasActive) {
+			profile.activeSinceTime = curTime;
+			profile.activeSinceCPUTime = getThreadCPUTime();
+		} else if(wasActive && !isActive) {
+			std::chrono::nanoseconds cpuTaken = getThreadCPUTime() - profile.activeSinceCPUTime;
+			profile.cpuTime.fetch_add(cpuTaken.count(), std::memory_order_relaxed);
+		}
+		if(hardwareCountersEnabled.load(std::memory_order_relaxed)) {
+			markCounters(profile, wasActive, overrideOldProcess);
+		} else {
+			profile.hasLastCounterValues = false;
+		}
+		profile.startTime = curTime;
+		profile.currentProcess = process;
+#if P3D_ALLOCATION_TRACKING
+		AllocationTracker::setCurrentProcess(static_cast<int>(process));
+#endif
+#endif
+	}
+
+	inline void mark(ProcessType process) {
+#if P3D_PROFILING
+		ProcessType currentProcess = getThreadProfile().currentProcess;
+		mark(process, currentProcess);
+#endif
+	}
+
+	// ends the tick on the calling thread, and merges the profiles of all threads into history
+	inline void end() {
+		std::chrono::nanoseconds totalCPUTime(0);
+#if P3D_PROFILING
+		ThreadProfile& tickProfile = getThreadProfile();
+		bool isTickMarked = tickProfile.currentProcess != NO_PROCESS;
+		std::chrono::high_resolution_clock::time_point tickStart = tickProfile.activeSinceTime;
+		mark(NO_PROCESS);
+
+		ParallelArray<std::chrono::nanoseconds, PROCESS_COUNT> tickTally;
+		for(size_t i = 0; i < PROCESS_COUNT; i++) {
+			tickTally[i] = std::chrono::nanoseconds(0);
+		}
+		lastTickThreadTimes.clear();
+		HardwareCounterValues tickCounters[PROCESS_COUNT + 1];
+		bool isAnyThreadCounting = false;
+		{
+			std::lock_guard<std::mutex> lock(profilesMutex);
+			for(std::unique_ptr<ThreadProfile>& profile : threadProfiles) {
+				if(profile->isCounting.load(std::memory_order_relaxed)) {
+					isAnyThreadCounting = true;
+					for(size_t i = 0; i < PROCESS_COUNT; i++) {
+						for(size_t c = 0; c < HARDWARE_COUNTER_COUNT; c++) {
+							std::uint64_t count = profile->counterTally[i][c].exchange(0, std::memory_order_relaxed);
+							tickCounters[i].values[c] += count;
+							tickCounters[PROCESS_COUNT].values[c] += count;
+						}
+					}
+				}
+				ThreadTimes times{std::chrono::nanoseconds(0), std::chrono::nanoseconds(profile->cpuTime.exchange(0, std::memory_order_relaxed))};
+				for(size_t i = 0; i < PROCESS_COUNT; i++) {
+					std::chrono::nanoseconds wallTime(profile->wallTally[i].exchange(0, std::memory_order_relaxed));
+					tickTally[i] += wallTime;
+					times.wallTime += wallTime;
+				}
+				if(times.wallTime.count() != 0 || times.cpuTime.count() != 0) {
+					lastTickThreadTimes.push_back(times);
+					totalCPUTime += times.cpuTime;
+				}
+			}
+		}
+
+		for(size_t i = 0; i < PROCESS_COUNT; i++) {
+			this->addToTally(static_cast<ProcessType>(i), tickTally[i]);
+			latencyHistograms[i].record(tickTally[i]);
+		}
+		if(isAnyThreadCounting && hardwareCountersEnabled.load(std::memory_order_relaxed)) {
+			for(size_t i = 0; i < PROCESS_COUNT + 1; i++) {
+				counterTotals[i].addTick(tickCounters[i]);
+			}
+		} else if(!isAnyThreadCounting && hardwareCountersEnabled.load(std::memory_order_relaxed) && !warnedCountersUnavailable) {
+			Debug::logWarn("Hardware performance counters are not available, only time is profiled");
+			warnedCountersUnavailable = true;
+		}
+#endif
+		std::chrono::high_resolution_clock::time_point tickEnd = std::chrono::high_resolution_clock::now();
+		this->tickHistory.add(tickEnd);
+		cpuTimeHistory.add(totalCPUTime);
+		this->nextTally();
+
+#if P3D_PROFILING
+		if(isTickMarked) latencyHistograms[PROCESS_COUNT].record(tickEnd - tickStart);
+		if(tracer != nullptr) tracer->finishTick(tickStart, tickEnd);
+#endif
+	}
+};
 };
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace P3D {
+// unique for every thread for the lifetime of the program, unlike std::thread::id which is reused once a thread ends
+inline std::uint64_t getThreadSerial() {
+	static std::atomic<std::uint64_t> nextSerial{1};
+	static thread_local std::uint64_t serial = nextSerial.fetch_add(1, std::memory_order_relaxed);
+	return serial;
+}
+
+/*
+	Remembers per thread the pointer the owner of this cache last stored on that thread
+	Meant for objects that keep some state per thread, to skip the locked lookup of that state after a thread's first call
+
+	Each thread holds one entry per type T, shared by all caches of T, so using two owners in turn falls back to the lookup
+	Entries are keyed by an ID unique to every cache rather than the address of its owner,
+	so a new owner at the address of a destroyed one never gets the destroyed one's pointer
+*/
+template<typename T>
+class ThreadLocalCache {
+	struct Entry {
+		std::uint64_t ownerID;
+		T* value;
+	};
+
+	static std::uint64_t getNextOwnerID() {
+		static std::atomic<std::uint64_t> nextOwnerID{1};
+		return nextOwnerID.fetch_add(1, std::memory_order_relaxed);
+	}
+	static Entry& getEntry() {
+		static thread_local Entry entry{0, nullptr};
+		return entry;
+	}
+
+	std::uint64_t ownerID = getNextOwnerID();
+public:
+	ThreadLocalCache() = default;
+	ThreadLocalCache(const ThreadLocalCache&) = delete;
+	ThreadLocalCache& operator=(const ThreadLocalCache&) = delete;
+
+	// the pointer last stored by this cache on the calling thread, or nullptr
+	T* get() const {
+		const Entry& entry = getEntry();
+		return (entry.ownerID == ownerID) ? entry.value : nullptr;
+	}
+	void set(T* value) {
+		getEntry() = Entry{ownerID, value};
+	}
+};
+};
@@ -0,0 +1,108 @@
+#include "tracing.h"
+
+#include <fstream>
+
+#include "debug.h"
+
+namespace P3D {
+EventTracer::EventTracer(std::size_t eventsPerThread) : eventsPerThread(eventsPerThread) {}
+
+EventTracer::ThreadEvents& EventTracer::getThreadEvents() {
+	ThreadEvents* cached = eventsCache.get();
+	if(cached != nullptr) return *cached;
+
+	std::thread::id thisThread = std::this_thread::get_id();
+	std::lock_guard<std::mutex> lock(threadsMutex);
+	ThreadEvents* found = nullptr;
+	for(std::unique_ptr<ThreadEvents>& threadEvents : threads) {
+		if(threadEvents->threadID == thisThread) {
+			found = threadEvents.get();
+			break;
+		}
+	}
+	if(found == nullptr) {
+		threads.push_back(std::make_unique<ThreadEvents>(thisThread, static_cast<int>(threads.size()), eventsPerThread));
+		found = threads.back().get();
+	}
+	eventsCache.set(found);
+	return *found;
+}
+
+void EventTracer::record(const char* name, std::chrono::high_resolution_clock::time_point start, std::chrono::high_resolution_clock::time_point end) {
+	if(!enabled.load(std::memory_order_relaxed)) return;
+	ThreadEvents& threadEvents = getThreadEvents();
+	std::lock_guard<std::mutex> lock(threadEvents.eventsMutex);
+	threadEvents.events.add(TraceEvent{name, start, end - start});
+}
+
+void EventTracer::finishTick(std::chrono::high_resolution_clock::time_point tickStart, std::chrono::high_resolution_clock::time_point tickEnd) {
+	if(!enabled.load(std::memory_order_relaxed)) return;
+	tracedTicks++;
+
+	std::chrono::nanoseconds tickLength = tickEnd - tickStart;
+	if(captureTicksSlowerThan.count() != 0 && tickLength > captureTicksSlowerThan && tickLength > slowestCapturedTick) {
+		if(saveJSON(outputPath, tickStart, tickEnd)) {
+			slowestCapturedTick = tickLength;
+			captureCount++;
+		}
+	}
+	if(captureAfterTicks != 0 && tracedTicks >= captureAfterTicks) {
+		if(saveJSON(outputPath)) {
+			captureCount++;
+		}
+		enabled.store(false);
+	}
+}
+
+static void writeEscaped(std::ostream& out, const char* str) {
+	for(const char* cur = str; *cur != '\0'; cur++) {
+		if(*cur == '"' || *cur == '\\') out << '\\';
+		out << *cur;
+	}
+}
+
+void EventTracer::writeJSON(std::ostream& out, std::chrono::high_resolution_clock::time_point from, std::chrono::high_resolution_clock::time_point to) {
+	std::lock_guard<std::mutex> lock(threadsMutex);
+	out << std::fixed;
+	out.precision(3);
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	bool isFirst = true;
+	for(std::unique_ptr<ThreadEvents>& threadEvents : threads) {
+		if(!isFirst) out << ',';
+		isFirst = false;
+		out << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << threadEvents->index << ",\"args\":{\"name\":\"Thread " << threadEvents->index << "\"}}";
+
+		std::lock_guard<std::mutex> eventsLock(threadEvents->eventsMutex);
+		for(const TraceEvent& event : threadEvents->events) {
+			if(event.start + event.duration < from || event.start > to) continue;
+			// timestamps in microseconds since the tracer was created
+			double timestamp = std::chrono::duration<double, std::micro>(event.start - traceStart).count();
+			double duration = std::chrono::duration<double, std::micro>(event.duration).count();
+			out << ",\n{\"name\":\"";
+			writeEscaped(out, event.name);
+			out << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << threadEvents->index << ",\"ts\":" << timestamp << ",\"dur\":" << duration << '}';
+		}
+	}
+	out << "\n]}\n";
+}
+
+bool EventTracer::saveJSON(const std::string& path, std::chrono::high_resolution_clock::time_point from, std::chrono::high_resolution_clock::time_point to) {
+	std::ofstream file(path);
+	if(!file.is_open()) {
+		Debug::logWarn("Could not open %s to write a trace", path.c_str());
+		return false;
+	}
+	writeJSON(file, from, to);
+	return true;
+}
+
+void EventTracer::clear() {
+	std::lock_guard<std::mutex> lock(threadsMutex);
+	for(std::unique_ptr<ThreadEvents>& threadEvents : threads) {
+		std::lock_guard<std::mutex> eventsLock(threadEvents->eventsMutex);
+		threadEvents->events = CircularBuffer<TraceEvent>(eventsPerThread);
+	}
+	tracedTicks = 0;
+	slowestCapturedTick = std::chrono::nanoseconds(0);
+}
+};
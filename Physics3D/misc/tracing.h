@@ -0,0 +1,98 @@
+#pragma once
+
+#include <chrono>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <string>
+#include <ostream>
+
+#include "../datastructures/buffers.h"
+#include "buildOptions.h"
+#include "threadLocalCache.h"
+
+namespace P3D {
+struct TraceEvent {
+	const char* name;
+	std::chrono::high_resolution_clock::time_point start;
+	std::chrono::nanoseconds duration;
+};
+
+/*
+	Records scoped events of every thread into a ring buffer per thread, and writes them as trace event JSON for chrome://tracing or Perfetto
+	Opt-in with enabled, a disabled tracer costs one atomic load per event
+
+	Events are stored complete, with their begin and duration, so an event overwritten by the ring buffer never leaves an unmatched begin or end behind
+	Event names must outlive the tracer, they are stored as pointers
+
+	finishTick() is called by the thread running the tick, and writes a capture to outputPath when one of the capture rules is met:
+	- captureAfterTicks: all buffered events once that many ticks were traced, tracing is disabled afterwards
+	- captureTicksSlowerThan: the events of the slowest tick above this length so far, overwritten when a slower tick is seen
+*/
+class EventTracer {
+	struct ThreadEvents {
+		std::thread::id threadID;
+		int index;
+		// only contended while a capture is written
+		std::mutex eventsMutex;
+		CircularBuffer<TraceEvent> events;
+
+		ThreadEvents(std::thread::id threadID, int index, std::size_t capacity) : threadID(threadID), index(index), events(capacity) {}
+	};
+
+	std::mutex threadsMutex;
+	std::vector<std::unique_ptr<ThreadEvents>> threads;
+	ThreadLocalCache<ThreadEvents> eventsCache;
+	std::size_t eventsPerThread;
+	std::chrono::high_resolution_clock::time_point traceStart = std::chrono::high_resolution_clock::now();
+	std::size_t tracedTicks = 0;
+	std::chrono::nanoseconds slowestCapturedTick{0};
+
+	ThreadEvents& getThreadEvents();
+public:
+	std::atomic<bool> enabled{false};
+
+	// 0 to never capture by tick count
+	std::size_t captureAfterTicks = 0;
+	// 0 to never capture slow ticks
+	std::chrono::nanoseconds captureTicksSlowerThan{0};
+	std::string outputPath = "physicsTrace.json";
+	std::size_t captureCount = 0;
+
+	EventTracer(std::size_t eventsPerThread);
+	EventTracer(const EventTracer&) = delete;
+	EventTracer& operator=(const EventTracer&) = delete;
+
+	void record(const char* name, std::chrono::high_resolution_clock::time_point start, std::chrono::high_resolution_clock::time_point end);
+	void finishTick(std::chrono::high_resolution_clock::time_point tickStart, std::chrono::high_resolution_clock::time_point tickEnd);
+
+	// writes the buffered events that overlap [from, to]
+	void writeJSON(std::ostream& out, std::chrono::high_resolution_clock::time_point from = std::chrono::high_resolution_clock::time_point::min(), std::chrono::high_resolution_clock::time_point to = std::chrono::high_resolution_clock::time_point::max());
+	bool saveJSON(const std::string& path, std::chrono::high_resolution_clock::time_point from = std::chrono::high_resolution_clock::time_point::min(), std::chrono::high_resolution_clock::time_point to = std::chrono::high_resolution_clock::time_point::max());
+	// drops all buffered events and restarts the capture rules
+	void clear();
+};
+
+// records the lifetime of this object as an event, if the tracer was enabled when it was created
+class TraceScope {
+	EventTracer& tracer;
+	const char* name;
+	std::chrono::high_resolution_clock::time_point start;
+	bool isTraced;
+public:
+#if P3D_PROFILING
+	inline TraceScope(EventTracer& tracer, const char* name) : tracer(tracer), name(name), isTraced(tracer.enabled.load(std::memory_order_relaxed)) {
+		if(isTraced) start = std::chrono::high_resolution_clock::now();
+	}
+	inline ~TraceScope() {
+		if(isTraced) tracer.record(name, start, std::chrono::high_resolution_clock::now());
+	}
+#else
+	inline TraceScope(EventTracer& tracer, const char* name) : tracer(tracer), name(name), isTraced(false) {}
+#endif
+	TraceScope(const TraceScope&) = delete;
+	TraceScope& operator=(const TraceScope&) = delete;
+};
+};
@@ -49,13 +49,15 @@ Part::Part(Part&& other) noexcept :
 	parent(other.parent), 
 	hitbox(std::move(other.hitbox)), 
 	maxRadius(other.maxRadius), 
-	properties(std::move(other.properties)) {
+	properties(std::move(other.properties)),
+	snapshotID(other.snapshotID) {
 
 	if (parent != nullptr) parent->notifyPartStdMoved(&other, this);
 	if (layer != nullptr) layer->notifyPartStdMoved(&other, this);
 
 	other.parent = nullptr;
 	other.layer = nullptr;
+	other.snapshotID = NO_SNAPSHOT_ID;
 }
 Part& Part::operator=(Part&& other) noexcept {
 	this->cframe = other.cframe;
@@ -64,12 +66,14 @@ Part& Part::operator=(Part&& other) noexcept {
 	this->hitbox = std::move(other.hitbox);
 	this->maxRadius = other.maxRadius;
 	this->properties = std::move(other.properties);
+	this->snapshotID = other.snapshotID;
 
 	if (parent != nullptr) parent->notifyPartStdMoved(&other, this);
 	if (layer != nullptr) layer->notifyPartStdMoved(&other, this);
 
 	other.parent = nullptr;
 	other.layer = nullptr;
+	other.snapshotID = NO_SNAPSHOT_ID;
 
 	return *this;
 }
@@ -13,6 +13,8 @@ class WorldLayer;
 class WorldPrototype;
 };
 
+#include <cstdint>
+
 #include "geometry/shape.h"
 #include "math/linalg/mat.h"
 #include "math/position.h"
@@ -59,10 +61,14 @@ class Part {
 	Physical* parent = nullptr;
 
 public:
+	static constexpr std::uint32_t NO_SNAPSHOT_ID = 0xFFFFFFFF;
+
 	WorldLayer* layer = nullptr;
 	Shape hitbox;
 	double maxRadius;
 	PartProperties properties;
+	// index of this part in WorldSnapshots, stays the same for as long as the part is in the world
+	std::uint32_t snapshotID = NO_SNAPSHOT_ID;
 
 	Part() = default;
 	Part(const Shape& shape, const GlobalCFrame& position, const PartProperties& properties);
@@ -48,6 +48,7 @@ Physical& Physical::operator=(Physical&& other) noexcept {
 	this->rigidBody = std::move(other.rigidBody);
 	this->mainPhysical = other.mainPhysical;
 	this->childPhysicals = std::move(other.childPhysicals);
+	this->subtreeMassPropertiesDirty = true;
 	this->rigidBody.mainPart->setRigidBodyPhysical(this);
 	for(ConnectedPhysical& p : this->childPhysicals) {
 		p.parent = this;
@@ -99,6 +100,8 @@ void Physical::makeMainPart(AttachedPart& newMainPart) {
 		ConnectedPhysical* self = (ConnectedPhysical*) this;
 		self->connectionToParent.attachOnChild = newCenterCFrame.globalToLocal(self->connectionToParent.attachOnChild);
 	}
+	// the connections of this physical now attach relative to the new main part, so the cached relative CFrames are stale
+	this->mainPhysical->flattenedTree.isValid = false;
 }
 
 template<typename T>
@@ -264,6 +267,7 @@ void Physical::attachPhysical(MotorizedPhysical* phys, HardConstraint* constrain
 	childPhysicals.back().refreshCFrameRecursive();
 
 	mainPhysical->refreshPhysicalProperties();
+	mainPhysical->wakeUp();
 }
 
 void Physical::attachPart(Part* part, HardConstraint* constraint, const CFrame& attachToThis, const CFrame& attachToThat) {
@@ -327,6 +331,7 @@ void Physical::attachPhysical(MotorizedPhysical* phys, const CFrame& attachment)
 	delete phys;
 
 	mainPhysical->refreshPhysicalProperties();
+	mainPhysical->wakeUp();
 }
 
 void Physical::attachPart(Part* part, const CFrame& attachment) {
@@ -515,20 +520,6 @@ void Physical::notifyPartStdMoved(Part* oldPartPtr, Part* newPartPtr) noexcept {
 	rigidBody.notifyPartStdMoved(oldPartPtr, newPartPtr);
 }
 
-void Physical::updateConstraints(double deltaT) {
-	for(ConnectedPhysical& p : childPhysicals) {
-		p.connectionToParent.update(deltaT);
-		p.updateConstraints(deltaT);
-	}
-}
-
-void Physical::updateAttachedPhysicals() {
-	for(ConnectedPhysical& p : childPhysicals) {
-		p.refreshCFrame();
-		p.updateAttachedPhysicals();
-	}
-}
-
 void Physical::setCFrame(const GlobalCFrame& newCFrame) {
 	if(this->isMainPhysical()) {
 		MotorizedPhysical* motorThis = static_cast<MotorizedPhysical*>(this);
@@ -548,12 +539,23 @@ void ConnectedPhysical::setCFrame(const GlobalCFrame& newCFrame) {
 }
 
 void MotorizedPhysical::setCFrame(const GlobalCFrame& newCFrame) {
+	wakeUp();
 	rigidBody.setCFrame(newCFrame);
 	for(ConnectedPhysical& conPhys : childPhysicals) {
 		conPhys.refreshCFrameRecursive();
 	}
 }
 
+void MotorizedPhysical::setVelocity(Vec3 velocity) {
+	wakeUp();
+	motionOfCenterOfMass.translation.translation[0] = velocity;
+}
+
+void MotorizedPhysical::setAngularVelocity(Vec3 angularVelocity) {
+	wakeUp();
+	motionOfCenterOfMass.rotation.rotation[0] = angularVelocity;
+}
+
 void Physical::setPartCFrame(Part* part, const GlobalCFrame& newCFrame) {
 	if(part == rigidBody.mainPart) {
 		setCFrame(newCFrame);
@@ -586,16 +588,95 @@ void MotorizedPhysical::translate(const Vec3& translation) {
 	translateUnsafeRecursive(translation);
 }
 
-void MotorizedPhysical::refreshPhysicalProperties() {
-	ALLOCA_COMMotionTree(cache, this, size);
+static void flattenRecursive(FlattenedPhysicalTree& tree, Physical* phys, std::size_t parentIndex) {
+	std::size_t index = tree.physicals.size();
+	tree.physicals.push_back(phys);
+	tree.parentIndices.push_back(parentIndex);
+	tree.subtreeEnds.push_back(0);
+	tree.relativeCFrames.push_back(index == 0 ? CFrame() : static_cast<ConnectedPhysical*>(phys)->getRelativeCFrameToParent());
+	phys->subtreeMassPropertiesDirty = true;
+
+	for(ConnectedPhysical& conPhys : phys->childPhysicals) {
+		conPhys.connectionToParent.relativeCFrameChanged = false;
+		flattenRecursive(tree, &conPhys, index);
+	}
+	tree.subtreeEnds[index] = tree.physicals.size();
+}
+
+void FlattenedPhysicalTree::rebuild(MotorizedPhysical* mainPhysical) {
+	physicals.clear();
+	parentIndices.clear();
+	subtreeEnds.clear();
+	relativeCFrames.clear();
+
+	flattenRecursive(*this, mainPhysical, 0);
+	isValid = true;
+}
+
+FlattenedPhysicalTree& MotorizedPhysical::getFlattenedTree() {
+	if(!flattenedTree.isValid) {
+		flattenedTree.rebuild(this);
+	}
+	return flattenedTree;
+}
+
+// recombines the cached mass properties of tree.physicals[index] from its rigid body and the cached properties of its direct children
+static void combineSubtreeMassProperties(const FlattenedPhysicalTree& tree, std::size_t index) {
+	Physical& phys = *tree.physicals[index];
+	const RigidBody& body = phys.rigidBody;
+
+	double totalMass = body.mass;
+	Vec3 totalCenterOfMass = body.localCenterOfMass * body.mass;
+	for(std::size_t child = index + 1; child < tree.subtreeEnds[index]; child = tree.subtreeEnds[child]) {
+		const Physical& childPhys = *tree.physicals[child];
+		totalMass += childPhys.subtreeMass;
+		totalCenterOfMass += tree.relativeCFrames[child].localToGlobal(childPhys.subtreeCenterOfMass) * childPhys.subtreeMass;
+	}
+	totalCenterOfMass /= totalMass;
+
+	SymmetricMat3 totalInertia = getTranslatedInertiaAroundCenterOfMass(body.inertia, body.mass, body.localCenterOfMass - totalCenterOfMass);
+	for(std::size_t child = index + 1; child < tree.subtreeEnds[index]; child = tree.subtreeEnds[child]) {
+		const Physical& childPhys = *tree.physicals[child];
+		const CFrame& relativeCFrame = tree.relativeCFrames[child];
+		CFrame childRelativeToCOM = CFrame(relativeCFrame.getPosition() - totalCenterOfMass, relativeCFrame.getRotation());
+		totalInertia += getTransformedInertiaAroundCenterOfMass(childPhys.subtreeInertia, childPhys.subtreeMass, childPhys.subtreeCenterOfMass, childRelativeToCOM);
+	}
 
-	this->totalCenterOfMass = cache.centerOfMass;
-	this->totalMass = cache.totalMass;
+	phys.subtreeMass = totalMass;
+	phys.subtreeCenterOfMass = totalCenterOfMass;
+	phys.subtreeInertia = totalInertia;
+	phys.subtreeMassPropertiesDirty = false;
+	phys.rigidBody.massPropertiesChanged = false;
+}
+
+void MotorizedPhysical::refreshPhysicalProperties() {
+	this->flattenedTree.isValid = false;
+	this->refreshChangedPhysicalProperties();
+}
+
+void MotorizedPhysical::refreshChangedPhysicalProperties() {
+	FlattenedPhysicalTree& tree = getFlattenedTree();
+
+	// children always come after their parent, so walking backwards combines every subtree before its parent
+	bool mainChanged = false;
+	for(std::size_t i = tree.size(); i-- > 0;) {
+		Physical* phys = tree.physicals[i];
+		if(phys->subtreeMassPropertiesDirty || phys->rigidBody.massPropertiesChanged) {
+			combineSubtreeMassProperties(tree, i);
+			if(i != 0) {
+				tree.physicals[tree.parentIndices[i]]->subtreeMassPropertiesDirty = true;
+			} else {
+				mainChanged = true;
+			}
+		}
+	}
+	if(!mainChanged) return;
 
-	SymmetricMat3 totalInertia = cache.getInertia();
+	this->totalCenterOfMass = this->subtreeCenterOfMass;
+	this->totalMass = this->subtreeMass;
 
-	this->forceResponse = SymmetricMat3::IDENTITY() * (1 / cache.totalMass);
-	this->momentResponse = ~totalInertia;
+	this->forceResponse = SymmetricMat3::IDENTITY() * (1 / this->subtreeMass);
+	this->momentResponse = ~this->subtreeInertia;
 }
 
 void ConnectedPhysical::refreshCFrame() {
@@ -611,8 +692,32 @@ void ConnectedPhysical::refreshCFrameRecursive() {
 }
 
 void MotorizedPhysical::fullRefreshOfConnectedPhysicals() {
-	for(ConnectedPhysical& conPhys : childPhysicals) {
-		conPhys.refreshCFrameRecursive();
+	FlattenedPhysicalTree& tree = getFlattenedTree();
+	for(std::size_t i = 1; i < tree.size(); i++) {
+		ConnectedPhysical* conPhys = static_cast<ConnectedPhysical*>(tree.physicals[i]);
+		tree.relativeCFrames[i] = conPhys->getRelativeCFrameToParent();
+		tree.physicals[tree.parentIndices[i]]->subtreeMassPropertiesDirty = true;
+		conPhys->rigidBody.setCFrame(tree.physicals[tree.parentIndices[i]]->getCFrame().localToGlobal(tree.relativeCFrames[i]));
+	}
+}
+
+void MotorizedPhysical::updateConstraints(double deltaT) {
+	FlattenedPhysicalTree& tree = getFlattenedTree();
+	for(std::size_t i = 1; i < tree.size(); i++) {
+		HardPhysicalConnection& connection = static_cast<ConnectedPhysical*>(tree.physicals[i])->connectionToParent;
+		connection.update(deltaT);
+		if(connection.relativeCFrameChanged) {
+			tree.relativeCFrames[i] = connection.getRelativeCFrameToParent();
+			tree.physicals[tree.parentIndices[i]]->subtreeMassPropertiesDirty = true;
+			connection.relativeCFrameChanged = false;
+		}
+	}
+}
+
+void MotorizedPhysical::updateAttachedPhysicals() {
+	const FlattenedPhysicalTree& tree = this->flattenedTree;
+	for(std::size_t i = 1; i < tree.size(); i++) {
+		tree.physicals[i]->rigidBody.setCFrame(tree.physicals[tree.parentIndices[i]]->getCFrame().localToGlobal(tree.relativeCFrames[i]));
 	}
 }
 
@@ -642,13 +747,13 @@ void MotorizedPhysical::update(double deltaT) {
 	Vec3 angularMomentumBefore = getTotalAngularMomentum();
 
 	updateConstraints(deltaT);
-	refreshPhysicalProperties();
+	refreshChangedPhysicalProperties();
 
 	Vec3 deltaCOM = this->totalCenterOfMass - oldCenterOfMass;
 	Vec3 movementOfCenterOfMass = motionOfCenterOfMass.getVelocity() * deltaT + accel * deltaT * deltaT * 0.5 - getCFrame().localToRelative(deltaCOM);
 
 	rotateAroundCenterOfMass(Rotation::fromRotationVector(motionOfCenterOfMass.getAngularVelocity() * deltaT));
-	translateUnsafeRecursive(movementOfCenterOfMass);
+	rigidBody.translate(movementOfCenterOfMass); // attached physicals follow in updateAttachedPhysicals()
 
 	Vec3 angularMomentumAfter = getTotalAngularMomentum();
 
@@ -669,6 +774,7 @@ void MotorizedPhysical::update(double deltaT) {
 #pragma region apply
 
 void MotorizedPhysical::applyForceAtCenterOfMass(Vec3 force) {
+	if(isAsleep) wakeUp();
 	assert(isVecValid(force));
 	totalForce += force;
 
@@ -676,6 +782,7 @@ void MotorizedPhysical::applyForceAtCenterOfMass(Vec3 force) {
 }
 
 void MotorizedPhysical::applyForce(Vec3Relative origin, Vec3 force) {
+	if(isAsleep) wakeUp();
 	assert(isVecValid(origin));
 	assert(isVecValid(force));
 	totalForce += force;
@@ -686,17 +793,20 @@ void MotorizedPhysical::applyForce(Vec3Relative origin, Vec3 force) {
 }
 
 void MotorizedPhysical::applyMoment(Vec3 moment) {
+	if(isAsleep) wakeUp();
 	assert(isVecValid(moment));
 	totalMoment += moment;
 	Debug::logVector(getCenterOfMass(), moment, Debug::MOMENT);
 }
 
 void MotorizedPhysical::applyImpulseAtCenterOfMass(Vec3 impulse) {
+	if(isAsleep) wakeUp();
 	assert(isVecValid(impulse));
 	Debug::logVector(getCenterOfMass(), impulse, Debug::IMPULSE);
 	motionOfCenterOfMass.translation.translation[0] += forceResponse * impulse;
 }
 void MotorizedPhysical::applyImpulse(Vec3Relative origin, Vec3Relative impulse) {
+	if(isAsleep) wakeUp();
 	assert(isVecValid(origin));
 	assert(isVecValid(impulse));
 	Debug::logVector(getCenterOfMass() + origin, impulse, Debug::IMPULSE);
@@ -705,6 +815,7 @@ void MotorizedPhysical::applyImpulse(Vec3Relative origin, Vec3Relative impulse)
 	applyAngularImpulse(angularImpulse);
 }
 void MotorizedPhysical::applyAngularImpulse(Vec3 angularImpulse) {
+	if(isAsleep) wakeUp();
 	assert(isVecValid(angularImpulse));
 	Debug::logVector(getCenterOfMass(), angularImpulse, Debug::ANGULAR_IMPULSE);
 	Vec3 localAngularImpulse = getCFrame().relativeToLocal(angularImpulse);
@@ -714,11 +825,13 @@ void MotorizedPhysical::applyAngularImpulse(Vec3 angularImpulse) {
 }
 
 void MotorizedPhysical::applyDragAtCenterOfMass(Vec3 drag) {
+	if(isAsleep) wakeUp();
 	assert(isVecValid(drag));
 	Debug::logVector(getCenterOfMass(), drag, Debug::POSITION);
 	translate(forceResponse * drag);
 }
 void MotorizedPhysical::applyDrag(Vec3Relative origin, Vec3Relative drag) {
+	if(isAsleep) wakeUp();
 	assert(isVecValid(origin));
 	assert(isVecValid(drag));
 	Debug::logVector(getCenterOfMass() + origin, drag, Debug::POSITION);
@@ -727,6 +840,7 @@ void MotorizedPhysical::applyDrag(Vec3Relative origin, Vec3Relative drag) {
 	applyAngularDrag(angularDrag);
 }
 void MotorizedPhysical::applyAngularDrag(Vec3 angularDrag) {
+	if(isAsleep) wakeUp();
 	assert(isVecValid(angularDrag));
 	Debug::logVector(getCenterOfMass(), angularDrag, Debug::INFO_VEC);
 	Vec3 localAngularDrag = getCFrame().relativeToLocal(angularDrag);
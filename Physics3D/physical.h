@@ -17,6 +17,7 @@
 #include "hardconstraints/hardPhysicalConnection.h"
 
 #include <stdint.h>
+#include <vector>
 
 namespace P3D {
 typedef Vec3 Vec3Local;
@@ -33,8 +34,6 @@ class COMMotionTree;
 class Physical {
 	void makeMainPart(AttachedPart& newMainPart);
 protected:
-	void updateAttachedPhysicals();
-	void updateConstraints(double deltaT);
 	void translateUnsafeRecursive(const Vec3Fix& translation);
 
 	void setMainPhysicalRecursive(MotorizedPhysical* newMainPhysical);
@@ -93,6 +92,12 @@ public:
 	MotorizedPhysical* mainPhysical;
 	UnorderedVector<ConnectedPhysical> childPhysicals;
 
+	// cached mass properties of this physical and all its children, relative to this physical's CFrame
+	double subtreeMass;
+	Vec3 subtreeCenterOfMass;
+	SymmetricMat3 subtreeInertia; // around subtreeCenterOfMass
+	bool subtreeMassPropertiesDirty = true;
+
 	Physical() = default;
 	Physical(Part* mainPart, MotorizedPhysical* mainPhysical);
 	Physical(RigidBody&& rigidBody, MotorizedPhysical* mainPhysical);
@@ -221,11 +226,38 @@ public:
 	bool isValid() const;
 };
 
+/*
+	Depth first linearization of the ConnectedPhysical hierarchy of a MotorizedPhysical
+	Index 0 is the MotorizedPhysical itself, every physical comes after its parent,
+	and the subtree of physicals[i] spans the indices [i, subtreeEnds[i])
+	The children of i can be iterated with for(j = i + 1; j < subtreeEnds[i]; j = subtreeEnds[j])
+*/
+struct FlattenedPhysicalTree {
+	std::vector<Physical*> physicals;
+	std::vector<std::size_t> parentIndices;
+	std::vector<std::size_t> subtreeEnds;
+	// CFrame of physicals[i] relative to its parent, kept up to date by the constraint update
+	std::vector<CFrame> relativeCFrames;
+	bool isValid = false;
+
+	void rebuild(MotorizedPhysical* mainPhysical);
+	inline std::size_t size() const { return physicals.size(); }
+};
+
 class MotorizedPhysical : public Physical {
 	friend class Physical;
 	friend class ConnectedPhysical;
+
+	// rebuilt lazily after every structural change, see refreshPhysicalProperties()
+	FlattenedPhysicalTree flattenedTree;
+
+	void updateConstraints(double deltaT);
+	void updateAttachedPhysicals();
 public:
+	// recomputes all physical properties from scratch, must be called after changes to the structure of this physical
 	void refreshPhysicalProperties();
+	// only recombines the branches of which a part attachment or hard constraint changed since the last refresh
+	void refreshChangedPhysicalProperties();
 	Vec3 totalForce = Vec3(0.0, 0.0, 0.0);
 	Vec3 totalMoment = Vec3(0.0, 0.0, 0.0);
 
@@ -237,6 +269,15 @@ public:
 
 	Motion motionOfCenterOfMass;
 
+	// sleeping physicals are skipped by the simulation until something wakes them, see simulationIslands.h
+	bool isAsleep = false;
+	// number of consecutive ticks this physical stayed below the world's sleepEnergyThreshold
+	int ticksAtRest = 0;
+	// nonzero once this physical has been put to sleep with an island, waking one member wakes the rest of that island on the next tick
+	std::size_t sleepingIslandID = 0;
+	// scratch index used by SimulationIslands::build
+	std::size_t islandIndex = 0;
+
 	explicit MotorizedPhysical(Part* mainPart);
 	explicit MotorizedPhysical(RigidBody&& rigidBody);
 	explicit MotorizedPhysical(Physical&& movedPhys);
@@ -292,6 +333,14 @@ public:
 	void update(double deltaT);
 
 	void setCFrame(const GlobalCFrame& newCFrame);
+	void setVelocity(Vec3 velocity);
+	void setAngularVelocity(Vec3 angularVelocity);
+
+	// also restarts the count towards sleeping, forces only wake physicals that are asleep
+	inline void wakeUp() {
+		isAsleep = false;
+		ticksAtRest = 0;
+	}
 
 	void translate(const Vec3& translation);
 	void rotateAroundCenterOfMass(const Rotation& rotation);
@@ -316,6 +365,8 @@ public:
 
 	void fullRefreshOfConnectedPhysicals();
 
+	FlattenedPhysicalTree& getFlattenedTree();
+
 	bool isSinglePart() const { return this->childPhysicals.size() == 0 && this->rigidBody.getPartCount() == 1; }
 
 	// expects a function of type void(const Part&)
@@ -127,6 +127,7 @@ void RigidBody::refreshWithNewParts() {
 	this->mass = totalMass;
 	this->localCenterOfMass = totalCenterOfMass;
 	this->inertia = totalInertia;
+	this->massPropertiesChanged = true;
 }
 
 void RigidBody::setCFrame(const GlobalCFrame& newCFrame) {
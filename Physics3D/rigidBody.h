@@ -77,6 +77,7 @@ namespace P3D {
 		double mass; // precomputed cached value for this whole physical
 		Vec3 localCenterOfMass; // precomputed cached value for this whole physical
 		SymmetricMat3 inertia; // precomputed cached value for this whole physical
+		bool massPropertiesChanged = true; // set whenever the cached values above are recomputed, cleared by the owning Physical
 
 		RigidBody() = default;
 		RigidBody(Part* mainPart);
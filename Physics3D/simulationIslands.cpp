@@ -0,0 +1,273 @@
+#include "simulationIslands.h"
+
+#include "world.h"
+#include "part.h"
+#include "physical.h"
+#include "colissionBuffer.h"
+#include "constraints/constraintGroup.h"
+#include "softlinks/softLink.h"
+
+#include <algorithm>
+
+namespace P3D {
+std::size_t SimulationIslands::indexOf(const MotorizedPhysical* phys) const {
+	std::size_t index = phys->islandIndex;
+	if(index < builtFrom->size() && (*builtFrom)[index] == phys) {
+		return index;
+	}
+	return builtFrom->size();
+}
+
+std::size_t SimulationIslands::findRoot(std::size_t index) {
+	while(parents[index] != index) {
+		parents[index] = parents[parents[index]];
+		index = parents[index];
+	}
+	return index;
+}
+
+void SimulationIslands::join(const MotorizedPhysical* a, const MotorizedPhysical* b) {
+	std::size_t indexA = indexOf(a);
+	std::size_t indexB = indexOf(b);
+	if(indexA == parents.size() || indexB == parents.size()) return;
+
+	std::size_t rootA = findRoot(indexA);
+	std::size_t rootB = findRoot(indexB);
+	if(rootA < rootB) {
+		parents[rootB] = rootA;
+	} else if(rootB < rootA) {
+		parents[rootA] = rootB;
+	}
+}
+
+static const MotorizedPhysical* getMainPhysical(const Part* part) {
+	const Physical* phys = part->getPhysical();
+	return (phys != nullptr) ? phys->mainPhysical : nullptr;
+}
+
+void SimulationIslands::build(const std::vector<MotorizedPhysical*>& physicals, const std::vector<Colission>& colissions, const std::vector<ConstraintGroup>& constraints, const std::vector<SoftLink*>& softLinks) {
+	std::size_t count = physicals.size();
+	this->builtFrom = &physicals;
+	parents.resize(count);
+	for(std::size_t i = 0; i < count; i++) {
+		parents[i] = i;
+		physicals[i]->islandIndex = i;
+	}
+
+	for(const Colission& col : colissions) {
+		join(col.p1->getPhysical()->mainPhysical, col.p2->getPhysical()->mainPhysical);
+	}
+	for(const ConstraintGroup& group : constraints) {
+		for(const PhysicalConstraint& constraint : group.constraints) {
+			join(constraint.physA->mainPhysical, constraint.physB->mainPhysical);
+		}
+	}
+	for(const SoftLink* link : softLinks) {
+		const MotorizedPhysical* physA = getMainPhysical(link->attachedPartA.part);
+		const MotorizedPhysical* physB = getMainPhysical(link->attachedPartB.part);
+		if(physA != nullptr && physB != nullptr) {
+			join(physA, physB);
+		}
+	}
+
+	// number the islands in order of their first physical, then sort the physicals into them
+	islandOfPhysical.assign(count, count);
+	islandStarts.clear();
+	for(std::size_t i = 0; i < count; i++) {
+		std::size_t root = findRoot(i);
+		if(islandOfPhysical[root] == count) {
+			islandOfPhysical[root] = islandStarts.size();
+			islandStarts.push_back(0);
+		}
+		std::size_t island = islandOfPhysical[root];
+		islandOfPhysical[i] = island;
+		islandStarts[island]++;
+	}
+	std::size_t total = 0;
+	for(std::size_t& start : islandStarts) {
+		std::size_t size = start;
+		start = total;
+		total += size;
+	}
+	islandStarts.push_back(total);
+
+	this->physicals.resize(count);
+	// parents is no longer needed, reuse it as the fill position of each island
+	parents.assign(islandStarts.begin(), islandStarts.end() - 1);
+	for(std::size_t i = 0; i < count; i++) {
+		this->physicals[parents[islandOfPhysical[i]]++] = physicals[i];
+	}
+}
+
+std::size_t SimulationIslands::getIslandOf(const MotorizedPhysical* phys) const {
+	if(builtFrom == nullptr) return getIslandCount();
+	std::size_t index = indexOf(phys);
+	if(index == builtFrom->size()) return getIslandCount();
+	return islandOfPhysical[index];
+}
+
+void ColissionPartition::build(const std::vector<MotorizedPhysical*>& physicals, const ColissionBuffer& colissions) {
+	static const std::vector<ConstraintGroup> noConstraints;
+	static const std::vector<SoftLink*> noSoftLinks;
+	islands.build(physicals, colissions.freePartColissions, noConstraints, noSoftLinks);
+
+	std::size_t freePartCount = colissions.freePartColissions.size();
+	std::size_t totalCount = freePartCount + colissions.freeTerrainColissions.size();
+	std::size_t noPartition = islands.getIslandCount();
+	partitionOfIsland.assign(islands.getIslandCount(), noPartition);
+	partitionStarts.clear();
+
+	// both sides of a free part colission share an island, so p1 alone decides the partition
+	auto getIslandOfColission = [&](std::size_t index) {
+		const Colission& col = (index < freePartCount) ? colissions.freePartColissions[index] : colissions.freeTerrainColissions[index - freePartCount];
+		return islands.getIslandOf(col.p1->getPhysical()->mainPhysical);
+	};
+
+	partitionOfColission.resize(totalCount);
+	for(std::size_t i = 0; i < totalCount; i++) {
+		std::size_t& partition = partitionOfIsland[getIslandOfColission(i)];
+		if(partition == noPartition) {
+			partition = partitionStarts.size();
+			partitionStarts.push_back(0);
+		}
+		partitionStarts[partition]++;
+		partitionOfColission[i] = partition;
+	}
+	std::size_t total = 0;
+	for(std::size_t& start : partitionStarts) {
+		std::size_t size = start;
+		start = total;
+		total += size;
+	}
+	partitionStarts.push_back(total);
+
+	// partitionOfIsland is no longer needed, reuse it as the fill position of each partition
+	partitionOfIsland.assign(partitionStarts.begin(), partitionStarts.end() - 1);
+	colissionIndices.resize(totalCount);
+	for(std::size_t i = 0; i < totalCount; i++) {
+		colissionIndices[partitionOfIsland[partitionOfColission[i]]++] = i;
+	}
+}
+
+bool isPartAsleep(const Part& part) {
+	const Physical* phys = part.getPhysical();
+	return phys != nullptr && phys->mainPhysical->isAsleep;
+}
+
+bool isConstraintGroupAsleep(const ConstraintGroup& group) {
+	for(const PhysicalConstraint& constraint : group.constraints) {
+		if(!constraint.physA->mainPhysical->isAsleep || !constraint.physB->mainPhysical->isAsleep) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// links to terrain only act on the free side
+bool isSoftLinkAsleep(const SoftLink& link) {
+	const MotorizedPhysical* physA = getMainPhysical(link.attachedPartA.part);
+	const MotorizedPhysical* physB = getMainPhysical(link.attachedPartB.part);
+	return (physA == nullptr || physA->isAsleep) && (physB == nullptr || physB->isAsleep);
+}
+
+void wakeMarkedIslands(WorldPrototype& world) {
+	std::vector<std::size_t> wokenIslands;
+	for(MotorizedPhysical* phys : world.physicals) {
+		if(!phys->isAsleep && phys->sleepingIslandID != 0) {
+			wokenIslands.push_back(phys->sleepingIslandID);
+			phys->sleepingIslandID = 0;
+		}
+	}
+	if(wokenIslands.empty()) return;
+
+	std::sort(wokenIslands.begin(), wokenIslands.end());
+	for(MotorizedPhysical* phys : world.physicals) {
+		if(phys->isAsleep && std::binary_search(wokenIslands.begin(), wokenIslands.end(), phys->sleepingIslandID)) {
+			phys->wakeUp();
+			phys->sleepingIslandID = 0;
+		}
+	}
+}
+
+// the terrain part of a free-terrain colission never counts as awake
+static void moveColissions(std::vector<Colission>& from, std::vector<Colission>& to, bool withTerrain, bool moveSleeping) {
+	std::size_t kept = 0;
+	for(std::size_t i = 0; i < from.size(); i++) {
+		const Colission& col = from[i];
+		bool isAsleep = isPartAsleep(*col.p1) && (withTerrain || isPartAsleep(*col.p2));
+		if(isAsleep == moveSleeping) {
+			to.push_back(col);
+		} else {
+			from[kept++] = col;
+		}
+	}
+	from.resize(kept);
+}
+
+void setAsideSleepingColissions(WorldPrototype& world, ColissionBuffer& curColissions) {
+	world.sleepingColissions.clear();
+	moveColissions(curColissions.freePartColissions, world.sleepingColissions.freePartColissions, false, true);
+	moveColissions(curColissions.freeTerrainColissions, world.sleepingColissions.freeTerrainColissions, true, true);
+}
+
+void takeWokenColissions(WorldPrototype& world, ColissionBuffer& wokenColissions) {
+	moveColissions(world.sleepingColissions.freePartColissions, wokenColissions.freePartColissions, false, false);
+	moveColissions(world.sleepingColissions.freeTerrainColissions, wokenColissions.freeTerrainColissions, true, false);
+}
+
+bool wakePartsTouchedByAwakeParts(const ColissionBuffer& curColissions) {
+	bool anyWoken = false;
+	for(const Colission& col : curColissions.freePartColissions) {
+		for(Part* part : {col.p1, col.p2}) {
+			MotorizedPhysical* phys = part->getPhysical()->mainPhysical;
+			if(phys->isAsleep) {
+				phys->wakeUp();
+				anyWoken = true;
+			}
+		}
+	}
+	return anyWoken;
+}
+
+static double getKineticEnergyPerMass(MotorizedPhysical& phys) {
+	double energy = 0.0;
+	for(const Physical* p : phys.getFlattenedTree().physicals) {
+		energy += p->getKineticEnergy();
+	}
+	return energy / phys.totalMass;
+}
+
+void updateSleepingIslands(WorldPrototype& world) {
+	bool anyCanSleep = false;
+	for(MotorizedPhysical* phys : world.awakePhysicals) {
+		if(getKineticEnergyPerMass(*phys) < world.sleepEnergyThreshold) {
+			phys->ticksAtRest++;
+			anyCanSleep = anyCanSleep || phys->ticksAtRest >= world.ticksBeforeSleep;
+		} else {
+			phys->ticksAtRest = 0;
+		}
+	}
+	if(!anyCanSleep) return;
+
+	SimulationIslands& islands = world.islands;
+	islands.build(world.awakePhysicals, world.curColissions.freePartColissions, world.constraints, world.softLinks);
+	for(std::size_t island = 0; island < islands.getIslandCount(); island++) {
+		MotorizedPhysical* const* begin = islands.physicals.data() + islands.islandStarts[island];
+		MotorizedPhysical* const* end = islands.physicals.data() + islands.islandStarts[island + 1];
+		bool isResting = std::all_of(begin, end, [&world](const MotorizedPhysical* phys) {
+			return phys->ticksAtRest >= world.ticksBeforeSleep;
+		});
+		if(!isResting) continue;
+
+		std::size_t islandID = ++world.lastSleepingIslandID;
+		for(MotorizedPhysical* const* cur = begin; cur != end; cur++) {
+			MotorizedPhysical* phys = *cur;
+			phys->isAsleep = true;
+			phys->sleepingIslandID = islandID;
+			phys->motionOfCenterOfMass = Motion();
+			phys->totalForce = Vec3(0.0, 0.0, 0.0);
+			phys->totalMoment = Vec3(0.0, 0.0, 0.0);
+		}
+	}
+}
+};
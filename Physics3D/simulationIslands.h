@@ -0,0 +1,77 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+namespace P3D {
+class Part;
+class MotorizedPhysical;
+class ConstraintGroup;
+class SoftLink;
+class WorldPrototype;
+struct Colission;
+struct ColissionBuffer;
+
+/*
+	Groups physicals that act on each other within a tick into islands
+	Two physicals share an island if parts of them collide, or if they are linked by a ConstraintGroup or a SoftLink
+
+	The physicals of island i are physicals[islandStarts[i]] up to physicals[islandStarts[i + 1]]
+*/
+class SimulationIslands {
+	std::vector<std::size_t> parents;
+	std::vector<std::size_t> islandOfPhysical;
+	const std::vector<MotorizedPhysical*>* builtFrom = nullptr;
+
+	std::size_t indexOf(const MotorizedPhysical* phys) const;
+	std::size_t findRoot(std::size_t index);
+	void join(const MotorizedPhysical* a, const MotorizedPhysical* b);
+public:
+	std::vector<MotorizedPhysical*> physicals;
+	std::vector<std::size_t> islandStarts{0};
+
+	/*
+		Rebuilds the islands of the given physicals, links to physicals that are not in the list are ignored
+		Islands are ordered by their first physical in the given list, and keep the order of that list internally
+	*/
+	void build(const std::vector<MotorizedPhysical*>& physicals, const std::vector<Colission>& colissions, const std::vector<ConstraintGroup>& constraints, const std::vector<SoftLink*>& softLinks);
+
+	inline std::size_t getIslandCount() const { return islandStarts.size() - 1; }
+	inline std::size_t getIslandSize(std::size_t island) const { return islandStarts[island + 1] - islandStarts[island]; }
+	// returns getIslandCount() for physicals that were not part of the last build
+	std::size_t getIslandOf(const MotorizedPhysical* phys) const;
+};
+
+/*
+	The colissions of a ColissionBuffer grouped by the island of the physicals they act on, islands without colissions are left out
+	Colission indices count the freePartColissions first, followed by the freeTerrainColissions
+	Within a partition the indices stay in increasing order, so every physical sees its colissions in the same order as the serial handling
+*/
+class ColissionPartition {
+	SimulationIslands islands;
+	std::vector<std::size_t> partitionOfIsland;
+	std::vector<std::size_t> partitionOfColission;
+public:
+	std::vector<std::size_t> colissionIndices;
+	std::vector<std::size_t> partitionStarts{0};
+
+	void build(const std::vector<MotorizedPhysical*>& physicals, const ColissionBuffer& colissions);
+
+	inline std::size_t getPartitionCount() const { return partitionStarts.size() - 1; }
+};
+
+bool isPartAsleep(const Part& part);
+bool isConstraintGroupAsleep(const ConstraintGroup& group);
+bool isSoftLinkAsleep(const SoftLink& link);
+
+// wakes all members of sleeping islands of which a member was woken since they fell asleep
+void wakeMarkedIslands(WorldPrototype& world);
+// moves the colissions of which no part is awake to world.sleepingColissions, these skip the narrow phase
+void setAsideSleepingColissions(WorldPrototype& world, ColissionBuffer& curColissions);
+// wakes sleeping parts that collide with awake ones, returns true if any were woken
+bool wakePartsTouchedByAwakeParts(const ColissionBuffer& curColissions);
+// moves the colissions in world.sleepingColissions that have an awake part again to wokenColissions
+void takeWokenColissions(WorldPrototype& world, ColissionBuffer& wokenColissions);
+// counts the resting ticks of world.awakePhysicals, and puts the islands of which every member rested long enough to sleep
+void updateSleepingIslands(WorldPrototype& world);
+};
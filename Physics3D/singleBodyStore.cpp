@@ -0,0 +1,159 @@
+#include "singleBodyStore.h"
+
+#include "singleBodyStoreKernel.h"
+#include "physical.h"
+#include "worldPhysics.h"
+#include "threading/threadPool.h"
+#include "datastructures/aligned_alloc.h"
+#include "misc/cpuid.h"
+
+#include <algorithm>
+
+namespace P3D {
+// bodies are gathered, integrated and written back per chunk, so a chunk stays in cache between the three steps
+#define SINGLE_BODY_CHUNK_SIZE 64
+#define SINGLE_BODY_LANE_WIDTH 4
+
+struct ScalarLane {
+	static constexpr std::size_t WIDTH = 1;
+	double v;
+
+	static ScalarLane load(const double* ptr) { return ScalarLane{*ptr}; }
+	static ScalarLane broadcast(double value) { return ScalarLane{value}; }
+	void store(double* ptr) const { *ptr = v; }
+
+	ScalarLane operator+(ScalarLane other) const { return ScalarLane{v + other.v}; }
+	ScalarLane operator-(ScalarLane other) const { return ScalarLane{v - other.v}; }
+	ScalarLane operator*(ScalarLane other) const { return ScalarLane{v * other.v}; }
+
+	static void rotationVecFactors(ScalarLane angleSq, ScalarLane& sinc, ScalarLane& cosc, ScalarLane& cosAngle) {
+		P3D::rotationVecFactors(angleSq.v, sinc.v, cosc.v, cosAngle.v);
+	}
+};
+
+void integrateSingleBodiesScalar(double* const* fields, std::size_t start, std::size_t end, double deltaT) {
+	integrateSingleBodies<ScalarLane>(fields, start, end, deltaT);
+}
+
+SingleBodyStore::~SingleBodyStore() {
+	aligned_free(data);
+}
+
+void SingleBodyStore::ensureCapacity(std::size_t bodyCount) {
+	std::size_t paddedCount = (bodyCount + SINGLE_BODY_LANE_WIDTH - 1) / SINGLE_BODY_LANE_WIDTH * SINGLE_BODY_LANE_WIDTH;
+	if(paddedCount <= capacity) return;
+
+	std::size_t newCapacity = std::max<std::size_t>(paddedCount, capacity * 2);
+	aligned_free(data);
+	data = static_cast<double*>(aligned_malloc(sizeof(double) * newCapacity * SINGLE_BODY_FIELD_COUNT, 32));
+	capacity = newCapacity;
+}
+
+bool SingleBodyStore::canStore(const MotorizedPhysical* phys) {
+	return phys->childPhysicals.size() == 0 && !phys->subtreeMassPropertiesDirty && !phys->rigidBody.massPropertiesChanged;
+}
+
+void SingleBodyStore::gather(double* const* fields, std::size_t start, std::size_t end) const {
+	for(std::size_t i = start; i < end; i++) {
+		const MotorizedPhysical* phys = bodies[i];
+
+		Mat3 rotation = phys->getCFrame().getRotation().asRotationMatrix();
+		for(int r = 0; r < 3; r++) {
+			for(int c = 0; c < 3; c++) {
+				fields[ROT_XX + 3 * r + c][i] = rotation(r, c);
+			}
+		}
+		Vec3 vecs[5]{
+			phys->motionOfCenterOfMass.getVelocity(),
+			phys->motionOfCenterOfMass.getAngularVelocity(),
+			phys->totalForce,
+			phys->totalMoment,
+			phys->rigidBody.localCenterOfMass
+		};
+		std::size_t vecFields[5]{VEL_X, ANG_VEL_X, FORCE_X, MOMENT_X, LOCAL_COM_X};
+		for(int v = 0; v < 5; v++) {
+			for(int axis = 0; axis < 3; axis++) {
+				fields[vecFields[v] + axis][i] = vecs[v][axis];
+			}
+		}
+		fields[INV_MASS][i] = phys->forceResponse(0, 0);
+		const SymmetricMat3& momentResponse = phys->momentResponse;
+		const SymmetricMat3& inertia = phys->rigidBody.inertia;
+		std::size_t j = 0;
+		for(int r = 0; r < 3; r++) {
+			for(int c = r; c < 3; c++) {
+				fields[INV_INERTIA_XX + j][i] = momentResponse(r, c);
+				fields[INERTIA_XX + j][i] = inertia(r, c);
+				j++;
+			}
+		}
+	}
+}
+
+void SingleBodyStore::scatter(double* const* fields, std::size_t start, std::size_t end) const {
+	for(std::size_t i = start; i < end; i++) {
+		MotorizedPhysical* phys = bodies[i];
+
+		Mat3 rotation;
+		for(int r = 0; r < 3; r++) {
+			for(int c = 0; c < 3; c++) {
+				rotation(r, c) = fields[ROT_XX + 3 * r + c][i];
+			}
+		}
+		Vec3 movement(fields[MOVE_X][i], fields[MOVE_Y][i], fields[MOVE_Z][i]);
+
+		phys->rigidBody.setCFrame(GlobalCFrame(phys->getCFrame().getPosition() + movement, Rotation::fromRotationMatrix(rotation)));
+
+		phys->motionOfCenterOfMass.translation.translation[0] = Vec3(fields[VEL_X][i], fields[VEL_Y][i], fields[VEL_Z][i]);
+		phys->motionOfCenterOfMass.rotation.rotation[0] = Vec3(fields[ANG_VEL_X][i], fields[ANG_VEL_Y][i], fields[ANG_VEL_Z][i]);
+		phys->totalForce = Vec3();
+		phys->totalMoment = Vec3();
+	}
+}
+
+// padding lanes get a valid resting body so the kernel does not produce NaNs or denormals on them
+static void fillPadding(double* const* fields, std::size_t start, std::size_t end) {
+	for(std::size_t i = start; i < end; i++) {
+		for(std::size_t field = 0; field < SINGLE_BODY_FIELD_COUNT; field++) {
+			fields[field][i] = 0.0;
+		}
+		fields[ROT_XX][i] = 1.0;
+		fields[ROT_YY][i] = 1.0;
+		fields[ROT_ZZ][i] = 1.0;
+	}
+}
+
+void SingleBodyStore::update(const std::vector<MotorizedPhysical*>& physicals, double deltaT, ThreadPool& threadPool) {
+	bodies.clear();
+	otherPhysicals.clear();
+	for(MotorizedPhysical* phys : physicals) {
+		if(canStore(phys)) {
+			bodies.push_back(phys);
+		} else {
+			otherPhysicals.push_back(phys);
+		}
+	}
+	updatePhysicalsParallel(otherPhysicals, deltaT, threadPool);
+
+	std::size_t bodyCount = bodies.size();
+	if(bodyCount == 0) return;
+	ensureCapacity(bodyCount);
+
+	double* fields[SINGLE_BODY_FIELD_COUNT];
+	for(std::size_t field = 0; field < SINGLE_BODY_FIELD_COUNT; field++) {
+		fields[field] = data + field * capacity;
+	}
+
+	void(*integrate)(double* const*, std::size_t, std::size_t, double) =
+		CPUIDCheck::hasTechnology(CPUIDCheck::AVX | CPUIDCheck::AVX2 | CPUIDCheck::FMA) ? integrateSingleBodiesAVX : integrateSingleBodiesScalar;
+
+	threadPool.doInParallelChunks(bodyCount, SINGLE_BODY_CHUNK_SIZE, [&](std::size_t start, std::size_t end) {
+		std::size_t paddedEnd = (end + SINGLE_BODY_LANE_WIDTH - 1) / SINGLE_BODY_LANE_WIDTH * SINGLE_BODY_LANE_WIDTH;
+
+		gather(fields, start, end);
+		fillPadding(fields, end, paddedEnd);
+		integrate(fields, start, paddedEnd, deltaT);
+		scatter(fields, start, end);
+	});
+}
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+namespace P3D {
+class MotorizedPhysical;
+class ThreadPool;
+
+/*
+	Struct of arrays copy of the dynamic state of MotorizedPhysicals that consist of a single RigidBody, such as debris and props
+	Enabled per world with WorldPrototype::useSingleBodyStore
+
+	Every tick the eligible physicals are gathered in chunks, integrated 4 at a time when AVX2 and FMA are available,
+	and written back to their parts. All other physicals go through the regular MotorizedPhysical::update
+*/
+class SingleBodyStore {
+	double* data = nullptr;
+	std::size_t capacity = 0;
+	std::vector<MotorizedPhysical*> bodies;
+	std::vector<MotorizedPhysical*> otherPhysicals;
+
+	void ensureCapacity(std::size_t bodyCount);
+	void gather(double* const* fields, std::size_t start, std::size_t end) const;
+	void scatter(double* const* fields, std::size_t start, std::size_t end) const;
+public:
+	SingleBodyStore() = default;
+	~SingleBodyStore();
+	SingleBodyStore(const SingleBodyStore&) = delete;
+	SingleBodyStore& operator=(const SingleBodyStore&) = delete;
+
+	// a physical can be integrated by this store if it has no children and its mass properties are up to date
+	static bool canStore(const MotorizedPhysical* phys);
+
+	// updates all given physicals, same as calling update(deltaT) on each of them
+	void update(const std::vector<MotorizedPhysical*>& physicals, double deltaT, ThreadPool& threadPool);
+
+	inline std::size_t getBodyCount() const { return bodies.size(); }
+};
+};
@@ -0,0 +1,37 @@
+#include "singleBodyStoreKernel.h"
+
+#include <immintrin.h>
+
+namespace P3D {
+struct AVXLane {
+	static constexpr std::size_t WIDTH = 4;
+	__m256d v;
+
+	static AVXLane load(const double* ptr) { return AVXLane{_mm256_load_pd(ptr)}; }
+	static AVXLane broadcast(double value) { return AVXLane{_mm256_set1_pd(value)}; }
+	void store(double* ptr) const { _mm256_store_pd(ptr, v); }
+
+	AVXLane operator+(AVXLane other) const { return AVXLane{_mm256_add_pd(v, other.v)}; }
+	AVXLane operator-(AVXLane other) const { return AVXLane{_mm256_sub_pd(v, other.v)}; }
+	AVXLane operator*(AVXLane other) const { return AVXLane{_mm256_mul_pd(v, other.v)}; }
+
+	// there is no vectorized sin/cos available, these are done per lane
+	static void rotationVecFactors(AVXLane angleSq, AVXLane& sinc, AVXLane& cosc, AVXLane& cosAngle) {
+		alignas(32) double angleSqs[4];
+		alignas(32) double sincs[4];
+		alignas(32) double coscs[4];
+		alignas(32) double coss[4];
+		angleSq.store(angleSqs);
+		for(int i = 0; i < 4; i++) {
+			P3D::rotationVecFactors(angleSqs[i], sincs[i], coscs[i], coss[i]);
+		}
+		sinc = load(sincs);
+		cosc = load(coscs);
+		cosAngle = load(coss);
+	}
+};
+
+void integrateSingleBodiesAVX(double* const* fields, std::size_t start, std::size_t end, double deltaT) {
+	integrateSingleBodies<AVXLane>(fields, start, end, deltaT);
+}
+};
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <cstddef>
+#include <cmath>
+
+// Integration kernel shared by the scalar and AVX paths of SingleBodyStore
+// Written once against a Lane type, which must provide WIDTH, load, store, broadcast, +, -, * and rotationVecFactors
+namespace P3D {
+// Every field is a contiguous array of doubles, one entry per body
+enum SingleBodyField : std::size_t {
+	// rotation matrix, row major
+	ROT_XX, ROT_XY, ROT_XZ,
+	ROT_YX, ROT_YY, ROT_YZ,
+	ROT_ZX, ROT_ZY, ROT_ZZ,
+	VEL_X, VEL_Y, VEL_Z,
+	ANG_VEL_X, ANG_VEL_Y, ANG_VEL_Z,
+	FORCE_X, FORCE_Y, FORCE_Z,
+	MOMENT_X, MOMENT_Y, MOMENT_Z,
+	LOCAL_COM_X, LOCAL_COM_Y, LOCAL_COM_Z,
+	INV_MASS,
+	// local moment response, upper triangle
+	INV_INERTIA_XX, INV_INERTIA_XY, INV_INERTIA_XZ, INV_INERTIA_YY, INV_INERTIA_YZ, INV_INERTIA_ZZ,
+	// local inertia, upper triangle
+	INERTIA_XX, INERTIA_XY, INERTIA_XZ, INERTIA_YY, INERTIA_YZ, INERTIA_ZZ,
+	// output, translation of the CFrame of the body this tick
+	MOVE_X, MOVE_Y, MOVE_Z,
+
+	SINGLE_BODY_FIELD_COUNT
+};
+
+// sin(angle) / angle, (1 - cos(angle)) / angle^2 and cos(angle), with the same small angle fallback as rotationMatrixFromRotationVec
+inline void rotationVecFactors(double angleSq, double& sinc, double& cosc, double& cosAngle) {
+	double angle = std::sqrt(angleSq);
+	cosAngle = std::cos(angle);
+	if(angleSq > 1E-20) {
+		sinc = std::sin(angle) / angle;
+		cosc = (1 - cosAngle) / angleSq;
+	} else {
+		sinc = 1 - angleSq / 6;
+		cosc = 0.5 - angleSq / 24;
+	}
+}
+
+template<typename Lane>
+struct LaneVec3 {
+	Lane x, y, z;
+};
+
+template<typename Lane>
+struct LaneMat3 {
+	Lane m[3][3];
+
+	LaneVec3<Lane> operator*(const LaneVec3<Lane>& v) const {
+		return LaneVec3<Lane>{
+			m[0][0] * v.x + m[0][1] * v.y + m[0][2] * v.z,
+			m[1][0] * v.x + m[1][1] * v.y + m[1][2] * v.z,
+			m[2][0] * v.x + m[2][1] * v.y + m[2][2] * v.z
+		};
+	}
+	LaneVec3<Lane> transposedMul(const LaneVec3<Lane>& v) const {
+		return LaneVec3<Lane>{
+			m[0][0] * v.x + m[1][0] * v.y + m[2][0] * v.z,
+			m[0][1] * v.x + m[1][1] * v.y + m[2][1] * v.z,
+			m[0][2] * v.x + m[1][2] * v.y + m[2][2] * v.z
+		};
+	}
+	LaneMat3 operator*(const LaneMat3& other) const {
+		LaneMat3 result;
+		for(int r = 0; r < 3; r++) {
+			for(int c = 0; c < 3; c++) {
+				result.m[r][c] = m[r][0] * other.m[0][c] + m[r][1] * other.m[1][c] + m[r][2] * other.m[2][c];
+			}
+		}
+		return result;
+	}
+};
+
+// upper triangle xx, xy, xz, yy, yz, zz
+template<typename Lane>
+LaneVec3<Lane> symmetricMul(const Lane* s, const LaneVec3<Lane>& v) {
+	return LaneVec3<Lane>{
+		s[0] * v.x + s[1] * v.y + s[2] * v.z,
+		s[1] * v.x + s[3] * v.y + s[4] * v.z,
+		s[2] * v.x + s[4] * v.y + s[5] * v.z
+	};
+}
+
+/*
+	Performs the same steps as MotorizedPhysical::update for a physical without children:
+	force integration, rotation around the center of mass and angular momentum correction
+	Bodies [start, end) are processed, end - start must be a multiple of Lane::WIDTH
+*/
+template<typename Lane>
+void integrateSingleBodies(double* const* fields, std::size_t start, std::size_t end, double deltaT) {
+	Lane dt = Lane::broadcast(deltaT);
+	Lane halfDtSq = Lane::broadcast(deltaT * deltaT * 0.5);
+
+	for(std::size_t i = start; i < end; i += Lane::WIDTH) {
+		auto load = [fields, i](std::size_t field) { return Lane::load(fields[field] + i); };
+		auto loadVec = [&load](std::size_t field) { return LaneVec3<Lane>{load(field), load(field + 1), load(field + 2)}; };
+
+		LaneMat3<Lane> rot;
+		for(int r = 0; r < 3; r++) {
+			for(int c = 0; c < 3; c++) {
+				rot.m[r][c] = load(ROT_XX + 3 * r + c);
+			}
+		}
+		LaneVec3<Lane> vel = loadVec(VEL_X);
+		LaneVec3<Lane> angVel = loadVec(ANG_VEL_X);
+		LaneVec3<Lane> force = loadVec(FORCE_X);
+		LaneVec3<Lane> moment = loadVec(MOMENT_X);
+		LaneVec3<Lane> localCOM = loadVec(LOCAL_COM_X);
+		Lane invMass = load(INV_MASS);
+		Lane invInertia[6];
+		Lane inertia[6];
+		for(int j = 0; j < 6; j++) {
+			invInertia[j] = load(INV_INERTIA_XX + j);
+			inertia[j] = load(INERTIA_XX + j);
+		}
+
+		Lane accelFactor = invMass * dt;
+		LaneVec3<Lane> accel{force.x * accelFactor, force.y * accelFactor, force.z * accelFactor};
+		LaneVec3<Lane> localRotAcc = symmetricMul(invInertia, rot.transposedMul(moment));
+		LaneVec3<Lane> rotAcc = rot * LaneVec3<Lane>{localRotAcc.x * dt, localRotAcc.y * dt, localRotAcc.z * dt};
+
+		vel = LaneVec3<Lane>{vel.x + accel.x, vel.y + accel.y, vel.z + accel.z};
+		angVel = LaneVec3<Lane>{angVel.x + rotAcc.x, angVel.y + rotAcc.y, angVel.z + rotAcc.z};
+
+		LaneVec3<Lane> angularMomentum = rot * symmetricMul(inertia, rot.transposedMul(angVel));
+
+		LaneVec3<Lane> movement{
+			vel.x * dt + accel.x * halfDtSq,
+			vel.y * dt + accel.y * halfDtSq,
+			vel.z * dt + accel.z * halfDtSq
+		};
+
+		// Rotation::fromRotationVector(angVel * deltaT)
+		LaneVec3<Lane> rotVec{angVel.x * dt, angVel.y * dt, angVel.z * dt};
+		Lane sinc, cosc, cosAngle;
+		Lane::rotationVecFactors(rotVec.x * rotVec.x + rotVec.y * rotVec.y + rotVec.z * rotVec.z, sinc, cosc, cosAngle);
+		LaneVec3<Lane> sincVec{rotVec.x * sinc, rotVec.y * sinc, rotVec.z * sinc};
+		Lane zero = Lane::broadcast(0.0);
+		Lane rotorEntries[3][3]{
+			{cosAngle, zero - sincVec.z, sincVec.y},
+			{sincVec.z, cosAngle, zero - sincVec.x},
+			{zero - sincVec.y, sincVec.x, cosAngle}
+		};
+		Lane rotVecArr[3]{rotVec.x, rotVec.y, rotVec.z};
+		LaneMat3<Lane> deltaRot;
+		for(int r = 0; r < 3; r++) {
+			for(int c = 0; c < 3; c++) {
+				deltaRot.m[r][c] = rotVecArr[r] * rotVecArr[c] * cosc + rotorEntries[r][c];
+			}
+		}
+
+		// rotate around the center of mass, the CFrame shifts by the movement of its offset to the center of mass
+		LaneVec3<Lane> relCOM = rot * localCOM;
+		LaneVec3<Lane> rotatedCOM = deltaRot * relCOM;
+		movement = LaneVec3<Lane>{
+			movement.x - (rotatedCOM.x - relCOM.x),
+			movement.y - (rotatedCOM.y - relCOM.y),
+			movement.z - (rotatedCOM.z - relCOM.z)
+		};
+		LaneMat3<Lane> newRot = deltaRot * rot;
+
+		// keep the angular momentum of before the rotation
+		angVel = newRot * symmetricMul(invInertia, newRot.transposedMul(angularMomentum));
+
+		for(int r = 0; r < 3; r++) {
+			for(int c = 0; c < 3; c++) {
+				newRot.m[r][c].store(fields[ROT_XX + 3 * r + c] + i);
+			}
+		}
+		vel.x.store(fields[VEL_X] + i); vel.y.store(fields[VEL_Y] + i); vel.z.store(fields[VEL_Z] + i);
+		angVel.x.store(fields[ANG_VEL_X] + i); angVel.y.store(fields[ANG_VEL_Y] + i); angVel.z.store(fields[ANG_VEL_Z] + i);
+		movement.x.store(fields[MOVE_X] + i); movement.y.store(fields[MOVE_Y] + i); movement.z.store(fields[MOVE_Z] + i);
+	}
+}
+
+void integrateSingleBodiesScalar(double* const* fields, std::size_t start, std::size_t end, double deltaT);
+void integrateSingleBodiesAVX(double* const* fields, std::size_t start, std::size_t end, double deltaT);
+};
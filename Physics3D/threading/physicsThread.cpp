@@ -52,6 +52,7 @@ void PhysicsThread::start() {
 
 	this->thread = std::thread([this] () {
 		time_point<system_clock> nextTarget = system_clock::now();
+		time_point<system_clock> nextLatencyReport = nextTarget + this->latencyReportInterval;
 
 		while (this->shouldBeRunning) {
 
@@ -59,6 +60,11 @@ void PhysicsThread::start() {
 
 			this->runTick();
 
+			if(!this->latencyReportPath.empty() && this->latencyReportInterval.count() != 0 && system_clock::now() >= nextLatencyReport) {
+				physicsMeasure.saveLatency(this->latencyReportPath);
+				nextLatencyReport = system_clock::now() + this->latencyReportInterval;
+			}
+
 			nextTarget += tickTime;
 			time_point<system_clock>  curTime = system_clock::now();
 			if (curTime < nextTarget) {
@@ -74,6 +80,10 @@ void PhysicsThread::start() {
 				}
 			}
 		}
+
+		if(!this->latencyReportPath.empty()) {
+			physicsMeasure.saveLatency(this->latencyReportPath);
+		}
 	});
 }
 void PhysicsThread::stopAsync() {
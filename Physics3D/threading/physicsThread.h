@@ -2,6 +2,8 @@
 
 #include <thread>
 #include <atomic>
+#include <string>
+#include <chrono>
 
 #include "threadPool.h"
 #include "upgradeableMutex.h"
@@ -20,6 +22,11 @@ public:
 	WorldPrototype* world;
 	UpgradeableMutex* worldMutex;
 	void(*tickFunction)(WorldPrototype*);
+	// when not empty, the latency histograms of physicsMeasure are saved here by the running thread every latencyReportInterval and once it stops, see saveLatencyReport
+	// only change these while the PhysicsThread is not running
+	std::string latencyReportPath;
+	// 0 to save only once the thread stops
+	std::chrono::milliseconds latencyReportInterval{0};
 
 	PhysicsThread(WorldPrototype* world, UpgradeableMutex* worldMutex, void(&tickFunction)(WorldPrototype*), std::chrono::milliseconds tickSkipTimeout = std::chrono::milliseconds(1000), unsigned int threadCount = 0);
 	PhysicsThread(WorldPrototype* world, UpgradeableMutex* worldMutex, std::chrono::milliseconds tickSkipTimeout = std::chrono::milliseconds(1000), unsigned int threadCount = 0);
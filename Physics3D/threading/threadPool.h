@@ -5,6 +5,8 @@
 #include <thread>
 #include <mutex>
 #include <condition_variable>
+#include <atomic>
+#include <algorithm>
 
 namespace P3D {
 class ThreadPool {
@@ -73,5 +75,18 @@ public:
 		threadsFinished.wait(selfLock, [this]() -> bool {return threadsWorking == 0; });
 		selfLock.unlock();
 	}
+
+	// splits [0, count) into chunks of at most chunkSize, all threads claim chunks and call chunkFunc(start, end) until none are left
+	template<typename Func>
+	void doInParallelChunks(std::size_t count, std::size_t chunkSize, const Func& chunkFunc) {
+		std::atomic<std::size_t> nextChunk(0);
+		doInParallel([&]() {
+			while(true) {
+				std::size_t start = nextChunk.fetch_add(chunkSize);
+				if(start >= count) break;
+				chunkFunc(start, std::min(start + chunkSize, count));
+			}
+		});
+	}
 };
 };
\ No newline at end of file
@@ -6,6 +6,11 @@
 #include "misc/validityHelper.h"
 #include "worldIteration.h"
 #include "threading/threadPool.h"
+#include "misc/cpuid.h"
+#include "geometry/shapeCreation.h"
+#include "geometry/shapeClass.h"
+#include "geometry/genericIntersection.h"
+#include "geometry/intersection.h"
 
 namespace P3D {
 // #define CHECK_WORLD_VALIDITY
@@ -240,6 +245,11 @@ void WorldPrototype::deletePart(Part* partToDelete) const {
 }
 
 void WorldPrototype::clear() {
+	this->colissionEvents.clear();
+	this->snapshots.clear();
+	this->commands.clear();
+	this->sleepingColissions.clear();
+	this->awakePhysicals.clear();
 	this->constraints.clear();
 	this->externalForces.clear();
 	for(MotorizedPhysical* phys : this->physicals) {
@@ -334,6 +344,271 @@ void WorldPrototype::notifyPhysicalHasBeenSplit(const MotorizedPhysical* mainPhy
 
 }
 
+/*
+	===== Queries =====
+*/
+
+// distance along the ray at which it enters the hitbox of the part, RAY_MAX_DISTANCE if it misses or the hitbox is behind the ray
+static double getRayDistanceToPart(const Part& part, const Ray& ray) {
+	const GlobalCFrame& cframe = part.getCFrame();
+	double distance = part.hitbox.getIntersectionDistance(cframe.globalToLocal(ray.origin), cframe.relativeToLocal(ray.direction));
+	if(!(distance >= 0.0 && distance < RAY_MAX_DISTANCE)) return RAY_MAX_DISTANCE;
+	return distance;
+}
+
+// estimates the surface normal at the hit from two neighbouring rays, exact on flat faces
+static Vec3 getRayHitNormal(const Part& part, const Ray& ray, double distance) {
+	const GlobalCFrame& cframe = part.getCFrame();
+	Vec3 localOrigin = cframe.globalToLocal(ray.origin);
+	Vec3 localDirection = cframe.relativeToLocal(ray.direction);
+
+	double offset = part.maxRadius * 1E-5;
+	Vec3 side = std::abs(localDirection.x) < std::abs(localDirection.y) ? Vec3(1, 0, 0) : Vec3(0, 1, 0);
+	Vec3 offsetA = normalize(localDirection % side) * offset;
+	Vec3 offsetB = normalize(localDirection % offsetA) * offset;
+
+	double distanceA = part.hitbox.getIntersectionDistance(localOrigin + offsetA, localDirection);
+	double distanceB = part.hitbox.getIntersectionDistance(localOrigin + offsetB, localDirection);
+	// compared against a finite range rather than with isfinite, the release build uses -Ofast which assumes finite math
+	double maxSpread = part.maxRadius * 2.0 / length(localDirection);
+	if(!(std::abs(distanceA - distance) < maxSpread) || !(std::abs(distanceB - distance) < maxSpread)) {
+		return -normalize(ray.direction);
+	}
+
+	Vec3 hitPoint = localOrigin + localDirection * distance;
+	Vec3 hitA = localOrigin + offsetA + localDirection * distanceA;
+	Vec3 hitB = localOrigin + offsetB + localDirection * distanceB;
+	Vec3 localNormal = (hitA - hitPoint) % (hitB - hitPoint);
+	// grazing hits can put all three points on a line
+	if(!(lengthSquared(localNormal) > offset * offset * offset * offset * 1E-12)) {
+		return -normalize(ray.direction);
+	}
+	if(localNormal * localDirection > 0) localNormal = -localNormal;
+
+	return normalize(cframe.localToRelative(localNormal));
+}
+
+static void completeRaycastHit(RaycastHit& hit, const Ray& ray) {
+	if(hit.part == nullptr) return;
+	hit.position = ray.origin + ray.direction * hit.distance;
+	hit.normal = getRayHitNormal(*hit.part, ray, hit.distance);
+}
+
+template<typename SIMDHelper>
+static RaycastHit raycastLayers(const std::vector<ColissionLayer>& layers, const Ray& ray, double maxDistance, LayerMask layerMask) {
+	RaycastHit hit;
+	TreeRay treeRay(castPositionToVec3f(ray.origin), static_cast<Vec3f>(ray.direction));
+	for(std::size_t layerIndex = 0; layerIndex < layers.size(); layerIndex++) {
+		if(!isLayerInMask(layerIndex, layerMask)) continue;
+		for(const WorldLayer& subLayer : layers[layerIndex].subLayers) {
+			maxDistance = subLayer.tree.template raycast<SIMDHelper>(treeRay, maxDistance, [&](Part& part, double maxDistance) {
+				double distance = getRayDistanceToPart(part, ray);
+				if(distance < maxDistance) {
+					hit.part = &part;
+					hit.distance = distance;
+				}
+				return distance;
+			});
+		}
+	}
+	completeRaycastHit(hit, ray);
+	return hit;
+}
+
+template<typename SIMDHelper>
+static void raycastManyLayers(const std::vector<ColissionLayer>& layers, const Ray* rays, std::size_t rayCount, RaycastHit* hits, double maxDistance, LayerMask layerMask) {
+	for(std::size_t packetStart = 0; packetStart < rayCount; packetStart += RAY_PACKET_SIZE) {
+		int packetSize = static_cast<int>(std::min<std::size_t>(RAY_PACKET_SIZE, rayCount - packetStart));
+		const Ray* packetRays = rays + packetStart;
+		RaycastHit* packetHits = hits + packetStart;
+
+		TreeRayPacket packet;
+		double maxDistances[RAY_PACKET_SIZE];
+		unsigned int activeRays = 0;
+		for(int r = 0; r < packetSize; r++) {
+			packet.setRay(r, TreeRay(castPositionToVec3f(packetRays[r].origin), static_cast<Vec3f>(packetRays[r].direction)), static_cast<float>(std::min(maxDistance, static_cast<double>(RAY_MAX_DISTANCE))));
+			maxDistances[r] = maxDistance;
+			packetHits[r] = RaycastHit();
+			activeRays |= 1U << r;
+		}
+
+		for(std::size_t layerIndex = 0; layerIndex < layers.size(); layerIndex++) {
+			if(!isLayerInMask(layerIndex, layerMask)) continue;
+			for(const WorldLayer& subLayer : layers[layerIndex].subLayers) {
+				subLayer.tree.template raycastPacket<SIMDHelper>(packet, maxDistances, activeRays, [&](Part& part, int rayIndex, double maxDistance) {
+					double distance = getRayDistanceToPart(part, packetRays[rayIndex]);
+					if(distance < maxDistance) {
+						packetHits[rayIndex].part = &part;
+						packetHits[rayIndex].distance = distance;
+					}
+					return distance;
+				});
+			}
+		}
+
+		for(int r = 0; r < packetSize; r++) {
+			completeRaycastHit(packetHits[r], packetRays[r]);
+		}
+	}
+}
+
+// exact overlap test between the hitbox of the part and shape placed at cframe
+// only runs GJK, queries don't need the penetration depth EPA would add
+static bool doesPartOverlapShape(const Part& part, const Shape& shape, const GlobalCFrame& cframe) {
+	CFrame relativeTransform = part.getCFrame().globalToLocal(cframe);
+	ColissionPair info{*part.hitbox.baseShape, *shape.baseShape, relativeTransform, part.hitbox.scale, shape.scale};
+	return runGJKTransformed(info, -relativeTransform.position).has_value();
+}
+
+template<typename SIMDHelper>
+static std::size_t queryShapeLayers(const std::vector<ColissionLayer>& layers, const Shape& shape, const GlobalCFrame& cframe, Part** results, std::size_t maxResults, LayerMask layerMask) {
+	BoundsTemplate<float> shapeBounds(shape.getBounds(cframe.getRotation()) + cframe.getPosition());
+	std::size_t count = 0;
+	for(std::size_t layerIndex = 0; layerIndex < layers.size(); layerIndex++) {
+		if(!isLayerInMask(layerIndex, layerMask)) continue;
+		for(const WorldLayer& subLayer : layers[layerIndex].subLayers) {
+			subLayer.tree.template forEachInBounds<SIMDHelper>(shapeBounds, [&](Part& part) {
+				if(!doesPartOverlapShape(part, shape, cframe)) return;
+				if(count < maxResults) results[count] = &part;
+				count++;
+			});
+		}
+	}
+	return count;
+}
+
+// same as queryShapeLayers with a sphere, but the candidates are culled with the sphere instead of its bounds
+template<typename SIMDHelper>
+static std::size_t querySphereLayers(const std::vector<ColissionLayer>& layers, const Position& center, double radius, Part** results, std::size_t maxResults, LayerMask layerMask) {
+	Shape sphere = sphereShape(radius);
+	GlobalCFrame sphereCFrame(center);
+	Vec3f treeCenter = castPositionToVec3f(center);
+	std::size_t count = 0;
+	for(std::size_t layerIndex = 0; layerIndex < layers.size(); layerIndex++) {
+		if(!isLayerInMask(layerIndex, layerMask)) continue;
+		for(const WorldLayer& subLayer : layers[layerIndex].subLayers) {
+			subLayer.tree.template forEachInSphere<SIMDHelper>(treeCenter, static_cast<float>(radius), [&](Part& part) {
+				if(!doesPartOverlapShape(part, sphere, sphereCFrame)) return;
+				if(count < maxResults) results[count] = &part;
+				count++;
+			});
+		}
+	}
+	return count;
+}
+
+template<typename SIMDHelper>
+static std::size_t queryKNearestLayers(const std::vector<ColissionLayer>& layers, const Position& point, std::size_t k, Part** results, float* distancesSq, LayerMask layerMask) {
+	NearestObjects<Part> nearest(results, distancesSq, k);
+	Vec3f treePoint = castPositionToVec3f(point);
+	for(std::size_t layerIndex = 0; layerIndex < layers.size(); layerIndex++) {
+		if(!isLayerInMask(layerIndex, layerMask)) continue;
+		for(const WorldLayer& subLayer : layers[layerIndex].subLayers) {
+			subLayer.tree.template queryKNearest<SIMDHelper>(treePoint, nearest, [](Part&, float boundsDistanceSq) { return boundsDistanceSq; });
+		}
+	}
+	return nearest.count;
+}
+
+// fraction of motion at which the moving box starts overlapping the part bounds, larger than 1 if it doesn't within the motion
+static double getSweptBoundsEntryTime(const BoundsTemplate<float>& partBounds, const BoundsTemplate<float>& movingBounds, const Vec3& motion) {
+	Vec3 toPart(partBounds.min - movingBounds.max);
+	Vec3 pastPart(partBounds.max - movingBounds.min);
+	double entry = 0.0;
+	double exit = 1.0;
+	for(int axis = 0; axis < 3; axis++) {
+		if(motion[axis] == 0.0) {
+			if(toPart[axis] > 0.0 || pastPart[axis] < 0.0) return 2.0;
+			continue;
+		}
+		double t0 = toPart[axis] / motion[axis];
+		double t1 = pastPart[axis] / motion[axis];
+		if(t0 > t1) std::swap(t0, t1);
+		entry = std::max(entry, t0);
+		exit = std::min(exit, t1);
+		if(entry > exit) return 2.0;
+	}
+	return entry;
+}
+
+template<typename SIMDHelper>
+static ShapeCastHit shapeCastLayers(const std::vector<ColissionLayer>& layers, const Shape& shape, const GlobalCFrame& start, const Vec3& motion, LayerMask layerMask) {
+	BoundsTemplate<float> startBounds(shape.getBounds(start.getRotation()) + start.getPosition());
+	BoundsTemplate<float> endBounds(shape.getBounds(start.getRotation()) + (start.getPosition() + motion));
+	BoundsTemplate<float> sweptBounds = unionOfBounds(startBounds, endBounds);
+	ShapeCastHit hit;
+	for(std::size_t layerIndex = 0; layerIndex < layers.size(); layerIndex++) {
+		if(!isLayerInMask(layerIndex, layerMask)) continue;
+		for(const WorldLayer& subLayer : layers[layerIndex].subLayers) {
+			subLayer.tree.template forEachInBounds<SIMDHelper>(sweptBounds, [&](Part& part) {
+				// parts whose bounds are only reached after the current hit can't be hit earlier
+				if(getSweptBoundsEntryTime(part.getBounds(), startBounds, motion) > hit.timeOfImpact) return;
+				const GlobalCFrame& partCFrame = part.getCFrame();
+				std::optional<CastIntersection> result = castTransformed(part.hitbox, shape, partCFrame.globalToLocal(start), partCFrame.relativeToLocal(motion));
+				if(!result || result->timeOfImpact > hit.timeOfImpact) return;
+				hit.part = &part;
+				hit.timeOfImpact = result->timeOfImpact;
+				hit.position = partCFrame.localToGlobal(result->point);
+				hit.normal = partCFrame.localToRelative(result->normal);
+			});
+		}
+	}
+	return hit;
+}
+
+RaycastHit WorldPrototype::raycast(const Ray& ray, double maxDistance, LayerMask layerMask) const {
+	if(CPUIDCheck::hasTechnology(CPUIDCheck::AVX)) {
+		return raycastLayers<TrunkSIMDHelperAVX>(this->layers, ray, maxDistance, layerMask);
+	} else {
+		return raycastLayers<TrunkSIMDHelperFallback>(this->layers, ray, maxDistance, layerMask);
+	}
+}
+
+void WorldPrototype::raycastMany(const Ray* rays, std::size_t rayCount, RaycastHit* hits, double maxDistance, LayerMask layerMask) const {
+	if(CPUIDCheck::hasTechnology(CPUIDCheck::AVX)) {
+		raycastManyLayers<TrunkSIMDHelperAVX>(this->layers, rays, rayCount, hits, maxDistance, layerMask);
+	} else {
+		raycastManyLayers<TrunkSIMDHelperFallback>(this->layers, rays, rayCount, hits, maxDistance, layerMask);
+	}
+}
+
+std::size_t WorldPrototype::queryBox(const Bounds& box, Part** results, std::size_t maxResults, LayerMask layerMask) const {
+	Shape boxAsShape = boxShape(static_cast<double>(box.getWidth()), static_cast<double>(box.getHeight()), static_cast<double>(box.getDepth()));
+	return queryShape(boxAsShape, GlobalCFrame(box.getCenter()), results, maxResults, layerMask);
+}
+
+std::size_t WorldPrototype::querySphere(const Position& center, double radius, Part** results, std::size_t maxResults, LayerMask layerMask) const {
+	if(CPUIDCheck::hasTechnology(CPUIDCheck::AVX)) {
+		return querySphereLayers<TrunkSIMDHelperAVX>(this->layers, center, radius, results, maxResults, layerMask);
+	} else {
+		return querySphereLayers<TrunkSIMDHelperFallback>(this->layers, center, radius, results, maxResults, layerMask);
+	}
+}
+
+std::size_t WorldPrototype::queryShape(const Shape& shape, const GlobalCFrame& cframe, Part** results, std::size_t maxResults, LayerMask layerMask) const {
+	if(CPUIDCheck::hasTechnology(CPUIDCheck::AVX)) {
+		return queryShapeLayers<TrunkSIMDHelperAVX>(this->layers, shape, cframe, results, maxResults, layerMask);
+	} else {
+		return queryShapeLayers<TrunkSIMDHelperFallback>(this->layers, shape, cframe, results, maxResults, layerMask);
+	}
+}
+
+std::size_t WorldPrototype::queryKNearest(const Position& point, std::size_t k, Part** results, float* distancesSq, LayerMask layerMask) const {
+	if(CPUIDCheck::hasTechnology(CPUIDCheck::AVX)) {
+		return queryKNearestLayers<TrunkSIMDHelperAVX>(this->layers, point, k, results, distancesSq, layerMask);
+	} else {
+		return queryKNearestLayers<TrunkSIMDHelperFallback>(this->layers, point, k, results, distancesSq, layerMask);
+	}
+}
+
+ShapeCastHit WorldPrototype::shapeCast(const Shape& shape, const GlobalCFrame& start, const Vec3& motion, LayerMask layerMask) const {
+	if(CPUIDCheck::hasTechnology(CPUIDCheck::AVX)) {
+		return shapeCastLayers<TrunkSIMDHelperAVX>(this->layers, shape, start, motion, layerMask);
+	} else {
+		return shapeCastLayers<TrunkSIMDHelperFallback>(this->layers, shape, start, motion, layerMask);
+	}
+}
+
 void WorldPrototype::onPartAdded(Part* newPart) {}
 void WorldPrototype::onPartRemoved(Part* removedPart) {}
 
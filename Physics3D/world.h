@@ -3,6 +3,8 @@
 #include <vector>
 #include <mutex>
 #include <memory>
+#include <cstdint>
+#include <limits>
 
 #include "part.h"
 #include "physical.h"
@@ -10,6 +12,13 @@
 #include "softlinks/softLink.h"
 #include "externalforces/externalForce.h"
 #include "colissionBuffer.h"
+#include "colissionEvents.h"
+#include "layerMask.h"
+#include "singleBodyStore.h"
+#include "simulationIslands.h"
+#include "worldSnapshot.h"
+#include "worldCommandQueue.h"
+#include "math/ray.h"
 
 namespace P3D {
 class Physical;
@@ -19,6 +28,30 @@ class Part;
 class WorldLayer;
 class ColissionLayer;
 class ThreadPool;
+struct TreeFrustum;
+
+struct RaycastHit {
+	Part* part = nullptr;
+	// in multiples of the direction of the ray
+	double distance = std::numeric_limits<float>::max();
+	Position position;
+	// surface normal of the part at position, facing the ray
+	Vec3 normal;
+
+	bool hasHit() const { return part != nullptr; }
+};
+
+struct ShapeCastHit {
+	Part* part = nullptr;
+	// fraction of the motion travelled before touching part, 0 if the shape already overlaps it at the start
+	double timeOfImpact = 1.0;
+	// contact point on the surface of part
+	Position position;
+	// surface normal of the part at position, facing the cast shape
+	Vec3 normal;
+
+	bool hasHit() const { return part != nullptr; }
+};
 
 class WorldPrototype {
 private:
@@ -53,6 +86,33 @@ public:
 	// All physicals
 	std::vector<MotorizedPhysical*> physicals;
 
+	// opt-in, integrates physicals without children in struct of arrays form, see SingleBodyStore
+	bool useSingleBodyStore = false;
+	SingleBodyStore singleBodyStore;
+
+	/*
+		opt-in, ticking with a ThreadPool gives a bitwise identical world state for any number of threads
+		Without it colissions are handled in the order their narrow phase finished
+	*/
+	bool useDeterministicThreading = false;
+
+	// opt-in, handles the colissions of unconnected physicals in parallel, see handleColissionsParallel
+	bool useParallelColissionResponse = false;
+	ColissionPartition colissionPartition;
+	std::vector<ColissionResponse> colissionResponses;
+
+	// opt-in, islands of physicals that rest for ticksBeforeSleep ticks are put to sleep until something wakes them, see simulationIslands.h
+	bool useSleeping = false;
+	// kinetic energy per unit of mass below which a physical counts as resting
+	double sleepEnergyThreshold = 0.05;
+	int ticksBeforeSleep = 60;
+	// physicals that were not asleep when this tick started integrating
+	std::vector<MotorizedPhysical*> awakePhysicals;
+	SimulationIslands islands;
+	// colissions set aside this tick because none of their parts were awake
+	ColissionBuffer sleepingColissions;
+	std::size_t lastSleepingIslandID = 0;
+
 	void addPhysicalWithExistingLayers(MotorizedPhysical* motorPhys);
 
 	// Extra world features
@@ -63,6 +123,12 @@ public:
 	void addLink(SoftLink* link);
 
 	ColissionBuffer curColissions;
+	// begin, persist and end events of colliding parts, must be enabled to be filled
+	ColissionEventStream colissionEvents;
+	// lock-free copies of the parts for other threads, published at the end of every tick when enabled
+	WorldSnapshotPublisher snapshots;
+	// mutations pushed from other threads without locking the world, applied at the start of every tick
+	WorldCommandQueue commands;
 	size_t age = 0;
 	size_t objectCount = 0;
 	double deltaT;
@@ -112,6 +178,38 @@ public:
 
 	virtual bool isValid() const;
 
+	/*
+		Returns the nearest part hit by the ray within maxDistance, searching only the layers in layerMask
+		The bounds trees are traversed front to back and stop once nothing nearer than the current hit remains
+	*/
+	RaycastHit raycast(const Ray& ray, double maxDistance = std::numeric_limits<float>::max(), LayerMask layerMask = ALL_LAYERS) const;
+	/*
+		raycast for rayCount rays at once, writes the hit of rays[i] to hits[i]
+		Rays are traversed in packets of RAY_PACKET_SIZE consecutive rays, so rays that are close together
+		and point in similar directions should be next to each other, as in sensor fans and line of sight grids
+	*/
+	void raycastMany(const Ray* rays, std::size_t rayCount, RaycastHit* hits, double maxDistance = std::numeric_limits<float>::max(), LayerMask layerMask = ALL_LAYERS) const;
+
+	/*
+		Overlap queries, write the parts overlapping a region to results, at most maxResults of them
+		Return the total number of overlapping parts, which may be larger than maxResults so callers can retry with a larger buffer
+		Candidates come from the bounds trees of the layers in layerMask and are then checked against the hitbox of the part with GJK
+	*/
+	std::size_t queryBox(const Bounds& box, Part** results, std::size_t maxResults, LayerMask layerMask = ALL_LAYERS) const;
+	std::size_t querySphere(const Position& center, double radius, Part** results, std::size_t maxResults, LayerMask layerMask = ALL_LAYERS) const;
+	std::size_t queryShape(const Shape& shape, const GlobalCFrame& cframe, Part** results, std::size_t maxResults, LayerMask layerMask = ALL_LAYERS) const;
+	/*
+		Writes the k parts nearest to point to results, sorted by distance, and their squared distances to distancesSq
+		The distance of a part is the distance from point to its bounds, 0 if point is inside them
+		Returns the number of parts written, less than k if the layers in layerMask hold fewer parts
+	*/
+	std::size_t queryKNearest(const Position& point, std::size_t k, Part** results, float* distancesSq, LayerMask layerMask = ALL_LAYERS) const;
+	/*
+		Sweeps shape from start along motion without rotating it and returns the first part it touches
+		Candidates are the parts in the swept bounds of the shape, each is cast against with GJK, so thin parts are never tunneled through
+	*/
+	ShapeCastHit shapeCast(const Shape& shape, const GlobalCFrame& start, const Vec3& motion, LayerMask layerMask = ALL_LAYERS) const;
+
 	// include worldIteration.h to use
 	// expects a function of the form void(Part& part)
 	template<typename Func>
@@ -121,6 +219,12 @@ public:
 	// expects a function of the form void(Part& part)
 	template<typename Func, typename Filter>
 	void forEachPartFiltered(const Filter& filter, const Func& funcToRun) const;
+
+	// include worldIteration.h to use
+	// expects a function of the form void(Part& part), called for every part whose bounds are at least partially inside frustum
+	// Faster than forEachPartFiltered with a VisibilityFilter, trunks are culled 8 subnodes at a time and subtrees fully inside the frustum are not tested further
+	template<typename Func>
+	void forEachPartInFrustum(const TreeFrustum& frustum, const Func& funcToRun) const;
 };
 
 template<typename T = Part>
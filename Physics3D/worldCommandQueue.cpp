@@ -0,0 +1,119 @@
+#include "worldCommandQueue.h"
+
+#include "world.h"
+#include "part.h"
+#include "physical.h"
+#include "misc/debug.h"
+
+namespace P3D {
+void WorldCommandQueue::push(const WorldCommand& command) {
+	std::lock_guard<std::mutex> lock(queueMutex);
+	pendingCommands.push_back(command);
+}
+
+void WorldCommandQueue::addPart(Part* part, int layerIndex) {
+	WorldCommand command{WorldCommandType::ADD_PART, part};
+	command.layerIndex = layerIndex;
+	push(command);
+}
+
+void WorldCommandQueue::addTerrainPart(Part* part, int layerIndex) {
+	WorldCommand command{WorldCommandType::ADD_TERRAIN_PART, part};
+	command.layerIndex = layerIndex;
+	push(command);
+}
+
+void WorldCommandQueue::removePart(Part* part) {
+	push(WorldCommand{WorldCommandType::REMOVE_PART, part});
+}
+
+void WorldCommandQueue::setCFrame(Part* part, const GlobalCFrame& newCFrame) {
+	WorldCommand command{WorldCommandType::SET_CFRAME, part};
+	command.cframe = newCFrame;
+	push(command);
+}
+
+void WorldCommandQueue::applyImpulse(Part* part, Position origin, Vec3 impulse) {
+	WorldCommand command{WorldCommandType::APPLY_IMPULSE, part};
+	command.origin = origin;
+	command.impulse = impulse;
+	push(command);
+}
+
+void WorldCommandQueue::attach(Part* part, Part* other, const CFrame& relativeCFrame) {
+	WorldCommand command{WorldCommandType::ATTACH, part};
+	command.other = other;
+	command.attachment = relativeCFrame;
+	push(command);
+}
+
+void WorldCommandQueue::detach(Part* part) {
+	push(WorldCommand{WorldCommandType::DETACH, part});
+}
+
+bool WorldCommandQueue::hasCommands() {
+	std::lock_guard<std::mutex> lock(queueMutex);
+	return !pendingCommands.empty();
+}
+
+static void applyCommand(WorldPrototype& world, const WorldCommand& command) {
+	Part* part = command.part;
+	switch(command.type) {
+		case WorldCommandType::ADD_PART:
+			world.addPart(part, command.layerIndex);
+			break;
+		case WorldCommandType::ADD_TERRAIN_PART:
+			world.addTerrainPart(part, command.layerIndex);
+			break;
+		case WorldCommandType::REMOVE_PART:
+			if(part->layer == nullptr) {
+				Debug::logWarn("Queued removal of a part that is not in a world");
+				break;
+			}
+			world.removePart(part);
+			break;
+		case WorldCommandType::SET_CFRAME:
+			part->setCFrame(command.cframe);
+			break;
+		case WorldCommandType::APPLY_IMPULSE:
+			if(part->getPhysical() != nullptr) {
+				MotorizedPhysical* phys = part->getMainPhysical();
+				phys->applyImpulse(command.origin - phys->getCenterOfMass(), command.impulse);
+			}
+			break;
+		case WorldCommandType::ATTACH:
+			part->attach(command.other, command.attachment);
+			break;
+		case WorldCommandType::DETACH:
+			if(part->getPhysical() == nullptr) {
+				Debug::logWarn("Queued detach of a part without a physical");
+				break;
+			}
+			part->detach();
+			break;
+	}
+}
+
+void WorldCommandQueue::apply(WorldPrototype& world) {
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		applyingCommands.swap(pendingCommands);
+	}
+
+	std::size_t addCount = 0;
+	for(const WorldCommand& command : applyingCommands) {
+		if(command.type == WorldCommandType::ADD_PART) addCount++;
+	}
+	world.physicals.reserve(world.physicals.size() + addCount);
+
+	for(const WorldCommand& command : applyingCommands) {
+		applyCommand(world, command);
+	}
+	applyingCommands.clear();
+}
+
+void WorldCommandQueue::clear() {
+	std::lock_guard<std::mutex> lock(queueMutex);
+	pendingCommands.clear();
+}
+};
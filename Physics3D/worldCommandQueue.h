@@ -0,0 +1,76 @@
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <cstddef>
+
+#include "math/linalg/vec.h"
+#include "math/position.h"
+#include "math/cframe.h"
+#include "math/globalCFrame.h"
+
+namespace P3D {
+class Part;
+class WorldPrototype;
+
+enum class WorldCommandType : char {
+	ADD_PART,
+	ADD_TERRAIN_PART,
+	REMOVE_PART,
+	SET_CFRAME,
+	APPLY_IMPULSE,
+	ATTACH,
+	DETACH
+};
+
+struct WorldCommand {
+	WorldCommandType type;
+	Part* part;
+	// the part attached to part by ATTACH
+	Part* other = nullptr;
+	int layerIndex = 0;
+	// SET_CFRAME
+	GlobalCFrame cframe;
+	// ATTACH, cframe of other relative to part
+	CFrame attachment;
+	// APPLY_IMPULSE
+	Position origin;
+	Vec3 impulse;
+
+	WorldCommand(WorldCommandType type, Part* part) : type(type), part(part) {}
+};
+
+/*
+	Collects world mutations from any number of threads, to be applied by the tick at PhysicsProcess::QUEUE
+	Producers only lock the queue itself, never the world, so they don't contend with the tick
+
+	Commands are applied in the order they were pushed, all commands pushed before the tick reaches QUEUE are applied in that tick
+	The parts of a command must stay alive until it is applied, removed parts may be deleted after the tick that removed them
+*/
+class WorldCommandQueue {
+	std::mutex queueMutex;
+	std::vector<WorldCommand> pendingCommands;
+	std::vector<WorldCommand> applyingCommands;
+
+	void push(const WorldCommand& command);
+public:
+	WorldCommandQueue() = default;
+	WorldCommandQueue(const WorldCommandQueue&) = delete;
+	WorldCommandQueue& operator=(const WorldCommandQueue&) = delete;
+
+	void addPart(Part* part, int layerIndex = 0);
+	void addTerrainPart(Part* part, int layerIndex = 0);
+	void removePart(Part* part);
+	void setCFrame(Part* part, const GlobalCFrame& newCFrame);
+	// impulse applied at the global position origin, to the MotorizedPhysical part belongs to
+	void applyImpulse(Part* part, Position origin, Vec3 impulse);
+	// see Part::attach
+	void attach(Part* part, Part* other, const CFrame& relativeCFrame);
+	void detach(Part* part);
+
+	bool hasCommands();
+	// called by the tick, while no other thread accesses the world
+	void apply(WorldPrototype& world);
+	void clear();
+};
+};
@@ -2,6 +2,7 @@
 
 #include "world.h"
 #include "layer.h"
+#include "misc/cpuid.h"
 
 namespace P3D {
 // expects a function of the form void(Part& part)
@@ -19,6 +20,19 @@ void WorldPrototype::forEachPartFiltered(const Filter& filter, const Func& funcT
 	}
 }
 
+// expects a function of the form void(Part& part)
+template<typename Func>
+void WorldPrototype::forEachPartInFrustum(const TreeFrustum& frustum, const Func& funcToRun) const {
+	bool useAVX = CPUIDCheck::hasTechnology(CPUIDCheck::AVX);
+	for(const ColissionLayer& layer : this->layers) {
+		if(useAVX) {
+			layer.forEachInFrustum<TrunkSIMDHelperAVX>(frustum, funcToRun);
+		} else {
+			layer.forEachInFrustum<TrunkSIMDHelperFallback>(frustum, funcToRun);
+		}
+	}
+}
+
 // expects a function of the form void(T& part)
 template<typename T>
 template<typename Func>
@@ -15,13 +15,18 @@
 #include <algorithm>
 
 #define COLLISSION_DEPTH_FORCE_MULTIPLIER 2000
+// physicals differ a lot in update cost, small chunks keep the threads balanced
+#define PHYSICAL_UPDATE_CHUNK_SIZE 32
+// most islands only hold a few colissions
+#define COLISSION_RESPONSE_CHUNK_SIZE 16
+#define COLISSION_REFINE_CHUNK_SIZE 8
 
 namespace P3D {
 /*
 	exitVector is the distance p2 must travel so that the shapes are no longer colliding
 */
 
-void handleCollision(Part& part1, Part& part2, Position collisionPoint, Vec3 exitVector) {
+ColissionResponse handleCollision(Part& part1, Part& part2, Position collisionPoint, Vec3 exitVector) {
 	Debug::logPoint(collisionPoint, Debug::INTERSECTION);
 	
 	MotorizedPhysical& phys1 = *part1.getPhysical()->mainPhysical;
@@ -29,7 +34,7 @@ void handleCollision(Part& part1, Part& part2, Position collisionPoint, Vec3 exi
 
 	double sizeOrder = std::min(part1.maxRadius, part2.maxRadius);
 	if(lengthSquared(exitVector) <= 1E-8 * sizeOrder * sizeOrder) {
-		return; // don't do anything for very small colissions
+		return ColissionResponse(); // don't do anything for very small colissions
 	}
 
 	Vec3 collissionRelP1 = collisionPoint - phys1.getCenterOfMass();
@@ -54,6 +59,9 @@ void handleCollision(Part& part1, Part& part2, Position collisionPoint, Vec3 exi
 
 	Vec3 relativeVelocity = (part1.getMotion().getVelocityOfPoint(part1ToColission) - part1.properties.conveyorEffect) - (part2.getMotion().getVelocityOfPoint(part2ToColission) - part2.properties.conveyorEffect);
 
+	ColissionResponse response;
+	response.relativeVelocity = relativeVelocity;
+
 	bool isImpulseColission = relativeVelocity * exitVector > 0;
 
 	Vec3 impulse;
@@ -84,6 +92,7 @@ void handleCollision(Part& part1, Part& part2, Position collisionPoint, Vec3 exi
 
 		phys1.applyImpulse(collissionRelP1, fricImpulse);
 		phys2.applyImpulse(collissionRelP2, -fricImpulse);
+		response.impulse = impulse + fricImpulse;
 	}
 
 	double normalForce = length(depthForce);
@@ -99,21 +108,23 @@ void handleCollision(Part& part1, Part& part2, Position collisionPoint, Vec3 exi
 	}
 	phys1.applyForce(collissionRelP1, dynamicFricForce);
 	phys2.applyForce(collissionRelP2, -dynamicFricForce);
+	response.force = depthForce + dynamicFricForce;
 
 	assert(phys1.isValid());
 	assert(phys2.isValid());
+	return response;
 }
 
 /*
 	exitVector is the distance p2 must travel so that the shapes are no longer colliding
 */
-void handleTerrainCollision(Part& part1, Part& part2, Position collisionPoint, Vec3 exitVector) {
+ColissionResponse handleTerrainCollision(Part& part1, Part& part2, Position collisionPoint, Vec3 exitVector) {
 	Debug::logPoint(collisionPoint, Debug::INTERSECTION);
 	MotorizedPhysical& phys1 = *part1.getPhysical()->mainPhysical;
 
 	double sizeOrder = std::min(part1.maxRadius, part2.maxRadius);
 	if(lengthSquared(exitVector) <= 1E-8 * sizeOrder * sizeOrder) {
-		return; // don't do anything for very small colissions
+		return ColissionResponse(); // don't do anything for very small colissions
 	}
 
 	Vec3 collissionRelP1 = collisionPoint - phys1.getCenterOfMass();
@@ -133,6 +144,9 @@ void handleTerrainCollision(Part& part1, Part& part2, Position collisionPoint, V
 	Vec3 partToColission = collisionPoint - part1.getPosition();
 	Vec3 relativeVelocity = part1.getMotion().getVelocityOfPoint(partToColission) - part1.properties.conveyorEffect + part2.getCFrame().localToRelative(part2.properties.conveyorEffect);
 
+	ColissionResponse response;
+	response.relativeVelocity = relativeVelocity;
+
 	bool isImpulseColission = relativeVelocity * exitVector > 0;
 
 	Vec3 impulse;
@@ -159,6 +173,7 @@ void handleTerrainCollision(Part& part1, Part& part2, Position collisionPoint, V
 		Vec3 fricImpulse = (lengthSquared(stopFricImpulse) < lengthSquared(maxFrictionImpulse)) ? stopFricImpulse : maxFrictionImpulse;
 
 		phys1.applyImpulse(collissionRelP1, fricImpulse);
+		response.impulse = impulse + fricImpulse;
 	}
 
 	double normalForce = length(depthForce);
@@ -173,8 +188,10 @@ void handleTerrainCollision(Part& part1, Part& part2, Position collisionPoint, V
 		dynamicFricForce = -slidingVelocity / slidingSpeed * frictionForce * effectFactor;
 	}
 	phys1.applyForce(collissionRelP1, dynamicFricForce);
+	response.force = depthForce + dynamicFricForce;
 
 	assert(phys1.isValid());
+	return response;
 }
 
 /*
@@ -191,6 +208,9 @@ void WorldPrototype::tick() {
 }
 
 void tickWorldUnsynchronized(WorldPrototype& world, ThreadPool& threadPool) {
+	physicsMeasure.mark(PhysicsProcess::QUEUE);
+	world.commands.apply(world);
+
 	physicsMeasure.mark(PhysicsProcess::COLISSION_OTHER);
 	findColissionsParallel(world, world.curColissions, threadPool);
 
@@ -198,7 +218,11 @@ void tickWorldUnsynchronized(WorldPrototype& world, ThreadPool& threadPool) {
 	applyExternalForces(world);
 
 	physicsMeasure.mark(PhysicsProcess::COLISSION_HANDLING);
-	handleColissions(world.curColissions);
+	if(world.useParallelColissionResponse) {
+		handleColissionsParallel(world, threadPool);
+	} else {
+		handleColissions(world.curColissions, world.colissionEvents, world.deltaT);
+	}
 
 	physicsMeasure.mark(PhysicsProcess::OTHER);
 	intersectionStatistics.nextTally();
@@ -207,12 +231,25 @@ void tickWorldUnsynchronized(WorldPrototype& world, ThreadPool& threadPool) {
 	handleConstraints(world);
 
 	physicsMeasure.mark(PhysicsProcess::UPDATING);
-	update(world);
+	update(world, threadPool);
+
+	if(world.snapshots.enabled) {
+		physicsMeasure.mark(PhysicsProcess::PUBLISH_SNAPSHOT);
+		world.snapshots.publish(world);
+	}
 }
 
 void tickWorldSynchronized(WorldPrototype& world, ThreadPool& threadPool, UpgradeableMutex& worldMutex) {
 	physicsMeasure.mark(PhysicsProcess::WAIT_FOR_LOCK);
-	worldMutex.lock_upgradeable();
+	// the world is only locked exclusively at the start of the tick if there are queued commands
+	if(world.commands.hasCommands()) {
+		worldMutex.lock();
+		physicsMeasure.mark(PhysicsProcess::QUEUE);
+		world.commands.apply(world);
+		worldMutex.downgrade();
+	} else {
+		worldMutex.lock_upgradeable();
+	}
 
 	physicsMeasure.mark(PhysicsProcess::COLISSION_OTHER);
 	findColissionsParallel(world, world.curColissions, threadPool);
@@ -221,7 +258,11 @@ void tickWorldSynchronized(WorldPrototype& world, ThreadPool& threadPool, Upgrad
 	applyExternalForces(world);
 
 	physicsMeasure.mark(PhysicsProcess::COLISSION_HANDLING);
-	handleColissions(world.curColissions);
+	if(world.useParallelColissionResponse) {
+		handleColissionsParallel(world, threadPool);
+	} else {
+		handleColissions(world.curColissions, world.colissionEvents, world.deltaT);
+	}
 
 	physicsMeasure.mark(PhysicsProcess::OTHER);
 	intersectionStatistics.nextTally();
@@ -233,7 +274,16 @@ void tickWorldSynchronized(WorldPrototype& world, ThreadPool& threadPool, Upgrad
 	worldMutex.upgrade();
 
 	physicsMeasure.mark(PhysicsProcess::UPDATING);
-	update(world);
+	update(world, threadPool);
+
+	// readers of the world may already continue while the snapshot is copied
+	if(world.snapshots.enabled) {
+		worldMutex.final_downgrade();
+		physicsMeasure.mark(PhysicsProcess::PUBLISH_SNAPSHOT);
+		world.snapshots.publish(world);
+		worldMutex.unlock_shared();
+		return;
+	}
 
 	physicsMeasure.mark(PhysicsProcess::WAIT_FOR_LOCK);
 	worldMutex.unlock();
@@ -302,6 +352,9 @@ void parallelRefineColissions(ThreadPool& threadPool, std::vector<Colission>& co
 	std::mutex colissionMutex, statsMutex, indexMutex, vecMutex;
 
 	threadPool.doInParallel([&] {
+		// keeps worker threads active in the profiler for the whole loop instead of per intersection
+		PhysicsProcess previousProcess = physicsMeasure.getCurrentProcess();
+		physicsMeasure.mark(PhysicsProcess::COLISSION_OTHER);
 		while(true) {
 
 			indexMutex.lock();
@@ -340,11 +393,14 @@ void parallelRefineColissions(ThreadPool& threadPool, std::vector<Colission>& co
 
 			}
 		}
+		physicsMeasure.mark(previousProcess);
 	});
 	colissions.swap(wantedColission);
 }
 
-void findColissions(WorldPrototype& world, ColissionBuffer& curColissions) {
+// expects a function of type void(std::vector<Colission>&) that keeps only the colissions that truly intersect
+template<typename RefineFunc>
+static void findColissionsWith(WorldPrototype& world, ColissionBuffer& curColissions, const RefineFunc& refine) {
 	curColissions.clear();
 
 	for(const ColissionLayer& layer : world.layers) {
@@ -357,25 +413,85 @@ void findColissions(WorldPrototype& world, ColissionBuffer& curColissions) {
 		getColissionsBetween(world.layers[collidingLayers.first], world.layers[collidingLayers.second], curColissions);
 	}
 
-	refineColissions(curColissions.freePartColissions);
-	refineColissions(curColissions.freeTerrainColissions);
+	if(world.useSleeping) {
+		wakeMarkedIslands(world);
+		setAsideSleepingColissions(world, curColissions);
+		if(world.colissionEvents.enabled) {
+			for(const Colission& c : world.sleepingColissions.freePartColissions) {
+				world.colissionEvents.recordSleepingColission(c);
+			}
+			for(const Colission& c : world.sleepingColissions.freeTerrainColissions) {
+				world.colissionEvents.recordSleepingColission(c);
+			}
+		}
+	}
+
+	refine(curColissions.freePartColissions);
+	refine(curColissions.freeTerrainColissions);
+
+	// islands woken by an awake part still need the colissions between their own parts this tick
+	if(world.useSleeping && wakePartsTouchedByAwakeParts(curColissions)) {
+		wakeMarkedIslands(world);
+		ColissionBuffer wokenColissions;
+		takeWokenColissions(world, wokenColissions);
+		refine(wokenColissions.freePartColissions);
+		refine(wokenColissions.freeTerrainColissions);
+		curColissions.freePartColissions.insert(curColissions.freePartColissions.end(), wokenColissions.freePartColissions.begin(), wokenColissions.freePartColissions.end());
+		curColissions.freeTerrainColissions.insert(curColissions.freeTerrainColissions.end(), wokenColissions.freeTerrainColissions.begin(), wokenColissions.freeTerrainColissions.end());
+	}
 }
 
-void findColissionsParallel(WorldPrototype& world, ColissionBuffer& curColissions, ThreadPool& threadPool) {
-	curColissions.clear();
+void parallelRefineColissionsOrdered(ThreadPool& threadPool, std::vector<Colission>& colissions) {
+	std::vector<char> intersects(colissions.size());
+	std::mutex statsMutex;
 
-	for(const ColissionLayer& layer : world.layers) {
-		if(layer.collidesInternally) {
-			layer.getInternalColissions(curColissions);
+	threadPool.doInParallelChunks(colissions.size(), COLISSION_REFINE_CHUNK_SIZE, [&](std::size_t start, std::size_t end) {
+		PhysicsProcess previousProcess = physicsMeasure.getCurrentProcess();
+		physicsMeasure.mark(PhysicsProcess::COLISSION_OTHER);
+		std::size_t hits = 0;
+		for(std::size_t i = start; i < end; i++) {
+			Colission& col = colissions[i];
+			PartIntersection result = safeIntersects(*col.p1, *col.p2);
+			intersects[i] = result.intersects;
+			if(result.intersects) {
+				col.intersection = result.intersection;
+				col.exitVector = result.exitVector;
+				hits++;
+			}
 		}
-	}
+		statsMutex.lock();
+		intersectionStatistics.addToTally(IntersectionResult::COLISSION, hits);
+		intersectionStatistics.addToTally(IntersectionResult::GJK_REJECT, (end - start) - hits);
+		statsMutex.unlock();
+		physicsMeasure.mark(previousProcess);
+	});
 
-	for(std::pair<int, int> collidingLayers : world.colissionMask) {
-		getColissionsBetween(world.layers[collidingLayers.first], world.layers[collidingLayers.second], curColissions);
+	std::size_t kept = 0;
+	for(std::size_t i = 0; i < colissions.size(); i++) {
+		if(intersects[i]) {
+			colissions[kept++] = colissions[i];
+		}
 	}
+	colissions.resize(kept);
+}
 
-	parallelRefineColissions(threadPool, curColissions.freePartColissions);
-	parallelRefineColissions(threadPool, curColissions.freeTerrainColissions);
+void findColissions(WorldPrototype& world, ColissionBuffer& curColissions) {
+	findColissionsWith(world, curColissions, [](std::vector<Colission>& colissions) {
+		refineColissions(colissions);
+	});
+}
+
+void findColissionsParallel(WorldPrototype& world, ColissionBuffer& curColissions, ThreadPool& threadPool) {
+	// pairs come out of the trees in a fixed order, only the narrow phase has to keep it
+	if(world.useDeterministicThreading) {
+		findColissionsWith(world, curColissions, [&threadPool](std::vector<Colission>& colissions) {
+			parallelRefineColissionsOrdered(threadPool, colissions);
+		});
+	} else {
+		findColissionsWith(world, curColissions, [&threadPool](std::vector<Colission>& colissions) {
+			parallelRefineColissions(threadPool, colissions);
+		});
+	}
 }
 
 void handleColissions(ColissionBuffer& curColissions) {
@@ -387,22 +503,129 @@ void handleColissions(ColissionBuffer& curColissions) {
 	}
 }
 
+void handleColissions(ColissionBuffer& curColissions, ColissionEventStream& events, double deltaT) {
+	if(!events.enabled) {
+		handleColissions(curColissions);
+		return;
+	}
+	for(const Colission& c : curColissions.freePartColissions) {
+		events.recordColission(c, handleCollision(*c.p1, *c.p2, c.intersection, c.exitVector), deltaT);
+	}
+	for(const Colission& c : curColissions.freeTerrainColissions) {
+		events.recordColission(c, handleTerrainCollision(*c.p1, *c.p2, c.intersection, c.exitVector), deltaT);
+	}
+	events.finishTick();
+}
+
+void handleColissionsParallel(WorldPrototype& world, ThreadPool& threadPool) {
+	ColissionBuffer& curColissions = world.curColissions;
+	ColissionEventStream& events = world.colissionEvents;
+	ColissionPartition& partition = world.colissionPartition;
+	partition.build(world.physicals, curColissions);
+
+	std::size_t freePartCount = curColissions.freePartColissions.size();
+	std::vector<ColissionResponse>& responses = world.colissionResponses;
+	if(events.enabled) {
+		responses.resize(partition.colissionIndices.size());
+	}
+
+	// the debug log actions aren't thread safe, so every chunk logs into its own buffer until the chunks are joined
+	std::size_t partitionCount = partition.getPartitionCount();
+	std::vector<Debug::VisualLogBuffer> logBuffers((partitionCount + COLISSION_RESPONSE_CHUNK_SIZE - 1) / COLISSION_RESPONSE_CHUNK_SIZE);
+
+	// every physical belongs to a single partition, so partitions can't touch each other's physicals
+	threadPool.doInParallelChunks(partitionCount, COLISSION_RESPONSE_CHUNK_SIZE, [&](std::size_t start, std::size_t end) {
+		Debug::VisualLogRedirect redirect(logBuffers[start / COLISSION_RESPONSE_CHUNK_SIZE]);
+		for(std::size_t p = start; p < end; p++) {
+			for(std::size_t i = partition.partitionStarts[p]; i < partition.partitionStarts[p + 1]; i++) {
+				std::size_t index = partition.colissionIndices[i];
+				ColissionResponse response;
+				if(index < freePartCount) {
+					Colission c = curColissions.freePartColissions[index];
+					response = handleCollision(*c.p1, *c.p2, c.intersection, c.exitVector);
+				} else {
+					Colission c = curColissions.freeTerrainColissions[index - freePartCount];
+					response = handleTerrainCollision(*c.p1, *c.p2, c.intersection, c.exitVector);
+				}
+				if(events.enabled) {
+					responses[index] = response;
+				}
+			}
+		}
+	});
+
+	for(Debug::VisualLogBuffer& buffer : logBuffers) {
+		buffer.flush();
+	}
+
+	if(events.enabled) {
+		for(std::size_t i = 0; i < freePartCount; i++) {
+			events.recordColission(curColissions.freePartColissions[i], responses[i], world.deltaT);
+		}
+		for(std::size_t i = 0; i < curColissions.freeTerrainColissions.size(); i++) {
+			events.recordColission(curColissions.freeTerrainColissions[i], responses[freePartCount + i], world.deltaT);
+		}
+		events.finishTick();
+	}
+}
+
 void handleConstraints(WorldPrototype& world) {
 	for(const ConstraintGroup& group : world.constraints) {
+		if(world.useSleeping && isConstraintGroupAsleep(group)) continue;
 		group.apply();
 	}
 }
+void updatePhysicalsParallel(const std::vector<MotorizedPhysical*>& physicals, double deltaT, ThreadPool& threadPool) {
+	threadPool.doInParallelChunks(physicals.size(), PHYSICAL_UPDATE_CHUNK_SIZE, [&physicals, deltaT](std::size_t start, std::size_t end) {
+		for(std::size_t i = start; i < end; i++) {
+			physicals[i]->update(deltaT);
+		}
+	});
+}
+
 void update(WorldPrototype& world) {
-	for(MotorizedPhysical* physical : world.physicals) {
-		physical->update(world.deltaT);
-	}
+	ThreadPool singleThreadPool(1);
+	update(world, singleThreadPool);
+}
 
-	for(ColissionLayer& layer : world.layers) {
-		layer.refresh();
+void update(WorldPrototype& world, ThreadPool& threadPool) {
+	const std::vector<MotorizedPhysical*>* physicalsToUpdate = &world.physicals;
+	if(world.useSleeping) {
+		world.awakePhysicals.clear();
+		for(MotorizedPhysical* phys : world.physicals) {
+			if(!phys->isAsleep) {
+				world.awakePhysicals.push_back(phys);
+			}
+		}
+		physicalsToUpdate = &world.awakePhysicals;
 	}
+	if(world.useSingleBodyStore) {
+		world.singleBodyStore.update(*physicalsToUpdate, world.deltaT, threadPool);
+	} else {
+		updatePhysicalsParallel(*physicalsToUpdate, world.deltaT, threadPool);
+	}
+
+	// layers are independent, but bounds must be correct before the structure of a tree can be improved
+	physicsMeasure.mark(PhysicsProcess::UPDATE_TREE_BOUNDS);
+	threadPool.doInParallelChunks(world.layers.size(), 1, [&world](std::size_t start, std::size_t end) {
+		for(std::size_t i = start; i < end; i++) {
+			world.layers[i].recalculateBounds();
+		}
+	});
+	physicsMeasure.mark(PhysicsProcess::UPDATE_TREE_STRUCTURE);
+	threadPool.doInParallelChunks(world.layers.size(), 1, [&world](std::size_t start, std::size_t end) {
+		for(std::size_t i = start; i < end; i++) {
+			world.layers[i].improveStructure();
+		}
+	});
 	world.age++;
 
+	physicsMeasure.mark(PhysicsProcess::UPDATING);
+	if(world.useSleeping) {
+		updateSleepingIslands(world);
+	}
 	for(SoftLink* springLink : world.softLinks) {
+		if(world.useSleeping && isSoftLinkAsleep(*springLink)) continue;
 		springLink->update();
 	}
 }
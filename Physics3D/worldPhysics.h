@@ -9,17 +9,26 @@
 #include "threading/upgradeableMutex.h"
 
 namespace P3D {
-void handleCollision(Part& part1, Part& part2, Position collisionPoint, Vec3 exitVector);
-void handleTerrainCollision(Part& part1, Part& part2, Position collisionPoint, Vec3 exitVector);
+ColissionResponse handleCollision(Part& part1, Part& part2, Position collisionPoint, Vec3 exitVector);
+ColissionResponse handleTerrainCollision(Part& part1, Part& part2, Position collisionPoint, Vec3 exitVector);
 PartIntersection safeIntersects(const Part& p1, const Part& p2);
 void refineColissions(std::vector<Colission>& colissions);
 void parallelRefineColissions(ThreadPool& threadPool, std::vector<Colission>& colissions);
+// same as parallelRefineColissions, but the remaining colissions keep their order regardless of the number of threads
+void parallelRefineColissionsOrdered(ThreadPool& threadPool, std::vector<Colission>& colissions);
 void findColissions(WorldPrototype& world, ColissionBuffer& curColissions);
 void findColissionsParallel(WorldPrototype& world, ColissionBuffer& curColissions, ThreadPool& threadPool);
 void applyExternalForces(WorldPrototype& world);
 void handleColissions(ColissionBuffer& curColissions);
+// same as handleColissions, but also records the colissions and their responses into events if it is enabled
+void handleColissions(ColissionBuffer& curColissions, ColissionEventStream& events, double deltaT);
+// handles the colissions of unconnected physicals on all threads of the pool, with the exact same result as handleColissions
+void handleColissionsParallel(WorldPrototype& world, ThreadPool& threadPool);
 void handleConstraints(WorldPrototype& world);
+// physicals are independent during integration, so they are updated in chunks on all threads of the pool
+void updatePhysicalsParallel(const std::vector<MotorizedPhysical*>& physicals, double deltaT, ThreadPool& threadPool);
 void update(WorldPrototype& world);
+void update(WorldPrototype& world, ThreadPool& threadPool);
 
 void tickWorldUnsynchronized(WorldPrototype& world, ThreadPool& threadPool);
 void tickWorldSynchronized(WorldPrototype& world, ThreadPool& threadPool, UpgradeableMutex& worldMutex);
@@ -0,0 +1,136 @@
+#include "worldSnapshot.h"
+
+#include "world.h"
+#include "worldIteration.h"
+#include "part.h"
+
+#include <utility>
+#include <assert.h>
+
+namespace P3D {
+WorldSnapshotReader::~WorldSnapshotReader() {
+	release();
+}
+
+WorldSnapshotReader::WorldSnapshotReader(WorldSnapshotReader&& other) noexcept :
+	publisher(other.publisher),
+	bufferIndex(other.bufferIndex) {
+	other.publisher = nullptr;
+	other.bufferIndex = -1;
+}
+
+WorldSnapshotReader& WorldSnapshotReader::operator=(WorldSnapshotReader&& other) noexcept {
+	std::swap(publisher, other.publisher);
+	std::swap(bufferIndex, other.bufferIndex);
+	other.release();
+	return *this;
+}
+
+void WorldSnapshotReader::release() {
+	if(publisher != nullptr) {
+		publisher->readerCounts[bufferIndex].fetch_sub(1);
+		publisher = nullptr;
+		bufferIndex = -1;
+	}
+}
+
+const WorldSnapshot& WorldSnapshotReader::operator*() const {
+	assert(isValid());
+	return publisher->buffers[bufferIndex];
+}
+
+WorldSnapshotPublisher::WorldSnapshotPublisher() {
+	for(std::atomic<int>& count : readerCounts) {
+		count.store(0);
+	}
+}
+
+/*
+	A reader only keeps a buffer if latest still points to it after its count was raised
+	publish() only picks buffers that are not latest, and reads their count after latest moved away from them
+	So every reader that kept a buffer is seen by the publisher before it would write into that buffer again
+*/
+WorldSnapshotReader WorldSnapshotPublisher::acquire() {
+	while(true) {
+		int index = latest.load();
+		if(index < 0) return WorldSnapshotReader();
+		readerCounts[index].fetch_add(1);
+		if(latest.load() == index) {
+			return WorldSnapshotReader(this, index);
+		}
+		readerCounts[index].fetch_sub(1);
+	}
+}
+
+std::uint32_t WorldSnapshotPublisher::getID(Part& part) {
+	std::uint32_t id = part.snapshotID;
+	if(id < partOfID.size() && partOfID[id] == &part) return id;
+
+	if(!freeIDs.empty()) {
+		id = freeIDs.back();
+		freeIDs.pop_back();
+		partOfID[id] = &part;
+	} else {
+		id = static_cast<std::uint32_t>(partOfID.size());
+		partOfID.push_back(&part);
+	}
+	part.snapshotID = id;
+	return id;
+}
+
+void WorldSnapshotPublisher::publish(const WorldPrototype& world) {
+	int latestIndex = latest.load();
+	int target = -1;
+	for(int i = 0; i < BUFFER_COUNT; i++) {
+		if(i != latestIndex && readerCounts[i].load() == 0) {
+			target = i;
+			break;
+		}
+	}
+	if(target == -1) {
+		skippedPublishes.fetch_add(1);
+		return;
+	}
+
+	// IDs are assigned before sizing the buffer, parts seen for the first time grow partOfID
+	WorldSnapshot& snapshot = buffers[target];
+	world.forEachPart([this](Part& part) {
+		getID(part);
+	});
+	std::size_t size = partOfID.size();
+	snapshot.age = world.age;
+	snapshot.isPresent.assign(size, 0);
+	snapshot.cframes.resize(size);
+	snapshot.motions.resize(size);
+	snapshot.bounds.resize(size);
+	world.forEachPart([&snapshot](Part& part) {
+		std::uint32_t id = part.snapshotID;
+		snapshot.isPresent[id] = 1;
+		snapshot.cframes[id] = part.getCFrame();
+		snapshot.motions[id] = part.getMotion();
+		snapshot.bounds[id] = part.getBounds();
+	});
+
+	latest.store(target);
+}
+
+void WorldSnapshotPublisher::forgetPart(const Part* part) {
+	std::uint32_t id = part->snapshotID;
+	if(id < partOfID.size() && partOfID[id] == part) {
+		partOfID[id] = nullptr;
+		freeIDs.push_back(id);
+	}
+}
+
+void WorldSnapshotPublisher::notifyPartStdMoved(const Part* oldPartPtr, const Part* newPartPtr) {
+	std::uint32_t id = newPartPtr->snapshotID;
+	if(id < partOfID.size() && partOfID[id] == oldPartPtr) {
+		partOfID[id] = newPartPtr;
+	}
+}
+
+void WorldSnapshotPublisher::clear() {
+	partOfID.clear();
+	freeIDs.clear();
+}
+};
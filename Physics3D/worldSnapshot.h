@@ -0,0 +1,103 @@
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "math/globalCFrame.h"
+#include "math/bounds.h"
+#include "motion.h"
+
+// the number of snapshots that readers may hold at once without making the world skip a publish
+#define WORLD_SNAPSHOT_MAX_READERS 2
+
+namespace P3D {
+class Part;
+class WorldPrototype;
+class WorldSnapshotPublisher;
+
+/*
+	The state of every part at the end of a tick, in struct of arrays form indexed by Part::snapshotID
+	isPresent is 0 for IDs of which the part was removed, or not yet published
+	Terrain parts have a zero Motion
+*/
+struct WorldSnapshot {
+	// world.age of the tick this snapshot was published after
+	std::size_t age = 0;
+	std::vector<char> isPresent;
+	std::vector<GlobalCFrame> cframes;
+	std::vector<Motion> motions;
+	std::vector<BoundsTemplate<float>> bounds;
+
+	inline std::size_t size() const { return isPresent.size(); }
+};
+
+/*
+	Keeps the snapshot it was acquired with alive until it is destroyed or released
+	The snapshot stays unchanged for that time, no matter how many ticks are published
+*/
+class WorldSnapshotReader {
+	WorldSnapshotPublisher* publisher = nullptr;
+	int bufferIndex = -1;
+
+	friend class WorldSnapshotPublisher;
+	WorldSnapshotReader(WorldSnapshotPublisher* publisher, int bufferIndex) : publisher(publisher), bufferIndex(bufferIndex) {}
+public:
+	WorldSnapshotReader() = default;
+	~WorldSnapshotReader();
+	WorldSnapshotReader(WorldSnapshotReader&& other) noexcept;
+	WorldSnapshotReader& operator=(WorldSnapshotReader&& other) noexcept;
+	WorldSnapshotReader(const WorldSnapshotReader&) = delete;
+	WorldSnapshotReader& operator=(const WorldSnapshotReader&) = delete;
+
+	void release();
+	// false if nothing was published yet, or after release
+	inline bool isValid() const { return publisher != nullptr; }
+
+	const WorldSnapshot& operator*() const;
+	inline const WorldSnapshot* operator->() const { return &**this; }
+};
+
+/*
+	Copies the parts of the world into a WorldSnapshot at the end of every tick, for other threads to read without locking the world
+	Opt-in per world with enabled, a disabled publisher costs nothing during the tick
+
+	Readers acquire() the latest snapshot lock-free and never block the tick, the tick never waits for readers either
+	The tick writes into a buffer that is neither the latest nor held by a reader, with a single reader this is a triple buffer
+	Readers holding up to WORLD_SNAPSHOT_MAX_READERS distinct snapshots never make the tick skip a publish
+	When every buffer but the latest is held, the publish of that tick is skipped and counted in skippedPublishes
+
+	Parts get their snapshotID on their first publish, the ID of a removed part is reused by parts published later
+*/
+class WorldSnapshotPublisher {
+	static constexpr int BUFFER_COUNT = WORLD_SNAPSHOT_MAX_READERS + 2;
+
+	WorldSnapshot buffers[BUFFER_COUNT];
+	std::atomic<int> readerCounts[BUFFER_COUNT];
+	std::atomic<int> latest{-1};
+
+	std::vector<const Part*> partOfID;
+	std::vector<std::uint32_t> freeIDs;
+
+	friend class WorldSnapshotReader;
+	std::uint32_t getID(Part& part);
+public:
+	bool enabled = false;
+	std::atomic<std::size_t> skippedPublishes{0};
+
+	WorldSnapshotPublisher();
+	WorldSnapshotPublisher(const WorldSnapshotPublisher&) = delete;
+	WorldSnapshotPublisher& operator=(const WorldSnapshotPublisher&) = delete;
+
+	// called by the tick, while no other thread modifies the world
+	void publish(const WorldPrototype& world);
+	// may be called from any thread, the returned reader is invalid if nothing was published yet
+	WorldSnapshotReader acquire();
+
+	void forgetPart(const Part* part);
+	void notifyPartStdMoved(const Part* oldPartPtr, const Part* newPartPtr);
+	// forgets all part IDs, snapshots that are still held stay valid
+	void clear();
+};
+};
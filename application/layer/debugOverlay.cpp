@@ -82,6 +82,14 @@ void DebugOverlay::onRender(Engine::Registry64& registry) {
 	addDebugField(screen->dimension, GUI::font, "World Potential Energy", screen->world->getTotalPotentialEnergy(), "");
 	addDebugField(screen->dimension, GUI::font, "World Energy", screen->world->getTotalEnergy(), "");*/
 	addDebugField(screen->dimension, GUI::font, "World Age", screen->world->age, " ticks");
+	std::vector<IntersectionPair> intersectionPairs = intersectionPairStatistics.getPairs();
+	for(std::size_t i = 0; i < intersectionPairs.size() && i < 3; i++) {
+		const IntersectionPair& pair = intersectionPairs[i];
+		const IntersectionPairCounts& c = pair.counts;
+		std::string name = IntersectionPairStatistics::getClassName(pair.firstClassID) + "-" + IntersectionPairStatistics::getClassName(pair.secondClassID);
+		std::string value = std::to_string(c.calls) + " calls, " + std::to_string(100 * c.hits / c.calls) + "% hits, " + std::to_string(c.time.count() / 1000 / c.calls) + "us/call";
+		addDebugField(screen->dimension, GUI::font, name.c_str(), value, "");
+	}
 
 	if (renderPiesEnabled) {
 		float leftSide = float(screen->dimension.x) / float(screen->dimension.y);
@@ -1,14 +1,26 @@
 #include "benchmark.h"
+#include "benchmarkStatistics.h"
+#include "scalingBenchmark.h"
+#include "narrowphaseBenchmark.h"
 
 #include <chrono>
 #include <vector>
 #include <iostream>
 #include <string>
 #include <sstream>
+#include <fstream>
 
 #include "../util/terminalColor.h"
 #include "../util/parseCPUIDArgs.h"
 
+#include <Physics3D/misc/physicsProfiler.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <sched.h>
+#endif
+
 std::vector<Benchmark*>* knownBenchmarks = nullptr;
 
 Benchmark::Benchmark(const char* name) : name(name) {
@@ -46,7 +58,20 @@ std::vector<std::string> split(std::string str, char splitChar) {
 	return substrings;
 }
 
-static void runBenchmark(Benchmark* bench) {
+struct RunOptions {
+	int warmups = 0;
+	int repetitions = 1;
+};
+
+static double runTimed(Benchmark* bench) {
+	auto runStart = std::chrono::high_resolution_clock::now();
+	bench->run();
+	auto runFinish = std::chrono::high_resolution_clock::now();
+	return (runFinish - runStart).count() / 1000000.0;
+}
+
+// init is timed once, every following run is preceded by an untimed reset, the first options.warmups runs are not measured
+static BenchmarkResult runBenchmark(Benchmark* bench, const RunOptions& options) {
 	setColor(TerminalColor::CYAN);
 
 	auto createStart = std::chrono::high_resolution_clock::now();
@@ -57,17 +82,30 @@ static void runBenchmark(Benchmark* bench) {
 	setColor(TerminalColor::YELLOW);
 	std::cout << '(' << (createFinish - createStart).count() / 1000000.0 << "ms)";
 	std::cout.flush();
-	auto runStart = std::chrono::high_resolution_clock::now();
-	bench->run();
-	auto runFinish = std::chrono::high_resolution_clock::now();
-	double deltaTimeMS = (runFinish - runStart).count() / 1000000.0;
+
+	BenchmarkResult result;
+	result.name = bench->name;
+	result.warmups = options.warmups;
+	int runCount = options.warmups + options.repetitions;
+	for(int i = 0; i < runCount; i++) {
+		if(i != 0) bench->reset();
+		double deltaTimeMS = runTimed(bench);
+		if(i >= options.warmups) result.timesMS.push_back(deltaTimeMS);
+	}
+
+	SampleStatistics stats = computeStatistics(result.timesMS);
 	setColor(TerminalColor::GREEN);
-	std::cout << "  (" << deltaTimeMS << "ms)\n";
+	std::cout << "  (" << stats.median << "ms)\n";
+	if(result.timesMS.size() > 1) {
+		setColor(TerminalColor::WHITE);
+		std::cout << "  " << result.timesMS.size() << " runs: mean " << stats.mean << "ms, median " << stats.median << "ms, stddev " << stats.stddev << "ms, min " << stats.min << "ms, max " << stats.max << "ms\n";
+	}
 	std::cout.flush();
-	bench->printResults(deltaTimeMS);
+	bench->printResults(stats.median);
+	return result;
 }
 
-static void runBenchmarks(const std::vector<std::string>& benchmarks) {
+static std::vector<BenchmarkResult> runBenchmarks(const std::vector<std::string>& benchmarks, const RunOptions& options) {
 	setColor(TerminalColor::CYAN);
 	std::cout << "[NAME]";
 	setColor(TerminalColor::YELLOW);
@@ -76,20 +114,120 @@ static void runBenchmarks(const std::vector<std::string>& benchmarks) {
 	std::cout << " [RUNTIME]\n";
 	setColor(TerminalColor::WHITE);
 
+	std::vector<BenchmarkResult> results;
 	for(const std::string& c : benchmarks) {
 		Benchmark* b = getBenchFor(c);
 		if(b != nullptr) {
-			runBenchmark(b);
+			results.push_back(runBenchmark(b, options));
 		}
 	}
+	return results;
+}
+
+// pins the calling thread, and with it every thread it creates afterwards, to the given cpu
+static bool pinToCPU(int cpu) {
+#ifdef _WIN32
+	return cpu < 64 && SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu) != 0;
+#elif defined(__linux__)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+	return false;
+#endif
+}
+
+// --trace <file> writes a trace of the physics ticks, of the first --traceTicks ticks or of the slowest tick taking more than --traceSlowerThan ms
+static void setupTracing(const Util::ParsedArgs& pa) {
+	std::string tracePath = pa.getOptional("trace");
+	if(tracePath.empty()) return;
+
+	P3D::physicsTracer.outputPath = tracePath;
+	std::string traceTicks = pa.getOptional("traceTicks");
+	std::string traceSlowerThan = pa.getOptional("traceSlowerThan");
+	if(!traceSlowerThan.empty()) {
+		P3D::physicsTracer.captureTicksSlowerThan = std::chrono::nanoseconds(static_cast<long long>(std::stod(traceSlowerThan) * 1000000.0));
+	}
+	if(!traceTicks.empty()) {
+		P3D::physicsTracer.captureAfterTicks = std::stoul(traceTicks);
+	} else if(traceSlowerThan.empty()) {
+		P3D::physicsTracer.captureAfterTicks = 100;
+	}
+	P3D::physicsTracer.enabled = true;
+	std::cout << "Tracing physics ticks to " << tracePath << "\n";
+}
+
+// configures the strongScaling and weakScaling benchmarks, see ScalingOptions
+// --scaling <file> writes their runs as JSON, --scalingParts, --scalingThreads and --scalingScenes take comma separated lists, --scalingTicks a tick count
+static void setupScaling(const Util::ParsedArgs& pa) {
+	P3D::scalingOptions.outputPath = pa.getOptional("scaling");
+	std::string parts = pa.getOptional("scalingParts");
+	if(!parts.empty()) {
+		P3D::scalingOptions.partCounts.clear();
+		for(const std::string& count : split(parts + ",", ',')) P3D::scalingOptions.partCounts.push_back(std::stoul(count));
+	}
+	std::string threads = pa.getOptional("scalingThreads");
+	if(!threads.empty()) {
+		P3D::scalingOptions.threadCounts.clear();
+		for(const std::string& count : split(threads + ",", ',')) P3D::scalingOptions.threadCounts.push_back(std::stoul(count));
+	}
+	std::string scenes = pa.getOptional("scalingScenes");
+	if(!scenes.empty()) {
+		P3D::scalingOptions.scenes.clear();
+		for(const std::string& name : split(scenes + ",", ',')) {
+			for(int i = 0; i < static_cast<int>(P3D::ScalingScene::COUNT); i++) {
+				if(name == P3D::getScalingSceneName(static_cast<P3D::ScalingScene>(i))) P3D::scalingOptions.scenes.push_back(static_cast<P3D::ScalingScene>(i));
+			}
+		}
+	}
+	std::string ticks = pa.getOptional("scalingTicks");
+	if(!ticks.empty()) P3D::scalingOptions.tickCount = std::stoi(ticks);
+}
+
+// --narrowphase <file> writes the results of the narrowphase benchmark as CSV
+// --narrowphaseCases takes a comma separated list of .nativeParts files written by Debug::saveIntersectionError, added to its corpus
+static void setupNarrowphase(const Util::ParsedArgs& pa) {
+	P3D::narrowphaseOptions.outputPath = pa.getOptional("narrowphase");
+	std::string caseFiles = pa.getOptional("narrowphaseCases");
+	if(!caseFiles.empty()) {
+		for(const std::string& fileName : split(caseFiles + ",", ',')) P3D::narrowphaseOptions.caseFiles.push_back(fileName);
+	}
 }
 
 int main(int argc, const char** args) {
 	Util::ParsedArgs pa(argc, args);
 	std::cout << Util::printAndParseCPUIDArgs(pa).c_str() << "\n";
+	setupTracing(pa);
+	setupScaling(pa);
+	setupNarrowphase(pa);
+	// -counters attributes hardware counter readings to the physics processes, exported with --latency
+	if(pa.hasFlag("counters")) P3D::physicsMeasure.hardwareCountersEnabled = true;
 
+	// --warmup <n> unmeasured runs followed by --repetitions <n> measured runs of every benchmark
+	RunOptions options;
+	std::string warmups = pa.getOptional("warmup");
+	std::string repetitions = pa.getOptional("repetitions");
+	if(!warmups.empty()) options.warmups = std::stoi(warmups);
+	if(!repetitions.empty() && std::stoi(repetitions) >= 1) options.repetitions = std::stoi(repetitions);
+
+	// --pin <cpu> keeps the benchmarks and the threads they start on one cpu
+	int pinnedCPU = -1;
+	std::string pin = pa.getOptional("pin");
+	if(!pin.empty()) {
+		if(pinToCPU(std::stoi(pin))) {
+			pinnedCPU = std::stoi(pin);
+			std::cout << "Pinned to cpu " << pinnedCPU << "\n";
+		} else {
+			setColor(TerminalColor::RED);
+			std::cout << "Could not pin to cpu " << pin << "\n";
+			setColor(TerminalColor::WHITE);
+		}
+	}
+
+	std::vector<BenchmarkResult> results;
 	if(pa.argCount() >= 1) {
-		runBenchmarks(pa.args());
+		results = runBenchmarks(pa.args(), options);
 	} else {
 		setColor(TerminalColor::WHITE);
 		std::cout << "The following benchmarks are available:\n";
@@ -112,7 +250,48 @@ int main(int argc, const char** args) {
 
 		std::vector<std::string> commands = split(cmd, ';');
 
-		runBenchmarks(commands);
+		results = runBenchmarks(commands, options);
+	}
+
+	// --latency <file> writes the tick and process latency percentiles of all benchmarks run, as JSON if file ends with .json, CSV otherwise
+	std::string latencyPath = pa.getOptional("latency");
+	if(!latencyPath.empty() && P3D::physicsMeasure.saveLatency(latencyPath)) {
+		std::cout << "Saved tick latencies to " << latencyPath << "\n";
+	}
+	// --pairs <file> writes the narrowphase statistics per pair of shape classes of the last benchmark run, as CSV
+	std::string pairsPath = pa.getOptional("pairs");
+	if(!pairsPath.empty()) {
+		std::ofstream pairsFile(pairsPath);
+		P3D::intersectionPairStatistics.writeCSV(pairsFile);
+		std::cout << "Saved intersection pair statistics to " << pairsPath << "\n";
+	}
+	// --json <file> writes every measured run time and its statistics
+	std::string jsonPath = pa.getOptional("json");
+	if(!jsonPath.empty()) {
+		std::ofstream jsonFile(jsonPath);
+		writeResultsJSON(jsonFile, results, pinnedCPU);
+		std::cout << "Saved benchmark results to " << jsonPath << "\n";
+	}
+	// --compare <baseline.json> compares with the results of an earlier --json run, fails if any benchmark got significantly slower
+	// --threshold <percent> is the smallest change in median that counts, 2% by default
+	std::string comparePath = pa.getOptional("compare");
+	if(!comparePath.empty()) {
+		std::ifstream baselineFile(comparePath);
+		if(!baselineFile) {
+			setColor(TerminalColor::RED);
+			std::cout << "Could not open baseline " << comparePath << "\n";
+			setColor(TerminalColor::WHITE);
+			return 2;
+		}
+		std::string threshold = pa.getOptional("threshold");
+		double minRelativeChange = threshold.empty() ? 0.02 : std::stod(threshold) / 100.0;
+		int regressions = compareResults(readResultsJSON(baselineFile), results, 0.05, minRelativeChange);
+		if(regressions != 0) {
+			setColor(TerminalColor::RED);
+			std::cout << regressions << " significant regression(s)\n";
+			setColor(TerminalColor::WHITE);
+			return 1;
+		}
 	}
 
 	return 0;
@@ -6,6 +6,8 @@ public:
 	Benchmark(const char* name);
 	virtual ~Benchmark() {}
 	virtual void init() {}
+	// called untimed before every run after the first, when a benchmark is repeated
+	virtual void reset() {}
 	virtual void run() = 0;
 	virtual void printResults(double timeTaken) {}
 };
@@ -0,0 +1,178 @@
+#include "benchmarkStatistics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+#include <thread>
+
+#include "../util/terminalColor.h"
+
+SampleStatistics computeStatistics(const std::vector<double>& samples) {
+	SampleStatistics result;
+	if(samples.empty()) return result;
+
+	std::vector<double> sorted = samples;
+	std::sort(sorted.begin(), sorted.end());
+	std::size_t count = sorted.size();
+
+	double sum = 0.0;
+	for(double s : sorted) sum += s;
+	result.mean = sum / count;
+	result.median = (count % 2 == 1) ? sorted[count / 2] : (sorted[count / 2 - 1] + sorted[count / 2]) / 2.0;
+	result.min = sorted.front();
+	result.max = sorted.back();
+	if(count >= 2) {
+		double sumOfSquares = 0.0;
+		for(double s : sorted) sumOfSquares += (s - result.mean) * (s - result.mean);
+		result.stddev = std::sqrt(sumOfSquares / (count - 1));
+	}
+	return result;
+}
+
+static void writeEscaped(std::ostream& out, const std::string& str) {
+	for(char c : str) {
+		if(c == '"' || c == '\\') out << '\\';
+		out << c;
+	}
+}
+
+void writeResultsJSON(std::ostream& out, const std::vector<BenchmarkResult>& results, int pinnedCPU) {
+	out.precision(6);
+	out << "{\n\"context\":{\"hardwareConcurrency\":" << std::thread::hardware_concurrency() << ",\"pinnedCPU\":" << pinnedCPU << "},\n\"benchmarks\":[";
+	bool isFirst = true;
+	for(const BenchmarkResult& result : results) {
+		SampleStatistics stats = computeStatistics(result.timesMS);
+		if(!isFirst) out << ',';
+		isFirst = false;
+		out << "\n{\"name\":\"";
+		writeEscaped(out, result.name);
+		out << "\",\"warmups\":" << result.warmups << ",\"repetitions\":" << result.timesMS.size();
+		out << ",\"mean_ms\":" << stats.mean << ",\"median_ms\":" << stats.median << ",\"stddev_ms\":" << stats.stddev << ",\"min_ms\":" << stats.min << ",\"max_ms\":" << stats.max;
+		out << ",\"times_ms\":[";
+		for(std::size_t i = 0; i < result.timesMS.size(); i++) {
+			if(i != 0) out << ',';
+			out << result.timesMS[i];
+		}
+		out << "]}";
+	}
+	out << "\n]}\n";
+}
+
+// reads the string value after key, starting at pos, and moves pos past it
+static bool readStringField(const std::string& json, const char* key, std::size_t& pos, std::string& value) {
+	std::string pattern = std::string("\"") + key + "\":\"";
+	std::size_t start = json.find(pattern, pos);
+	if(start == std::string::npos) return false;
+	std::size_t cur = start + pattern.size();
+	value.clear();
+	while(cur < json.size() && json[cur] != '"') {
+		if(json[cur] == '\\' && cur + 1 < json.size()) cur++;
+		value += json[cur];
+		cur++;
+	}
+	pos = cur;
+	return true;
+}
+
+std::vector<BenchmarkResult> readResultsJSON(std::istream& in) {
+	std::stringstream buffer;
+	buffer << in.rdbuf();
+	std::string json = buffer.str();
+
+	std::vector<BenchmarkResult> results;
+	std::size_t pos = 0;
+	BenchmarkResult result;
+	while(readStringField(json, "name", pos, result.name)) {
+		std::size_t warmupsPos = json.find("\"warmups\":", pos);
+		std::size_t timesPos = json.find("\"times_ms\":[", pos);
+		if(timesPos == std::string::npos) break;
+		result.warmups = (warmupsPos != std::string::npos && warmupsPos < timesPos) ? std::atoi(json.c_str() + warmupsPos + 10) : 0;
+		std::size_t timesEnd = json.find(']', timesPos);
+		std::stringstream times(json.substr(timesPos + 12, timesEnd - timesPos - 12));
+		result.timesMS.clear();
+		std::string time;
+		while(std::getline(times, time, ',')) {
+			if(!time.empty()) result.timesMS.push_back(std::stod(time));
+		}
+		results.push_back(result);
+		pos = timesEnd;
+	}
+	return results;
+}
+
+double mannWhitneyPValue(const std::vector<double>& first, const std::vector<double>& second) {
+	std::size_t n1 = first.size();
+	std::size_t n2 = second.size();
+	if(n1 < 2 || n2 < 2) return 1.0;
+
+	struct RankedValue {
+		double value;
+		bool isFirst;
+	};
+	std::vector<RankedValue> values;
+	for(double v : first) values.push_back(RankedValue{v, true});
+	for(double v : second) values.push_back(RankedValue{v, false});
+	std::sort(values.begin(), values.end(), [](const RankedValue& a, const RankedValue& b) { return a.value < b.value; });
+
+	// tied values share the average of their ranks
+	double rankSumFirst = 0.0;
+	double tieCorrection = 0.0;
+	std::size_t n = values.size();
+	for(std::size_t i = 0; i < n;) {
+		std::size_t j = i;
+		while(j < n && values[j].value == values[i].value) j++;
+		double averageRank = (i + 1 + j) / 2.0;
+		for(std::size_t k = i; k < j; k++) {
+			if(values[k].isFirst) rankSumFirst += averageRank;
+		}
+		double tieSize = static_cast<double>(j - i);
+		tieCorrection += tieSize * tieSize * tieSize - tieSize;
+		i = j;
+	}
+
+	double u = rankSumFirst - n1 * (n1 + 1) / 2.0;
+	double mean = n1 * n2 / 2.0;
+	double variance = n1 * n2 / 12.0 * ((n + 1) - tieCorrection / (static_cast<double>(n) * (n - 1)));
+	if(variance <= 0.0) return 1.0;
+	// continuity correction
+	double difference = std::abs(u - mean) - 0.5;
+	if(difference < 0.0) difference = 0.0;
+	double z = difference / std::sqrt(variance);
+	return std::erfc(z / std::sqrt(2.0));
+}
+
+int compareResults(const std::vector<BenchmarkResult>& baseline, const std::vector<BenchmarkResult>& current, double alpha, double minRelativeChange) {
+	int regressions = 0;
+	setColor(TerminalColor::WHITE);
+	std::cout << "\n[Comparison with baseline]\n";
+	for(const BenchmarkResult& cur : current) {
+		auto base = std::find_if(baseline.begin(), baseline.end(), [&cur](const BenchmarkResult& b) { return b.name == cur.name; });
+		if(base == baseline.end()) {
+			setColor(TerminalColor::WHITE);
+			std::cout << cur.name << ": not in baseline\n";
+			continue;
+		}
+		double baseMedian = computeStatistics(base->timesMS).median;
+		double curMedian = computeStatistics(cur.timesMS).median;
+		double relativeChange = baseMedian == 0.0 ? 0.0 : (curMedian - baseMedian) / baseMedian;
+		double p = mannWhitneyPValue(base->timesMS, cur.timesMS);
+		bool isSignificant = p < alpha && std::abs(relativeChange) > minRelativeChange;
+
+		if(isSignificant && relativeChange > 0.0) {
+			setColor(TerminalColor::RED);
+			regressions++;
+		} else if(isSignificant) {
+			setColor(TerminalColor::GREEN);
+		} else {
+			setColor(TerminalColor::WHITE);
+		}
+		std::cout << cur.name << ": " << baseMedian << "ms -> " << curMedian << "ms (" << (relativeChange >= 0.0 ? "+" : "") << relativeChange * 100.0 << "%, p=" << p << ")";
+		if(isSignificant) std::cout << (relativeChange > 0.0 ? " REGRESSION" : " improvement");
+		if(base->timesMS.size() < 4 || cur.timesMS.size() < 4) std::cout << " (too few repetitions to be significant)";
+		std::cout << "\n";
+	}
+	setColor(TerminalColor::WHITE);
+	return regressions;
+}
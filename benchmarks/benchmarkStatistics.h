@@ -0,0 +1,40 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <istream>
+#include <ostream>
+
+struct BenchmarkResult {
+	std::string name;
+	int warmups = 0;
+	// wall time of every measured run
+	std::vector<double> timesMS;
+};
+
+struct SampleStatistics {
+	double mean = 0.0;
+	double median = 0.0;
+	// sample standard deviation, 0 for less than two samples
+	double stddev = 0.0;
+	double min = 0.0;
+	double max = 0.0;
+};
+
+SampleStatistics computeStatistics(const std::vector<double>& samples);
+
+// pinnedCPU is -1 when the benchmarks were not pinned
+void writeResultsJSON(std::ostream& out, const std::vector<BenchmarkResult>& results, int pinnedCPU);
+// reads the results written by writeResultsJSON, other JSON is not supported
+std::vector<BenchmarkResult> readResultsJSON(std::istream& in);
+
+// two sided p-value of the Mann-Whitney U test, using the normal approximation with tie correction
+// 1 when either sample has less than two values
+double mannWhitneyPValue(const std::vector<double>& first, const std::vector<double>& second);
+
+/*
+	Prints the change in median time of every benchmark that is in both current and baseline
+	A change is significant when the Mann-Whitney p-value is below alpha and the medians differ by more than minRelativeChange
+	Returns the number of significant regressions
+*/
+int compareResults(const std::vector<BenchmarkResult>& baseline, const std::vector<BenchmarkResult>& current, double alpha, double minRelativeChange);
@@ -36,6 +36,10 @@ public:
 		}
 	}
 
+	void reset() override {
+		errors = 0;
+	}
+
 	void printResults(double timeTaken) override {
 		Log::error("Amount of errors: %d\n", errors);
 	}
@@ -70,6 +74,10 @@ public:
 		}
 	}
 
+	void reset() override {
+		errors = 0;
+	}
+
 	void printResults(double timeTaken) override {
 		Log::error("Amount of errors: %d\n", errors);
 	}
@@ -104,6 +112,10 @@ public:
 		}
 	}
 
+	void reset() override {
+		errors = 0;
+	}
+
 	void printResults(double timeTaken) override {
 		Log::error("Amount of errors: %d\n", errors);
 	}
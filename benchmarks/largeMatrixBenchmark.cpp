@@ -0,0 +1,147 @@
+#include "benchmark.h"
+
+#include <Physics3D/math/linalg/largeMatrix.h>
+#include <Physics3D/math/linalg/largeMatrixAlgorithms.h>
+#include <Physics3D/math/mathUtil.h>
+#include "../util/log.h"
+
+#include <vector>
+#include <cmath>
+
+namespace P3D {
+#define GEMM_BENCH_SIZE 384
+#define GEMM_BENCH_ROUNDS 10
+#define SOLVE_BENCH_SIZE 500
+#define SOLVE_BENCH_ROUNDS 10
+
+static LargeMatrix<double> createBenchmarkMatrix(std::size_t size) {
+	LargeMatrix<double> result(size, size);
+	for(double& d : result) d = fRand(-1.0, 1.0);
+	return result;
+}
+
+static void printGFlops(double flopCount, double timeTakenMS) {
+	Log::print("%.3f GFLOP/s\n", flopCount / (timeTakenMS * 1000000.0));
+}
+
+class NaiveMatrixMultiplyBenchmark : public Benchmark {
+	LargeMatrix<double> a, b, result;
+public:
+	NaiveMatrixMultiplyBenchmark() : Benchmark("naiveMatrixMultiply") {}
+
+	void init() override {
+		a = createBenchmarkMatrix(GEMM_BENCH_SIZE);
+		b = createBenchmarkMatrix(GEMM_BENCH_SIZE);
+		result = LargeMatrix<double>(GEMM_BENCH_SIZE, GEMM_BENCH_SIZE);
+	}
+	void run() override {
+		for(int round = 0; round < GEMM_BENCH_ROUNDS; round++) {
+			inMemoryMatrixMultiply(a, b, result);
+		}
+	}
+	void printResults(double timeTaken) override {
+		printGFlops(2.0 * GEMM_BENCH_SIZE * GEMM_BENCH_SIZE * GEMM_BENCH_SIZE * GEMM_BENCH_ROUNDS, timeTaken);
+	}
+} naiveMatrixMultiplyBench;
+
+class DenseMatrixMultiplyBenchmark : public Benchmark {
+	LargeMatrix<double> a, b, result;
+public:
+	DenseMatrixMultiplyBenchmark() : Benchmark("denseMatrixMultiply") {}
+
+	void init() override {
+		a = createBenchmarkMatrix(GEMM_BENCH_SIZE);
+		b = createBenchmarkMatrix(GEMM_BENCH_SIZE);
+		result = LargeMatrix<double>(GEMM_BENCH_SIZE, GEMM_BENCH_SIZE);
+	}
+	void run() override {
+		for(int round = 0; round < GEMM_BENCH_ROUNDS; round++) {
+			denseMatrixMultiply(a, b, result);
+		}
+	}
+	void printResults(double timeTaken) override {
+		printGFlops(2.0 * GEMM_BENCH_SIZE * GEMM_BENCH_SIZE * GEMM_BENCH_SIZE * GEMM_BENCH_ROUNDS, timeTaken);
+	}
+} denseMatrixMultiplyBench;
+
+// LU solve flop count is 2/3 n^3 for the decomposition plus 2 n^2 for the substitutions
+static double solveFlops(double size) {
+	return (2.0 / 3.0 * size * size * size + 2.0 * size * size) * SOLVE_BENCH_ROUNDS;
+}
+
+// the solves work in place, so every run starts from a fresh copy of the same systems
+class SolveBenchmark : public Benchmark {
+	std::vector<LargeMatrix<double>> originalSystems;
+	std::vector<LargeVector<double>> originalVectors;
+protected:
+	std::vector<LargeMatrix<double>> systems;
+	std::vector<LargeVector<double>> vectors;
+public:
+	SolveBenchmark(const char* name) : Benchmark(name) {}
+
+	void init() override {
+		for(int round = 0; round < SOLVE_BENCH_ROUNDS; round++) {
+			originalSystems.push_back(createBenchmarkMatrix(SOLVE_BENCH_SIZE));
+			LargeVector<double> v(SOLVE_BENCH_SIZE);
+			for(std::size_t i = 0; i < SOLVE_BENCH_SIZE; i++) v[i] = fRand(-1.0, 1.0);
+			originalVectors.push_back(v);
+		}
+		reset();
+	}
+	void reset() override {
+		systems = originalSystems;
+		vectors = originalVectors;
+	}
+	void printResults(double timeTaken) override {
+		printGFlops(solveFlops(SOLVE_BENCH_SIZE), timeTaken);
+	}
+};
+
+class NaiveSolveBenchmark : public SolveBenchmark {
+public:
+	NaiveSolveBenchmark() : SolveBenchmark("naiveSolve") {}
+
+	void run() override {
+		// the unblocked scalar elimination that destructiveSolve used before the dense kernels
+		for(int round = 0; round < SOLVE_BENCH_ROUNDS; round++) {
+			LargeMatrix<double>& m = systems[round];
+			LargeVector<double>& v = vectors[round];
+			std::size_t size = v.n;
+			for(std::size_t i = 0; i < size; i++) {
+				std::size_t bestPivotIndex = i;
+				for(std::size_t j = i + 1; j < size; j++) {
+					if(std::abs(m(j, i)) > std::abs(m(bestPivotIndex, i))) bestPivotIndex = j;
+				}
+				if(bestPivotIndex != i) {
+					swapRows(m, bestPivotIndex, i);
+					swapRows(v, bestPivotIndex, i);
+				}
+				for(std::size_t j = i + 1; j < size; j++) {
+					double factor = m(j, i) / m(i, i);
+					for(std::size_t k = i; k < size; k++) {
+						m(j, k) -= m(i, k) * factor;
+					}
+					subtractRowsFactorTimes(v, j, i, factor);
+				}
+			}
+			for(signed long long i = size - 1; i >= 0; i--) {
+				multiplyRowBy(v, i, 1 / m(i, i));
+				for(signed long long j = i - 1; j >= 0; j--) {
+					subtractRowsFactorTimes(v, j, i, m(j, i));
+				}
+			}
+		}
+	}
+} naiveSolveBench;
+
+class DenseSolveBenchmark : public SolveBenchmark {
+public:
+	DenseSolveBenchmark() : SolveBenchmark("denseSolve") {}
+
+	void run() override {
+		for(int round = 0; round < SOLVE_BENCH_ROUNDS; round++) {
+			destructiveSolve(systems[round], vectors[round]);
+		}
+	}
+} denseSolveBench;
+};
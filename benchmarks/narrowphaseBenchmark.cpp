@@ -0,0 +1,179 @@
+#include "narrowphaseBenchmark.h"
+
+#include "benchmark.h"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <cstddef>
+
+#include "../util/log.h"
+#include "../util/terminalColor.h"
+
+#include <Physics3D/part.h>
+#include <Physics3D/geometry/shape.h>
+#include <Physics3D/geometry/shapeClass.h>
+#include <Physics3D/geometry/shapeCreation.h>
+#include <Physics3D/geometry/shapeLibrary.h>
+#include <Physics3D/geometry/intersection.h>
+#include <Physics3D/geometry/genericIntersection.h>
+#include <Physics3D/misc/serialization/serialization.h>
+
+namespace P3D {
+NarrowphaseOptions narrowphaseOptions;
+
+struct NarrowphaseCase {
+	std::string name;
+	Shape first;
+	Shape second;
+	// second relative to first
+	CFrame relativeTransform;
+};
+
+struct NarrowphaseResult {
+	double nanosecondsPerCall;
+	bool isHit;
+	int gjkIterations;
+	int epaIterations;
+};
+
+struct NamedShape {
+	const char* name;
+	Shape shape;
+};
+
+static std::vector<NamedShape> createCorpusShapes() {
+	return std::vector<NamedShape>{
+		NamedShape{"Cube", boxShape(1.0, 1.0, 1.0)},
+		NamedShape{"Sphere", sphereShape(0.5)},
+		NamedShape{"Cylinder", cylinderShape(0.5, 1.0)},
+		NamedShape{"Wedge", wedgeShape(1.0, 1.0, 1.0)},
+		NamedShape{"Corner", cornerShape(1.0, 1.0, 1.0)},
+		NamedShape{"Polyhedron8", polyhedronShape(ShapeLibrary::createBox(1.0f, 1.0f, 1.0f))},
+		NamedShape{"Polyhedron64", polyhedronShape(ShapeLibrary::createPrism(32, 0.5f, 1.0f))},
+		NamedShape{"Polyhedron512", polyhedronShape(ShapeLibrary::createPrism(256, 0.5f, 1.0f))}
+	};
+}
+
+// second is offset along a direction that is not aligned with any axis, and rotated so no faces line up
+static CFrame getCorpusTransform(double distance) {
+	return CFrame(normalize(Vec3(1.0, 0.7, 0.4)) * distance, Rotation::fromEulerAngles(0.3, 0.5, 0.2));
+}
+
+// the distance at which the shapes start touching, shapes centered on each other always intersect
+static double findTouchingDistance(const Shape& first, const Shape& second) {
+	double inside = 0.0;
+	double outside = 20.0;
+	for(int i = 0; i < 40; i++) {
+		double middle = (inside + outside) / 2;
+		if(intersectsTransformed(first, second, getCorpusTransform(middle))) {
+			inside = middle;
+		} else {
+			outside = middle;
+		}
+	}
+	return outside;
+}
+
+static void addCorpusCases(std::vector<NarrowphaseCase>& cases) {
+	std::vector<NamedShape> shapes = createCorpusShapes();
+	for(std::size_t i = 0; i < shapes.size(); i++) {
+		for(std::size_t j = i; j < shapes.size(); j++) {
+			std::string pairName = std::string(shapes[i].name) + "-" + shapes[j].name;
+			double touchingDistance = findTouchingDistance(shapes[i].shape, shapes[j].shape);
+			cases.push_back(NarrowphaseCase{pairName + " colliding", shapes[i].shape, shapes[j].shape, getCorpusTransform(touchingDistance * 0.8)});
+			cases.push_back(NarrowphaseCase{pairName + " near-miss", shapes[i].shape, shapes[j].shape, getCorpusTransform(touchingDistance * 1.02)});
+			cases.push_back(NarrowphaseCase{pairName + " far", shapes[i].shape, shapes[j].shape, getCorpusTransform(touchingDistance + 10.0)});
+		}
+	}
+}
+
+static bool addCaseFromFile(std::vector<NarrowphaseCase>& cases, const std::string& fileName) {
+	std::ifstream file(fileName, std::ios::binary);
+	if(!file) return false;
+
+	DeSerializationSessionPrototype session;
+	std::vector<Part*> parts = session.deserializeParts(file);
+	bool isValid = parts.size() == 2;
+	if(isValid) {
+		cases.push_back(NarrowphaseCase{fileName, parts[0]->hitbox, parts[1]->hitbox, parts[0]->getCFrame().globalToLocal(parts[1]->getCFrame())});
+	}
+	for(Part* part : parts) {
+		delete part;
+	}
+	return isValid;
+}
+
+// repeats the call in ever larger batches until a batch takes at least 2ms
+// calls the ShapeClass overload directly, the Shape overload adds the timing and statistics of P3D_PROFILING
+static NarrowphaseResult measureCase(const NarrowphaseCase& c) {
+	const ShapeClass& firstClass = *c.first.baseShape;
+	const ShapeClass& secondClass = *c.second.baseShape;
+
+	NarrowphaseResult result;
+	lastIntersectionIterations = IntersectionIterations{};
+	result.isHit = intersectsTransformed(firstClass, secondClass, c.relativeTransform, c.first.scale, c.second.scale).has_value();
+	result.gjkIterations = lastIntersectionIterations.gjk;
+	result.epaIterations = lastIntersectionIterations.epa;
+
+	for(std::size_t batchSize = 16; ; batchSize *= 2) {
+		auto start = std::chrono::high_resolution_clock::now();
+		for(std::size_t i = 0; i < batchSize; i++) {
+			intersectsTransformed(firstClass, secondClass, c.relativeTransform, c.first.scale, c.second.scale);
+		}
+		std::chrono::nanoseconds timeTaken = std::chrono::high_resolution_clock::now() - start;
+		if(timeTaken >= std::chrono::milliseconds(2)) {
+			result.nanosecondsPerCall = static_cast<double>(timeTaken.count()) / batchSize;
+			break;
+		}
+	}
+	return result;
+}
+
+class NarrowphaseBenchmark : public Benchmark {
+	std::vector<NarrowphaseCase> cases;
+	std::vector<NarrowphaseResult> results;
+
+public:
+	NarrowphaseBenchmark() : Benchmark("narrowphase") {}
+
+	virtual void init() override {
+		cases.clear();
+		addCorpusCases(cases);
+		for(const std::string& fileName : narrowphaseOptions.caseFiles) {
+			if(!addCaseFromFile(cases, fileName)) {
+				Log::print("Could not load a pair of parts from %s\n", fileName.c_str());
+			}
+		}
+	}
+
+	virtual void run() override {
+		results.clear();
+		for(const NarrowphaseCase& c : cases) {
+			results.push_back(measureCase(c));
+		}
+	}
+
+	virtual void printResults(double) override {
+		setColor(TerminalColor::MAGENTA);
+		std::cout << "\n[Narrowphase]\n";
+		setColor(TerminalColor::WHITE);
+		Log::print("%-40s %12s %5s %5s %5s\n", "case", "ns/call", "hit", "GJK", "EPA");
+		for(std::size_t i = 0; i < cases.size(); i++) {
+			const NarrowphaseResult& r = results[i];
+			Log::print("%-40s %12.1f %5s %5d %5d\n", cases[i].name.c_str(), r.nanosecondsPerCall, r.isHit ? "yes" : "no", r.gjkIterations, r.epaIterations);
+		}
+
+		if(!narrowphaseOptions.outputPath.empty()) {
+			std::ofstream file(narrowphaseOptions.outputPath);
+			file << "case,ns_per_call,hit,gjk_iterations,epa_iterations\n";
+			for(std::size_t i = 0; i < cases.size(); i++) {
+				const NarrowphaseResult& r = results[i];
+				file << cases[i].name << ',' << r.nanosecondsPerCall << ',' << r.isHit << ',' << r.gjkIterations << ',' << r.epaIterations << '\n';
+			}
+			std::cout << "Saved narrowphase results to " << narrowphaseOptions.outputPath << "\n";
+		}
+	}
+} narrowphaseBench;
+};
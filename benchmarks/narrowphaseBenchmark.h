@@ -0,0 +1,19 @@
+#pragma once
+
+#include <vector>
+#include <string>
+
+namespace P3D {
+/*
+	Configures the narrowphase benchmark, which times intersectsTransformed on a fixed corpus of shape pairs
+	The corpus has a colliding, a near-miss and a far separated case for every pair of the builtin shape classes and of polyhedra of 8, 64 and 512 vertices
+*/
+struct NarrowphaseOptions {
+	// .nativeParts files written by Debug::saveIntersectionError, each adds the pair of parts in it as a case
+	std::vector<std::string> caseFiles;
+	// when not empty, the results of every case are written to it as CSV
+	std::string outputPath;
+};
+
+extern NarrowphaseOptions narrowphaseOptions;
+};
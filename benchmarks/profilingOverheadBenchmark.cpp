@@ -0,0 +1,139 @@
+#include "benchmark.h"
+
+#include <iostream>
+#include <chrono>
+#include <atomic>
+
+#include <Physics3D/world.h>
+#include <Physics3D/geometry/shapeCreation.h>
+#include <Physics3D/externalforces/directionalGravity.h>
+#include <Physics3D/misc/debug.h>
+#include <Physics3D/misc/physicsProfiler.h>
+
+using namespace std::chrono;
+
+namespace P3D {
+// measures what each layer of profiling and debug logging costs, compare with a build configured with -DP3D_PROFILING=OFF -DP3D_DEBUG_VIS=OFF
+class ProfilingOverheadBenchmark : public Benchmark {
+	static constexpr int CALL_COUNT = 1000000;
+	static constexpr int TICK_COUNT = 300;
+
+	enum class TestProcess {
+		FIRST,
+		SECOND,
+		COUNT
+	};
+
+	static std::atomic<std::size_t> loggedCount;
+
+	static void countVector(Position, Vec3, Debug::VectorType) { loggedCount.fetch_add(1, std::memory_order_relaxed); }
+	static void countPoint(Position, Debug::PointType) { loggedCount.fetch_add(1, std::memory_order_relaxed); }
+	static void countCFrame(CFrame, Debug::CFrameType) { loggedCount.fetch_add(1, std::memory_order_relaxed); }
+
+	template<typename Func>
+	static double nanosecondsPerCall(Func func) {
+		high_resolution_clock::time_point start = high_resolution_clock::now();
+		for(int i = 0; i < CALL_COUNT; i++) {
+			func(i);
+		}
+		return duration<double, std::nano>(high_resolution_clock::now() - start).count() / CALL_COUNT;
+	}
+
+	static void printCallCost(const char* label, double nanoseconds) {
+		std::cout << "  " << label << ": " << nanoseconds << "ns\n";
+	}
+
+	static double millisecondsPerTick() {
+		WorldPrototype world(0.005);
+		world.addExternalForce(new DirectionalGravity(Vec3(0, -10, 0)));
+		world.addTerrainPart(new Part(boxShape(40.0, 1.0, 40.0), GlobalCFrame(0.0, 0.0, 0.0), {1.0, 0.7, 0.5}));
+		for(int x = -5; x < 5; x++) {
+			for(int y = 0; y < 5; y++) {
+				for(int z = -5; z < 5; z++) {
+					world.addPart(new Part(boxShape(0.9, 0.9, 0.9), GlobalCFrame(x * 1.5, y * 1.5 + 1.0, z * 1.5), {1.0, 0.7, 0.5}));
+				}
+			}
+		}
+
+		high_resolution_clock::time_point start = high_resolution_clock::now();
+		for(int i = 0; i < TICK_COUNT; i++) {
+			physicsMeasure.mark(PhysicsProcess::OTHER);
+			world.tick();
+			physicsMeasure.end();
+		}
+		double result = duration<double, std::milli>(high_resolution_clock::now() - start).count() / TICK_COUNT;
+		world.clear();
+		return result;
+	}
+
+	static void printTickCost(const char* label, double milliseconds, double baseline) {
+		std::cout << "  " << label << ": " << milliseconds << "ms/tick (" << (milliseconds / baseline - 1.0) * 100.0 << "% overhead)\n";
+	}
+
+public:
+	ProfilingOverheadBenchmark() : Benchmark("profilingOverhead") {}
+
+	virtual void run() override {
+		std::cout << "P3D_PROFILING=" << P3D_PROFILING << " P3D_DEBUG_VIS=" << P3D_DEBUG_VIS << "\n";
+
+		const char* labels[]{"first", "second"};
+		EventTracer tracer(1 << 10);
+		ThreadedBreakdownProfiler<TestProcess> profiler(labels, 100, &tracer);
+
+		std::cout << "Per call:\n";
+		printCallCost("mark between processes", nanosecondsPerCall([&profiler](int i) {
+			profiler.mark((i & 1) ? TestProcess::FIRST : TestProcess::SECOND);
+		}));
+		profiler.end();
+		printCallCost("mark from idle and back", nanosecondsPerCall([&profiler](int) {
+			profiler.mark(TestProcess::FIRST);
+			profiler.mark(ThreadedBreakdownProfiler<TestProcess>::NO_PROCESS);
+		}));
+		profiler.end();
+		printCallCost("trace scope, tracer disabled", nanosecondsPerCall([&tracer](int) {
+			TraceScope scope(tracer, "scope");
+		}));
+		tracer.enabled = true;
+		printCallCost("trace scope, tracer enabled", nanosecondsPerCall([&tracer](int) {
+			TraceScope scope(tracer, "scope");
+		}));
+		printCallCost("mark between processes, tracer enabled", nanosecondsPerCall([&profiler](int i) {
+			profiler.mark((i & 1) ? TestProcess::FIRST : TestProcess::SECOND);
+		}));
+		profiler.end();
+		tracer.enabled = false;
+		printCallCost("Debug::logVector, no-op action", nanosecondsPerCall([](int i) {
+			Debug::logVector(Position(0.0, 0.0, 0.0), Vec3(i, 0.0, 0.0), Debug::FORCE);
+		}));
+		Debug::setVectorLogAction(countVector);
+		loggedCount = 0;
+		printCallCost("Debug::logVector, counting action", nanosecondsPerCall([](int i) {
+			Debug::logVector(Position(0.0, 0.0, 0.0), Vec3(i, 0.0, 0.0), Debug::FORCE);
+		}));
+		std::cout << "  logged " << loggedCount << " vectors\n";
+
+		std::cout << "World of 500 cubes, " << TICK_COUNT << " ticks:\n";
+		Debug::setVectorLogAction([](Position, Vec3, Debug::VectorType) {});
+		double baseline = millisecondsPerTick();
+		std::cout << "  as compiled: " << baseline << "ms/tick\n";
+
+		physicsTracer.clear();
+		physicsTracer.enabled = true;
+		printTickCost("physicsTracer enabled", millisecondsPerTick(), baseline);
+		physicsTracer.enabled = false;
+		physicsTracer.clear();
+
+		Debug::setVectorLogAction(countVector);
+		Debug::setPointLogAction(countPoint);
+		Debug::setCFrameLogAction(countCFrame);
+		loggedCount = 0;
+		printTickCost("counting debug log actions", millisecondsPerTick(), baseline);
+		std::cout << "  logged " << loggedCount << " debug items\n";
+		Debug::setVectorLogAction([](Position, Vec3, Debug::VectorType) {});
+		Debug::setPointLogAction([](Position, Debug::PointType) {});
+		Debug::setCFrameLogAction([](CFrame, Debug::CFrameType) {});
+	}
+} profilingOverhead;
+
+std::atomic<std::size_t> ProfilingOverheadBenchmark::loggedCount{0};
+};
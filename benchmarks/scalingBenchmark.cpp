@@ -0,0 +1,209 @@
+#include "scalingBenchmark.h"
+
+#include "benchmark.h"
+#include "worldBenchmark.h"
+
+#include <chrono>
+#include <thread>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <cstddef>
+
+#include "../util/log.h"
+#include "../util/terminalColor.h"
+
+#include <Physics3D/world.h>
+#include <Physics3D/threading/threadPool.h>
+#include <Physics3D/externalforces/directionalGravity.h>
+#include <Physics3D/misc/physicsProfiler.h>
+
+namespace P3D {
+ScalingOptions scalingOptions;
+
+const char* getScalingSceneName(ScalingScene scene) {
+	switch(scene) {
+		case ScalingScene::BOX_GRID: return "grid";
+		case ScalingScene::PILES: return "piles";
+		case ScalingScene::SCATTERED: return "scattered";
+		default: return "unknown";
+	}
+}
+
+static constexpr std::size_t PROCESS_COUNT = static_cast<std::size_t>(PhysicsProcess::COUNT);
+
+struct ScalingRun {
+	const char* mode;
+	ScalingScene scene;
+	// the part count of the series this run belongs to, see ScalingOptions
+	std::size_t seriesPartCount;
+	std::size_t partCount;
+	unsigned int threadCount;
+	int tickCount;
+	double tickMS;
+	// wall time per tick, added up over all threads
+	double processMS[PROCESS_COUNT];
+	// parts ticked per second, relative to the first run of the series
+	double speedup;
+	// speedup divided by the relative thread count
+	double efficiency;
+};
+
+// the runs of both benchmarks, all of them are written to scalingOptions.outputPath
+static std::vector<ScalingRun> scalingRuns;
+
+static std::vector<unsigned int> getThreadCounts() {
+	if(!scalingOptions.threadCounts.empty()) return scalingOptions.threadCounts;
+	unsigned int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+	std::vector<unsigned int> result;
+	for(unsigned int threads = 1; threads < maxThreads; threads *= 2) {
+		result.push_back(threads);
+	}
+	result.push_back(maxThreads);
+	return result;
+}
+
+static int getTickCount(std::size_t partCount) {
+	if(scalingOptions.tickCount > 0) return scalingOptions.tickCount;
+	return static_cast<int>(std::clamp<std::size_t>(200000 / partCount, 3, 100));
+}
+
+static void createScene(WorldPrototype& world, ScalingScene scene, std::size_t partCount) {
+	switch(scene) {
+		case ScalingScene::BOX_GRID: createBoxGrid(world, partCount); break;
+		case ScalingScene::PILES: createPiles(world, partCount, 10); break;
+		case ScalingScene::SCATTERED: createScatteredParts(world, partCount, 1234); break;
+		default: break;
+	}
+}
+
+static ScalingRun measureRun(ScalingScene scene, std::size_t partCount, unsigned int threadCount) {
+	WorldPrototype world(0.005);
+	world.addExternalForce(new DirectionalGravity(Vec3(0, -10, 0)));
+	createScene(world, scene, partCount);
+	ThreadPool threadPool(threadCount);
+
+	auto tick = [&world, &threadPool]() {
+		physicsMeasure.mark(PhysicsProcess::OTHER);
+		world.tick(threadPool);
+		physicsMeasure.end();
+	};
+	for(int i = 0; i < scalingOptions.warmupTicks; i++) {
+		tick();
+	}
+
+	ScalingRun run{};
+	run.scene = scene;
+	run.partCount = partCount;
+	run.threadCount = threadCount;
+	run.tickCount = getTickCount(partCount);
+
+	physicsMeasure.resetLatency();
+	auto start = std::chrono::high_resolution_clock::now();
+	for(int i = 0; i < run.tickCount; i++) {
+		tick();
+	}
+	auto finish = std::chrono::high_resolution_clock::now();
+	run.tickMS = std::chrono::duration<double, std::milli>(finish - start).count() / run.tickCount;
+	for(std::size_t i = 0; i < PROCESS_COUNT; i++) {
+		run.processMS[i] = std::chrono::duration<double, std::milli>(physicsMeasure.getProcessLatency(static_cast<PhysicsProcess>(i)).getMean()).count();
+	}
+	world.clear();
+	return run;
+}
+
+static void printRun(const ScalingRun& run) {
+	std::size_t order[PROCESS_COUNT];
+	for(std::size_t i = 0; i < PROCESS_COUNT; i++) order[i] = i;
+	std::partial_sort(order, order + 3, order + PROCESS_COUNT, [&run](std::size_t a, std::size_t b) { return run.processMS[a] > run.processMS[b]; });
+
+	Log::print("%7u %9zu %10.3f %8.2f %9.1f%%  %s %.3f, %s %.3f, %s %.3f\n",
+			   run.threadCount,
+			   run.partCount,
+			   run.tickMS,
+			   run.speedup,
+			   run.efficiency * 100.0,
+			   physicsMeasure.labels[order[0]], run.processMS[order[0]],
+			   physicsMeasure.labels[order[1]], run.processMS[order[1]],
+			   physicsMeasure.labels[order[2]], run.processMS[order[2]]);
+}
+
+static void writeScalingJSON(std::ostream& out) {
+	out << "{\n\"hardwareConcurrency\":" << std::thread::hardware_concurrency() << ",\n\"runs\":[";
+	for(std::size_t r = 0; r < scalingRuns.size(); r++) {
+		const ScalingRun& run = scalingRuns[r];
+		if(r != 0) out << ',';
+		out << "\n{\"mode\":\"" << run.mode << "\",\"scene\":\"" << getScalingSceneName(run.scene) << "\",\"seriesParts\":" << run.seriesPartCount;
+		out << ",\"parts\":" << run.partCount << ",\"threads\":" << run.threadCount << ",\"ticks\":" << run.tickCount;
+		out << ",\"tick_ms\":" << run.tickMS << ",\"speedup\":" << run.speedup << ",\"efficiency\":" << run.efficiency << ",\"stages_ms\":{";
+		for(std::size_t i = 0; i < PROCESS_COUNT; i++) {
+			if(i != 0) out << ',';
+			out << '"' << physicsMeasure.labels[i] << "\":" << run.processMS[i];
+		}
+		out << "}}";
+	}
+	out << "\n]}\n";
+}
+
+/*
+	Sweeps every scene, part count and thread count of scalingOptions, printing a table per series of runs
+	Stage times are the wall time per tick of each process added up over all threads, so they grow with the thread count when threads wait
+*/
+class ScalingBenchmark : public Benchmark {
+	bool isWeakScaling;
+	// where the runs of the last sweep start in scalingRuns, which also holds the runs of the other scaling benchmark
+	std::size_t firstRecordedRun = 0;
+
+public:
+	ScalingBenchmark(const char* name, bool isWeakScaling) : Benchmark(name), isWeakScaling(isWeakScaling) {}
+
+	// only the last sweep is written out, repeated sweeps replace its runs
+	virtual void reset() override {
+		scalingRuns.erase(scalingRuns.begin() + firstRecordedRun, scalingRuns.end());
+	}
+
+	virtual void run() override {
+		firstRecordedRun = scalingRuns.size();
+		std::vector<unsigned int> threadCounts = getThreadCounts();
+		unsigned int maxThreads = *std::max_element(threadCounts.begin(), threadCounts.end());
+
+		for(ScalingScene scene : scalingOptions.scenes) {
+			for(std::size_t seriesPartCount : scalingOptions.partCounts) {
+				setColor(TerminalColor::MAGENTA);
+				std::cout << "\n[" << (isWeakScaling ? "Weak" : "Strong") << " Scaling] " << getScalingSceneName(scene) << ", " << seriesPartCount << " parts\n";
+				setColor(TerminalColor::WHITE);
+				Log::print("%7s %9s %10s %8s %10s  %s\n", "threads", "parts", "ms/tick", "speedup", "efficiency", "largest stages (ms/tick)");
+
+				const ScalingRun* first = nullptr;
+				std::size_t firstRun = scalingRuns.size();
+				for(unsigned int threadCount : threadCounts) {
+					std::size_t partCount = isWeakScaling ? std::max<std::size_t>(1, seriesPartCount * threadCount / maxThreads) : seriesPartCount;
+					ScalingRun run = measureRun(scene, partCount, threadCount);
+					run.mode = isWeakScaling ? "weak" : "strong";
+					run.seriesPartCount = seriesPartCount;
+
+					if(first == nullptr) {
+						run.speedup = 1.0;
+						run.efficiency = 1.0;
+					} else {
+						run.speedup = (run.partCount / run.tickMS) / (first->partCount / first->tickMS);
+						run.efficiency = run.speedup * first->threadCount / run.threadCount;
+					}
+					scalingRuns.push_back(run);
+					first = &scalingRuns[firstRun];
+					printRun(run);
+				}
+			}
+		}
+
+		if(!scalingOptions.outputPath.empty()) {
+			std::ofstream file(scalingOptions.outputPath);
+			writeScalingJSON(file);
+			std::cout << "Saved scaling results to " << scalingOptions.outputPath << "\n";
+		}
+	}
+};
+
+static ScalingBenchmark strongScalingBench("strongScaling", false);
+static ScalingBenchmark weakScalingBench("weakScaling", true);
+};
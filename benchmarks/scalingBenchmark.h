@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstddef>
+
+namespace P3D {
+enum class ScalingScene {
+	BOX_GRID,
+	PILES,
+	SCATTERED,
+	COUNT
+};
+
+/*
+	Configures the strongScaling and weakScaling benchmarks, which tick worlds of every scene, part count and thread count
+
+	Strong scaling ticks partCount parts with every thread count
+	Weak scaling keeps the parts per thread constant, ticking partCount * threads / maxThreads parts, so the largest thread count ticks partCount parts
+*/
+struct ScalingOptions {
+	std::vector<std::size_t> partCounts{1000, 10000, 100000, 1000000};
+	// empty for 1, 2, 4 ... up to and including std::thread::hardware_concurrency()
+	std::vector<unsigned int> threadCounts;
+	std::vector<ScalingScene> scenes{ScalingScene::BOX_GRID, ScalingScene::PILES, ScalingScene::SCATTERED};
+	// measured ticks per run, 0 picks fewer ticks for larger worlds
+	int tickCount = 0;
+	int warmupTicks = 2;
+	// when not empty, every run is written to it as JSON
+	std::string outputPath;
+};
+
+extern ScalingOptions scalingOptions;
+
+// "grid", "piles" or "scattered"
+const char* getScalingSceneName(ScalingScene scene);
+};
@@ -5,6 +5,8 @@
 #include <iostream>
 #include <sstream>
 #include <cstddef>
+#include <cmath>
+#include <random>
 #include <Physics3D/externalforces/directionalGravity.h>
 
 #include <Physics3D/geometry/shape.h>
@@ -23,7 +25,18 @@ WorldBenchmark::WorldBenchmark(const char* name, int tickCount) : Benchmark(name
 	world.addExternalForce(new DirectionalGravity(Vec3(0, -10, 0)));
 }
 
+// rebuilds the world with init(), keeping the external forces
+void WorldBenchmark::reset() {
+	std::vector<ExternalForce*> externalForces = world.externalForces;
+	world.clear();
+	for(ExternalForce* force : externalForces) {
+		world.addExternalForce(force);
+	}
+	init();
+}
+
 void WorldBenchmark::run() {
+	intersectionPairStatistics.reset();
 	world.isValid();
 	Part& partToTrack = *world.physicals[0]->getMainPart();
 	for(int i = 0; i < tickCount; i++) {
@@ -172,15 +185,73 @@ void WorldBenchmark::printResults(double timeTakenMillis) {
 	setColor(TerminalColor::MAGENTA);
 	std::cout << "[Intersection Statistics]\n";
 	printBreakdown(intersectionStatistics.history.avg().values, intersectionStatistics.labels, intersectionStatistics.size(), "");
+
 	setColor(TerminalColor::WHITE);
+	std::cout << "\n";
+	setColor(TerminalColor::MAGENTA);
+	std::cout << "[Intersection Pairs]\n";
+	setColor(TerminalColor::WHITE);
+	for(const IntersectionPair& pair : intersectionPairStatistics.getPairs()) {
+		const IntersectionPairCounts& c = pair.counts;
+		std::string name = IntersectionPairStatistics::getClassName(pair.firstClassID) + "-" + IntersectionPairStatistics::getClassName(pair.secondClassID);
+		Log::print("%s: %.1f calls/tick, %.1f%% hits, %.3fus/call, %.3fms/tick, %.2f GJK iterations, %.2f EPA iterations\n",
+				   name.c_str(),
+				   double(c.calls) / tickCount,
+				   100.0 * c.hits / c.calls,
+				   c.time.count() / 1000.0 / c.calls,
+				   c.time.count() / 1000000.0 / tickCount,
+				   double(c.gjkIterations) / c.calls,
+				   c.hits == 0 ? 0.0 : double(c.epaIterations) / c.hits);
+	}
 }
 
 
 void WorldBenchmark::createFloor(double w, double h, double wallHeight) {
+	P3D::createFloor(world, w, h, wallHeight);
+}
+
+void createFloor(WorldPrototype& world, double w, double h, double wallHeight) {
 	world.addTerrainPart(new Part(boxShape(w, 1.0, h), GlobalCFrame(0.0, 0.0, 0.0), basicProperties));
 	world.addTerrainPart(new Part(boxShape(0.8, wallHeight, h), GlobalCFrame(w, wallHeight / 2, 0.0), basicProperties));
 	world.addTerrainPart(new Part(boxShape(0.8, wallHeight, h), GlobalCFrame(-w, wallHeight / 2, 0.0), basicProperties));
 	world.addTerrainPart(new Part(boxShape(w, wallHeight, 0.8), GlobalCFrame(0.0, wallHeight / 2, h), basicProperties));
 	world.addTerrainPart(new Part(boxShape(w, wallHeight, 0.8), GlobalCFrame(0.0, wallHeight / 2, -h), basicProperties));
 }
+
+// a square of side cells of the given spacing, centered on the origin, on a floor covering it
+static double createFloorForCells(WorldPrototype& world, std::size_t side, double spacing) {
+	double extent = side * spacing;
+	createFloor(world, extent + 2.0, extent + 2.0, 2.0);
+	return -extent / 2 + spacing / 2;
+}
+
+void createBoxGrid(WorldPrototype& world, std::size_t partCount) {
+	std::size_t side = static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(partCount))));
+	double start = createFloorForCells(world, side, 1.5);
+	for(std::size_t i = 0; i < partCount; i++) {
+		world.addPart(new Part(boxShape(0.9, 0.9, 0.9), GlobalCFrame(start + (i % side) * 1.5, 1.0, start + (i / side) * 1.5), basicProperties));
+	}
+}
+
+void createPiles(WorldPrototype& world, std::size_t partCount, int pileHeight) {
+	std::size_t pileCount = (partCount + pileHeight - 1) / pileHeight;
+	std::size_t side = static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(pileCount))));
+	double start = createFloorForCells(world, side, 2.0);
+	for(std::size_t i = 0; i < partCount; i++) {
+		std::size_t pile = i / pileHeight;
+		std::size_t level = i % pileHeight;
+		world.addPart(new Part(boxShape(0.9, 0.9, 0.9), GlobalCFrame(start + (pile % side) * 2.0, 0.95 + level * 0.9, start + (pile / side) * 2.0), basicProperties));
+	}
+}
+
+void createScatteredParts(WorldPrototype& world, std::size_t partCount, unsigned int seed) {
+	double side = std::cbrt(partCount * 1000.0);
+	createFloor(world, side + 2.0, side + 2.0, 2.0);
+	std::mt19937 generator(seed);
+	std::uniform_real_distribution<double> horizontal(-side / 2, side / 2);
+	std::uniform_real_distribution<double> vertical(2.0, side + 2.0);
+	for(std::size_t i = 0; i < partCount; i++) {
+		world.addPart(new Part(boxShape(0.9, 0.9, 0.9), GlobalCFrame(horizontal(generator), vertical(generator), horizontal(generator)), basicProperties));
+	}
+}
 };
@@ -1,10 +1,21 @@
 #pragma once
 
 #include "benchmark.h"
+#include <cstddef>
 #include <Physics3D/world.h>
 
 namespace P3D {
 static const PartProperties basicProperties{1.0, 0.7, 0.5};
+
+// a floor of w by h centered on the origin, with walls of wallHeight at a distance of w and h
+void createFloor(WorldPrototype& world, double w, double h, double wallHeight);
+// partCount cubes in a square grid on a floor, not touching each other
+void createBoxGrid(WorldPrototype& world, std::size_t partCount);
+// partCount cubes stacked in piles of pileHeight on a floor
+void createPiles(WorldPrototype& world, std::size_t partCount, int pileHeight);
+// partCount cubes at random places above a floor, about one per 1000 units of volume so few of them touch
+void createScatteredParts(WorldPrototype& world, std::size_t partCount, unsigned int seed);
+
 class WorldBenchmark : public Benchmark {
 protected:
 	WorldPrototype world;
@@ -13,6 +24,7 @@ protected:
 public:
 	WorldBenchmark(const char* name, int tickCount);
 
+	virtual void reset() override;
 	virtual void run() override;
 	virtual void printResults(double timeTaken) override;
 
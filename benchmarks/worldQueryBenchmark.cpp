@@ -0,0 +1,207 @@
+#include "benchmark.h"
+
+#include <Physics3D/world.h>
+#include <Physics3D/worldIteration.h>
+#include <Physics3D/boundstree/boundsTree.h>
+#include <Physics3D/boundstree/filters/visibilityFilter.h>
+#include <Physics3D/geometry/shapeCreation.h>
+#include <Physics3D/geometry/intersection.h>
+#include <Physics3D/math/mathUtil.h>
+#include "../util/log.h"
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+namespace P3D {
+#define QUERY_BENCH_GRID_SIZE 24
+#define QUERY_BENCH_QUERY_COUNT 2000
+#define QUERY_BENCH_SPHERE_RADIUS 3.0
+#define QUERY_BENCH_K 8
+#define CULL_BENCH_GRID_SIZE 47
+#define CULL_BENCH_FRAME_COUNT 200
+
+static const PartProperties queryBenchProperties{1.0, 0.7, 0.5};
+
+// the filter gameplay code had to write before WorldPrototype::querySphere existed
+struct SphereBoundsFilter {
+	Vec3f center;
+	float radiusSq;
+
+	std::array<bool, BRANCH_FACTOR> operator()(const TreeTrunk& trunk, int trunkSize) const {
+		std::array<float, BRANCH_FACTOR> distancesSq = TrunkSIMDHelperFallback::computeDistancesSquaredTo(trunk, trunkSize, center);
+		std::array<bool, BRANCH_FACTOR> results;
+		for(int i = 0; i < trunkSize; i++) {
+			results[i] = distancesSq[i] <= radiusSq;
+		}
+		return results;
+	}
+	bool operator()(const Part&) const {
+		return true;
+	}
+};
+
+class WorldQueryBenchmark : public Benchmark {
+protected:
+	WorldPrototype world;
+	std::vector<Position> queryPoints;
+	std::size_t totalFound = 0;
+
+public:
+	WorldQueryBenchmark(const char* name) : Benchmark(name), world(0.01) {}
+
+	void init() override {
+		for(int x = 0; x < QUERY_BENCH_GRID_SIZE; x++) {
+			for(int y = 0; y < QUERY_BENCH_GRID_SIZE; y++) {
+				for(int z = 0; z < QUERY_BENCH_GRID_SIZE; z++) {
+					GlobalCFrame cframe(Position(x * 2.0 + fRand(-0.3, 0.3), y * 2.0 + fRand(-0.3, 0.3), z * 2.0 + fRand(-0.3, 0.3)), Rotation::fromEulerAngles(fRand(-1.0, 1.0), fRand(-1.0, 1.0), fRand(-1.0, 1.0)));
+					Shape shape = ((x + y + z) % 2 == 0) ? boxShape(1.0, 0.8, 1.2) : sphereShape(0.6);
+					world.addTerrainPart(new Part(shape, cframe, queryBenchProperties));
+				}
+			}
+		}
+		world.optimizeLayers();
+		for(int i = 0; i < QUERY_BENCH_QUERY_COUNT; i++) {
+			double extent = QUERY_BENCH_GRID_SIZE * 2.0;
+			queryPoints.push_back(Position(fRand(0.0, extent), fRand(0.0, extent), fRand(0.0, extent)));
+		}
+	}
+	// only the last run is reported, so every run counts from zero
+	void reset() override {
+		totalFound = 0;
+	}
+	void printResults(double timeTaken) override {
+		Log::print("%.0f queries/s, %.2f parts per query\n", QUERY_BENCH_QUERY_COUNT / (timeTaken / 1000.0), double(totalFound) / QUERY_BENCH_QUERY_COUNT);
+	}
+};
+
+class SphereQueryFilteredBenchmark : public WorldQueryBenchmark {
+public:
+	SphereQueryFilteredBenchmark() : WorldQueryBenchmark("sphereQueryFiltered") {}
+
+	void run() override {
+		Shape sphere = sphereShape(QUERY_BENCH_SPHERE_RADIUS);
+		std::vector<Part*> found;
+		for(const Position& point : queryPoints) {
+			found.clear();
+			SphereBoundsFilter filter{castPositionToVec3f(point), float(QUERY_BENCH_SPHERE_RADIUS * QUERY_BENCH_SPHERE_RADIUS)};
+			world.forEachPartFiltered(filter, [&](Part& part) {
+				if(intersectsTransformed(part.hitbox, sphere, part.getCFrame().globalToLocal(GlobalCFrame(point)))) {
+					found.push_back(&part);
+				}
+			});
+			totalFound += found.size();
+		}
+	}
+} sphereQueryFilteredBench;
+
+class SphereQueryBenchmark : public WorldQueryBenchmark {
+public:
+	SphereQueryBenchmark() : WorldQueryBenchmark("sphereQuery") {}
+
+	void run() override {
+		Part* found[256];
+		for(const Position& point : queryPoints) {
+			totalFound += std::min<std::size_t>(world.querySphere(point, QUERY_BENCH_SPHERE_RADIUS, found, 256), 256);
+		}
+	}
+} sphereQueryBench;
+
+class KNearestFilteredBenchmark : public WorldQueryBenchmark {
+public:
+	KNearestFilteredBenchmark() : WorldQueryBenchmark("kNearestFiltered") {}
+
+	// without a known radius there is nothing to filter on, every part has to be visited
+	void run() override {
+		std::vector<std::pair<float, Part*>> nearest;
+		for(const Position& point : queryPoints) {
+			nearest.clear();
+			Vec3f treePoint = castPositionToVec3f(point);
+			world.forEachPart([&](Part& part) {
+				BoundsTemplate<float> bounds = part.getBounds();
+				float dx = std::max(std::max(bounds.min.x - treePoint.x, treePoint.x - bounds.max.x), 0.0f);
+				float dy = std::max(std::max(bounds.min.y - treePoint.y, treePoint.y - bounds.max.y), 0.0f);
+				float dz = std::max(std::max(bounds.min.z - treePoint.z, treePoint.z - bounds.max.z), 0.0f);
+				nearest.emplace_back(dx * dx + dy * dy + dz * dz, &part);
+			});
+			std::size_t k = std::min<std::size_t>(QUERY_BENCH_K, nearest.size());
+			std::partial_sort(nearest.begin(), nearest.begin() + k, nearest.end());
+			totalFound += k;
+		}
+	}
+} kNearestFilteredBench;
+
+class KNearestBenchmark : public WorldQueryBenchmark {
+public:
+	KNearestBenchmark() : WorldQueryBenchmark("kNearest") {}
+
+	void run() override {
+		Part* found[QUERY_BENCH_K];
+		float distancesSq[QUERY_BENCH_K];
+		for(const Position& point : queryPoints) {
+			totalFound += world.queryKNearest(point, QUERY_BENCH_K, found, distancesSq);
+		}
+	}
+} kNearestBench;
+
+// about 100k parts, culled against a camera circling the scene
+class FrustumCullBenchmark : public Benchmark {
+protected:
+	WorldPrototype world;
+	std::vector<VisibilityFilter> frames;
+	std::size_t totalVisible = 0;
+
+public:
+	FrustumCullBenchmark(const char* name) : Benchmark(name), world(0.01) {}
+
+	void init() override {
+		for(int x = 0; x < CULL_BENCH_GRID_SIZE; x++) {
+			for(int y = 0; y < CULL_BENCH_GRID_SIZE; y++) {
+				for(int z = 0; z < CULL_BENCH_GRID_SIZE; z++) {
+					world.addTerrainPart(new Part(boxShape(1.0, 1.0, 1.0), GlobalCFrame(x * 2.0, y * 2.0, z * 2.0), queryBenchProperties));
+				}
+			}
+		}
+		world.optimizeLayers();
+		double center = CULL_BENCH_GRID_SIZE;
+		for(int i = 0; i < CULL_BENCH_FRAME_COUNT; i++) {
+			double angle = i * 2.0 * 3.14159265358979 / CULL_BENCH_FRAME_COUNT;
+			Position origin(center + std::cos(angle) * center * 1.5, center, center + std::sin(angle) * center * 1.5);
+			Vec3 forward(-std::cos(angle), -0.1, -std::sin(angle));
+			frames.push_back(VisibilityFilter::forWindow(origin, forward, Vec3(0.0, 1.0, 0.0), 1.0, 16.0 / 9.0, center * 2.0));
+		}
+	}
+	void reset() override {
+		totalVisible = 0;
+	}
+	void printResults(double timeTaken) override {
+		Log::print("%.3f ms per frame, %.0f visible parts per frame\n", timeTaken / CULL_BENCH_FRAME_COUNT, double(totalVisible) / CULL_BENCH_FRAME_COUNT);
+	}
+};
+
+class FrustumCullFilteredBenchmark : public FrustumCullBenchmark {
+public:
+	FrustumCullFilteredBenchmark() : FrustumCullBenchmark("frustumCullFiltered") {}
+
+	void run() override {
+		for(const VisibilityFilter& filter : frames) {
+			world.forEachPartFiltered(filter, [&](Part&) {
+				totalVisible++;
+			});
+		}
+	}
+} frustumCullFilteredBench;
+
+class FrustumCullSIMDBenchmark : public FrustumCullBenchmark {
+public:
+	FrustumCullSIMDBenchmark() : FrustumCullBenchmark("frustumCull") {}
+
+	void run() override {
+		for(const VisibilityFilter& filter : frames) {
+			world.forEachPartInFrustum(filter.getTreeFrustum(), [&](Part&) {
+				totalVisible++;
+			});
+		}
+	}
+} frustumCullBench;
+};
@@ -0,0 +1,69 @@
+#include "testsMain.h"
+
+#include "../benchmarks/benchmarkStatistics.h"
+
+#include <vector>
+#include <string>
+#include <sstream>
+
+#define ASSERT(v) ASSERT_TOLERANT(v, 0.000001)
+
+TEST_CASE(statisticsOfEvenSampleCount) {
+	SampleStatistics stats = computeStatistics(std::vector<double>{4.0, 1.0, 3.0, 2.0});
+
+	// the median of an even number of samples is the mean of the two middle ones
+	ASSERT(stats.median == 2.5);
+	ASSERT(stats.mean == 2.5);
+	ASSERT(stats.min == 1.0);
+	ASSERT(stats.max == 4.0);
+	ASSERT(stats.stddev == 1.2909944487358056);
+
+	ASSERT(computeStatistics(std::vector<double>{1.0, 2.0, 3.0, 4.0, 100.0, 5.0}).median == 3.5);
+	ASSERT(computeStatistics(std::vector<double>{7.0, 3.0}).median == 5.0);
+}
+
+TEST_CASE(statisticsOfSingleSample) {
+	SampleStatistics stats = computeStatistics(std::vector<double>{3.0});
+
+	ASSERT(stats.median == 3.0);
+	ASSERT(stats.mean == 3.0);
+	ASSERT(stats.stddev == 0.0);
+}
+
+TEST_CASE(mannWhitneyWithTies) {
+	// U = 2.5 with ties of three and two values, z = 5 / sqrt(11.2857) after the continuity correction
+	ASSERT(mannWhitneyPValue(std::vector<double>{1.0, 2.0, 2.0, 3.0}, std::vector<double>{2.0, 3.0, 4.0, 5.0}) == 0.13665824773814753);
+	ASSERT(mannWhitneyPValue(std::vector<double>{2.0, 3.0, 4.0, 5.0}, std::vector<double>{1.0, 2.0, 2.0, 3.0}) == 0.13665824773814753);
+	// fully separated samples, U = 0
+	ASSERT(mannWhitneyPValue(std::vector<double>{1.0, 1.0, 2.0}, std::vector<double>{3.0, 3.0, 4.0}) == 0.0721981977016576);
+}
+
+TEST_CASE(mannWhitneyWithoutInformation) {
+	// all values tied leaves no variance
+	ASSERT_TRUE(mannWhitneyPValue(std::vector<double>{2.0, 2.0}, std::vector<double>{2.0, 2.0}) == 1.0);
+	ASSERT_TRUE(mannWhitneyPValue(std::vector<double>{1.0}, std::vector<double>{2.0, 3.0, 4.0}) == 1.0);
+	ASSERT_TRUE(mannWhitneyPValue(std::vector<double>{}, std::vector<double>{}) == 1.0);
+}
+
+TEST_CASE(resultsJSONRoundTrip) {
+	std::vector<BenchmarkResult> results(3);
+	results[0].name = "plain";
+	results[0].warmups = 2;
+	results[0].timesMS = std::vector<double>{1.5, 2.25, 12.125};
+	results[1].name = "quoted \"name\" with a \\ back\\slash\\";
+	results[1].warmups = 0;
+	results[1].timesMS = std::vector<double>{0.5};
+	results[2].name = "no runs";
+	results[2].warmups = 1;
+
+	std::stringstream json;
+	writeResultsJSON(json, results, 3);
+	std::vector<BenchmarkResult> read = readResultsJSON(json);
+
+	ASSERT_TRUE(read.size() == results.size());
+	for(std::size_t i = 0; i < results.size(); i++) {
+		ASSERT_TRUE(read[i].name == results[i].name);
+		ASSERT_TRUE(read[i].warmups == results[i].warmups);
+		ASSERT_TRUE(read[i].timesMS == results[i].timesMS);
+	}
+}
@@ -8,9 +8,12 @@
 #include "generators.h"
 #include <Physics3D/misc/toString.h>
 #include <Physics3D/misc/validityHelper.h>
+#include <Physics3D/misc/cpuid.h>
+#include <Physics3D/boundstree/filters/visibilityFilter.h>
 
 #include <vector>
 #include <set>
+#include <algorithm>
 
 using namespace P3D;
 
@@ -498,3 +501,218 @@ TEST_CASE(testImproveStructureValidity) {
 		}
 	}
 }
+
+// exact slab test in double precision, RAY_MAX_DISTANCE on a miss
+static double rayDistanceToBounds(const BoundsTemplate<float>& bounds, const Vec3& origin, const Vec3& direction) {
+	double mins[3]{bounds.min.x, bounds.min.y, bounds.min.z};
+	double maxs[3]{bounds.max.x, bounds.max.y, bounds.max.z};
+	double tNear = 0.0;
+	double tFar = RAY_MAX_DISTANCE;
+	for(int axis = 0; axis < 3; axis++) {
+		double t1 = (mins[axis] - origin[axis]) / direction[axis];
+		double t2 = (maxs[axis] - origin[axis]) / direction[axis];
+		tNear = std::max(tNear, std::min(t1, t2));
+		tFar = std::min(tFar, std::max(t1, t2));
+	}
+	return (tNear <= tFar) ? tNear : RAY_MAX_DISTANCE;
+}
+
+template<typename SIMDHelper>
+static void testRaycastMatchesBruteForce() {
+	BoundsTree<BasicBounded> tree;
+
+	constexpr int itemCount = 500;
+	constexpr int rayCount = 64;
+
+	std::vector<BasicBounded> allItems;
+	for(int i = 0; i < itemCount; i++) {
+		float x = generateFloat(-100.0f, 100.0f);
+		float y = generateFloat(-100.0f, 100.0f);
+		float z = generateFloat(-100.0f, 100.0f);
+		float w = generateFloat(0.5f, 5.0f);
+		float h = generateFloat(0.5f, 5.0f);
+		float d = generateFloat(0.5f, 5.0f);
+		allItems.push_back(BasicBounded{BoundsTemplate<float>(PositionTemplate<float>(x - w, y - h, z - d), PositionTemplate<float>(x + w, y + h, z + d))});
+	}
+	for(BasicBounded& item : allItems) {
+		tree.add(&item);
+	}
+
+	std::vector<Vec3> origins;
+	std::vector<Vec3> directions;
+	std::vector<double> expectedDistances;
+	for(int r = 0; r < rayCount; r++) {
+		Vec3 origin(generateDouble(-150.0, 150.0), generateDouble(-150.0, 150.0), generateDouble(-150.0, 150.0));
+		// aim roughly at the center so most rays hit something
+		Vec3 direction = normalize(Vec3(generateDouble(-30.0, 30.0), generateDouble(-30.0, 30.0), generateDouble(-30.0, 30.0)) - origin);
+		origins.push_back(origin);
+		directions.push_back(direction);
+
+		double expected = RAY_MAX_DISTANCE;
+		for(const BasicBounded& item : allItems) {
+			expected = std::min(expected, rayDistanceToBounds(item.bounds, origin, direction));
+		}
+		expectedDistances.push_back(expected);
+	}
+
+	for(int r = 0; r < rayCount; r++) {
+		TreeRay ray(static_cast<Vec3f>(origins[r]), static_cast<Vec3f>(directions[r]));
+		double found = tree.raycast<SIMDHelper>(ray, RAY_MAX_DISTANCE, [&](BasicBounded& item, double) {
+			return rayDistanceToBounds(item.bounds, origins[r], directions[r]);
+		});
+		ASSERT_STRICT(found == expectedDistances[r]);
+	}
+
+	for(int packetStart = 0; packetStart < rayCount; packetStart += RAY_PACKET_SIZE) {
+		TreeRayPacket packet;
+		double maxDistances[RAY_PACKET_SIZE];
+		for(int r = 0; r < RAY_PACKET_SIZE; r++) {
+			packet.setRay(r, TreeRay(static_cast<Vec3f>(origins[packetStart + r]), static_cast<Vec3f>(directions[packetStart + r])), RAY_MAX_DISTANCE);
+			maxDistances[r] = RAY_MAX_DISTANCE;
+		}
+		tree.raycastPacket<SIMDHelper>(packet, maxDistances, 0xFF, [&](BasicBounded& item, int rayIndex, double) {
+			return rayDistanceToBounds(item.bounds, origins[packetStart + rayIndex], directions[packetStart + rayIndex]);
+		});
+		for(int r = 0; r < RAY_PACKET_SIZE; r++) {
+			ASSERT_STRICT(maxDistances[r] == expectedDistances[packetStart + r]);
+		}
+	}
+}
+
+TEST_CASE(testRaycastFindsNearestBounds) {
+	testRaycastMatchesBruteForce<TrunkSIMDHelperFallback>();
+	if(CPUIDCheck::hasTechnology(CPUIDCheck::AVX)) {
+		testRaycastMatchesBruteForce<TrunkSIMDHelperAVX>();
+	}
+}
+
+static float distanceSquaredToBounds(const BoundsTemplate<float>& bounds, const Vec3f& point) {
+	float dx = std::max(std::max(bounds.min.x - point.x, point.x - bounds.max.x), 0.0f);
+	float dy = std::max(std::max(bounds.min.y - point.y, point.y - bounds.max.y), 0.0f);
+	float dz = std::max(std::max(bounds.min.z - point.z, point.z - bounds.max.z), 0.0f);
+	return dx * dx + dy * dy + dz * dz;
+}
+
+template<typename SIMDHelper>
+static void testQueriesMatchBruteForce() {
+	BoundsTree<BasicBounded> tree;
+
+	constexpr int itemCount = 2000;
+
+	std::vector<BasicBounded> allItems;
+	for(int i = 0; i < itemCount; i++) {
+		float x = generateFloat(-100.0f, 100.0f);
+		float y = generateFloat(-100.0f, 100.0f);
+		float z = generateFloat(-100.0f, 100.0f);
+		float w = generateFloat(0.5f, 5.0f);
+		float h = generateFloat(0.5f, 5.0f);
+		float d = generateFloat(0.5f, 5.0f);
+		allItems.push_back(BasicBounded{BoundsTemplate<float>(PositionTemplate<float>(x - w, y - h, z - d), PositionTemplate<float>(x + w, y + h, z + d))});
+	}
+	for(BasicBounded& item : allItems) {
+		tree.add(&item);
+	}
+
+	std::vector<BasicBounded*> found(itemCount);
+	for(int q = 0; q < 20; q++) {
+		Vec3f center(generateFloat(-100.0f, 100.0f), generateFloat(-100.0f, 100.0f), generateFloat(-100.0f, 100.0f));
+		float size = generateFloat(1.0f, 40.0f);
+		BoundsTemplate<float> box(PositionTemplate<float>(center.x - size, center.y - size, center.z - size), PositionTemplate<float>(center.x + size, center.y + size, center.z + size));
+
+		std::vector<BasicBounded*> expectedInBox;
+		std::vector<BasicBounded*> expectedInSphere;
+		for(BasicBounded& item : allItems) {
+			if(intersects(item.bounds, box)) expectedInBox.push_back(&item);
+			if(distanceSquaredToBounds(item.bounds, center) <= size * size) expectedInSphere.push_back(&item);
+		}
+
+		std::size_t boxCount = tree.queryBox<SIMDHelper>(box, found.data(), found.size());
+		ASSERT_STRICT(boxCount == expectedInBox.size());
+		ASSERT_TRUE(std::set<BasicBounded*>(found.begin(), found.begin() + boxCount) == std::set<BasicBounded*>(expectedInBox.begin(), expectedInBox.end()));
+
+		std::size_t sphereCount = tree.querySphere<SIMDHelper>(center, size, found.data(), found.size());
+		ASSERT_STRICT(sphereCount == expectedInSphere.size());
+		ASSERT_TRUE(std::set<BasicBounded*>(found.begin(), found.begin() + sphereCount) == std::set<BasicBounded*>(expectedInSphere.begin(), expectedInSphere.end()));
+
+		// a buffer that is too small is filled up and the full count is still returned
+		if(boxCount > 3) {
+			ASSERT_STRICT(tree.queryBox<SIMDHelper>(box, found.data(), 3) == boxCount);
+		}
+
+		std::vector<float> allDistancesSq;
+		for(const BasicBounded& item : allItems) {
+			allDistancesSq.push_back(distanceSquaredToBounds(item.bounds, center));
+		}
+		std::sort(allDistancesSq.begin(), allDistancesSq.end());
+
+		// large k makes the queue overflow into the depth first fallback
+		for(std::size_t k : {std::size_t(1), std::size_t(8), std::size_t(300)}) {
+			std::vector<float> distancesSq(k);
+			std::size_t nearestCount = tree.queryKNearest<SIMDHelper>(center, k, found.data(), distancesSq.data());
+			ASSERT_STRICT(nearestCount == k);
+			for(std::size_t i = 0; i < k; i++) {
+				ASSERT_TOLERANT(distancesSq[i] == allDistancesSq[i], 0.001);
+				ASSERT_TOLERANT(distanceSquaredToBounds(found[i]->bounds, center) == distancesSq[i], 0.001);
+			}
+		}
+	}
+
+	BoundsTree<BasicBounded> emptyTree;
+	float distanceSq;
+	ASSERT_STRICT(emptyTree.queryKNearest<SIMDHelper>(Vec3f(0.0f, 0.0f, 0.0f), 1, found.data(), &distanceSq) == 0u);
+}
+
+TEST_CASE(testQueriesFindBruteForceResults) {
+	testQueriesMatchBruteForce<TrunkSIMDHelperFallback>();
+	if(CPUIDCheck::hasTechnology(CPUIDCheck::AVX)) {
+		testQueriesMatchBruteForce<TrunkSIMDHelperAVX>();
+	}
+}
+
+template<typename SIMDHelper>
+static void testFrustumCullingMatchesBruteForce() {
+	BoundsTree<BasicBounded> tree;
+
+	std::vector<BasicBounded> allItems;
+	for(int i = 0; i < 2000; i++) {
+		float x = generateFloat(-100.0f, 100.0f);
+		float y = generateFloat(-100.0f, 100.0f);
+		float z = generateFloat(-100.0f, 100.0f);
+		float size = generateFloat(0.5f, 3.0f);
+		allItems.push_back(BasicBounded{BoundsTemplate<float>(PositionTemplate<float>(x - size, y - size, z - size), PositionTemplate<float>(x + size, y + size, z + size))});
+	}
+	for(BasicBounded& item : allItems) {
+		tree.add(&item);
+	}
+
+	for(int f = 0; f < 20; f++) {
+		Position origin(generateDouble(-120.0, 120.0), generateDouble(-120.0, 120.0), generateDouble(-120.0, 120.0));
+		Vec3 forward = normalize(Vec3(generateDouble(-50.0, 50.0), generateDouble(-50.0, 50.0), generateDouble(-50.0, 50.0)) - Vec3(origin - Position(0.0, 0.0, 0.0)));
+		Vec3 up = normalize(forward % Vec3(0.3, 1.0, 0.1) % forward);
+		VisibilityFilter filter = VisibilityFilter::forWindow(origin, forward, up, generateDouble(0.5, 1.5), generateDouble(0.5, 2.0), generateDouble(50.0, 250.0));
+
+		std::set<BasicBounded*> expected;
+		for(BasicBounded& item : allItems) {
+			if(filter(Bounds(item.bounds))) expected.insert(&item);
+		}
+
+		std::set<BasicBounded*> found;
+		tree.forEachInFrustum<SIMDHelper>(filter.getTreeFrustum(), [&](BasicBounded& item) {
+			ASSERT_TRUE(found.insert(&item).second);
+		});
+		ASSERT_TRUE(found == expected);
+
+		std::set<BasicBounded*> foundFiltered;
+		tree.forEachFiltered(filter, [&](BasicBounded& item) {
+			foundFiltered.insert(&item);
+		});
+		ASSERT_TRUE(foundFiltered == expected);
+	}
+}
+
+TEST_CASE(testFrustumCullingFindsVisibleBounds) {
+	testFrustumCullingMatchesBruteForce<TrunkSIMDHelperFallback>();
+	if(CPUIDCheck::hasTechnology(CPUIDCheck::AVX)) {
+		testFrustumCullingMatchesBruteForce<TrunkSIMDHelperAVX>();
+	}
+}
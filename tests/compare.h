@@ -102,7 +102,7 @@ bool tolerantEquals(const P3D::LargeMatrix<Num1>& first, const P3D::LargeMatrix<
 	if(first.w != second.w || first.h != second.h) throw "Dimensions must match!";
 	for(size_t row = 0; row < first.h; row++)
 		for(size_t col = 0; col < first.w; col++)
-			if(!tolerantEquals(first.get(row, col), second.get(row, col), tolerance))
+			if(!tolerantEquals(first(row, col), second(row, col), tolerance))
 				return false;
 
 	return true;
@@ -113,7 +113,7 @@ bool tolerantEquals(const P3D::LargeSymmetricMatrix<Num1>& first, const P3D::Lar
 	if(first.size != second.size) throw "Dimensions must match!";
 	for(size_t row = 0; row < first.size; row++)
 		for(size_t col = row; col < first.size; col++)
-			if(!tolerantEquals(first.get(row, col), second.get(row, col), tolerance))
+			if(!tolerantEquals(first(row, col), second(row, col), tolerance))
 				return false;
 
 	return true;
@@ -16,8 +16,10 @@
 #include <Physics3D/math/taylorExpansion.h>
 #include <Physics3D/math/predefinedTaylorExpansions.h>
 #include <Physics3D/math/linalg/commonMatrices.h>
+#include <Physics3D/misc/cpuid.h>
 
 #include <algorithm>
+#include <vector>
 
 using namespace P3D;
 #define ASSERT(condition) ASSERT_TOLERANT(condition, 0.00000001)
@@ -235,6 +237,112 @@ TEST_CASE(largeMatrixVectorSolve) {
 	ASSERT(solutionVector == vec);
 }
 
+static LargeMatrix<double> createRandomLargeMatrix(std::size_t width, std::size_t height) {
+	LargeMatrix<double> result(width, height);
+	for(double& d : result) d = fRand(-1.0, 1.0);
+	return result;
+}
+
+// runs the given test once with the AVX kernels and once with the scalar ones
+template<typename Func>
+static void runForAllDenseKernels(Func test) {
+	constexpr unsigned int AVX_TECH = CPUIDCheck::AVX | CPUIDCheck::AVX2 | CPUIDCheck::FMA;
+	bool hadAVX = CPUIDCheck::hasTechnology(AVX_TECH);
+	test();
+	CPUIDCheck::disableTechnology(AVX_TECH);
+	test();
+	if(hadAVX) CPUIDCheck::enableTechnology(AVX_TECH);
+}
+
+TEST_CASE(denseMatrixMultiply) {
+	runForAllDenseKernels([]() {
+		for(std::size_t size : {1, 7, 37, 150}) {
+			LargeMatrix<double> a = createRandomLargeMatrix(size + 3, size);
+			LargeMatrix<double> b = createRandomLargeMatrix(size + 130, size + 3);
+
+			LargeMatrix<double> expected(b.w, a.h);
+			inMemoryMatrixMultiply(a, b, expected);
+
+			LargeMatrix<double> result(b.w, a.h);
+			denseMatrixMultiply(a, b, result);
+
+			ASSERT(result == expected);
+		}
+	});
+}
+
+TEST_CASE(luDecomposeReconstructsMatrix) {
+	runForAllDenseKernels([]() {
+		for(std::size_t size : {1, 5, 33, 97}) {
+			LargeMatrix<double> original = createRandomLargeMatrix(size, size);
+			LargeMatrix<double> lu = original;
+			std::vector<std::size_t> pivots(size);
+			luDecompose(lu, pivots.data());
+
+			LargeMatrix<double> l = LargeMatrix<double>::zero(size, size);
+			LargeMatrix<double> u = LargeMatrix<double>::zero(size, size);
+			for(std::size_t row = 0; row < size; row++) {
+				for(std::size_t col = 0; col < size; col++) {
+					if(col < row) l(row, col) = lu(row, col);
+					else u(row, col) = lu(row, col);
+				}
+				l(row, row) = 1.0;
+			}
+
+			LargeMatrix<double> permuted = original;
+			for(std::size_t row = 0; row < size; row++) {
+				swapRows(permuted, row, pivots[row]);
+			}
+
+			LargeMatrix<double> reconstructed(size, size);
+			denseMatrixMultiply(l, u, reconstructed);
+
+			ASSERT(reconstructed == permuted);
+		}
+	});
+}
+
+TEST_CASE(largeMatrixVectorSolveBlocked) {
+	runForAllDenseKernels([]() {
+		for(std::size_t size : {3, 64, 201}) {
+			LargeMatrix<double> mat = createRandomLargeMatrix(size, size);
+			LargeVector<double> vec(size);
+			for(std::size_t i = 0; i < size; i++) {
+				vec[i] = fRand(-1.0, 1.0);
+			}
+
+			LargeVector<double> solutionVector = mat * vec;
+
+			destructiveSolve(mat, solutionVector);
+
+			ASSERT(solutionVector == vec);
+		}
+	});
+}
+
+TEST_CASE(largeMatrixMultipleSolve) {
+	runForAllDenseKernels([]() {
+		constexpr std::size_t size = 75;
+		LargeMatrix<double> mat = createRandomLargeMatrix(size, size);
+		double solutionBuf[size * 3];
+		UnmanagedHorizontalFixedMatrix<double, 3> solution(solutionBuf, size);
+		for(double& d : solution) d = fRand(-1.0, 1.0);
+
+		double rhsBuf[size * 3];
+		UnmanagedHorizontalFixedMatrix<double, 3> rhs(rhsBuf, size);
+		inMemoryMatrixMultiply(mat, solution, rhs);
+
+		LargeMatrix<double> lu = mat;
+		std::vector<std::size_t> pivots(size);
+		luDecompose(lu, pivots.data());
+		luSolve(lu, pivots.data(), rhsBuf, 3);
+
+		for(std::size_t i = 0; i < size * 3; i++) {
+			ASSERT(rhsBuf[i] == solutionBuf[i]);
+		}
+	});
+}
+
 TEST_CASE(testTaylorExpansion) {
 	FullTaylorExpansion<double, 5> testTaylor{2.0, 5.0, 2.0, 3.0, -0.7};
 
@@ -238,3 +238,81 @@ TEST_CASE(testAttachConnectedPhysicalToConnectedPhysical) {
 		delete p;
 	}
 }
+
+static void checkFlattenedTree(MotorizedPhysical* m) {
+	FlattenedPhysicalTree& tree = m->getFlattenedTree();
+
+	ASSERT(tree.size() == m->getNumberOfPhysicalsInThisAndChildren());
+	ASSERT_TRUE(tree.physicals[0] == m);
+	ASSERT(tree.subtreeEnds[0] == tree.size());
+	for(std::size_t i = 1; i < tree.size(); i++) {
+		ConnectedPhysical* conPhys = static_cast<ConnectedPhysical*>(tree.physicals[i]);
+		std::size_t parentIndex = tree.parentIndices[i];
+		ASSERT_TRUE(parentIndex < i);
+		ASSERT_TRUE(conPhys->parent == tree.physicals[parentIndex]);
+		ASSERT_TRUE(tree.subtreeEnds[i] <= tree.subtreeEnds[parentIndex]);
+		ASSERT(tree.subtreeEnds[i] - i == conPhys->getNumberOfPhysicalsInThisAndChildren());
+		ASSERT_TOLERANT(tree.relativeCFrames[i] == conPhys->getRelativeCFrameToParent(), 0.0005);
+	}
+}
+
+TEST_CASE(testFlattenedTreeFollowsStructure) {
+	Part* a = createPart();
+	Part* b = createPart();
+	Part* c = createPart();
+	Part* d = createPart();
+	Part* e = createPart();
+	Part* f = createPart();
+	Part* g = createPart();
+
+	a->attach(b, new FixedConstraint(), cf(), cf());
+	a->attach(e, new FixedConstraint(), cf(), cf());
+	b->attach(c, new FixedConstraint(), cf(), cf());
+	b->attach(d, new FixedConstraint(), cf(), cf());
+	e->attach(f, new FixedConstraint(), cf(), cf());
+
+	MotorizedPhysical* m = a->getMainPhysical();
+	checkFlattenedTree(m);
+
+	f->attach(g, new FixedConstraint(), cf(), cf());
+	checkFlattenedTree(m);
+
+	f->getPhysical()->makeMainPhysical();
+	checkFlattenedTree(m);
+
+	b->detach();
+	checkFlattenedTree(a->getMainPhysical());
+
+	Part* parts[]{a,b,c,d,e,f,g};
+	for(Part* p : parts) {
+		delete p;
+	}
+}
+
+TEST_CASE(testChangeMainPartOfConnectedAssembly) {
+	Part* a = createPart();
+	Part* a2 = createPart();
+	Part* b = createPart();
+	Part* c = createPart();
+
+	a->attach(a2, cf());
+	a->attach(b, new FixedConstraint(), cf(), cf());
+	b->attach(c, new FixedConstraint(), cf(), cf());
+
+	MotorizedPhysical* m = a->getMainPhysical();
+	checkFlattenedTree(m);
+	CFrame bRelativeToA = a->getCFrame().globalToLocal(b->getCFrame());
+	CFrame cRelativeToA = a->getCFrame().globalToLocal(c->getCFrame());
+
+	a2->makeMainPart();
+	m->update(0.01);
+	checkFlattenedTree(m);
+
+	ASSERT_TOLERANT(a->getCFrame().globalToLocal(b->getCFrame()) == bRelativeToA, 0.0005);
+	ASSERT_TOLERANT(a->getCFrame().globalToLocal(c->getCFrame()) == cRelativeToA, 0.0005);
+
+	Part* parts[]{a,a2,b,c};
+	for(Part* p : parts) {
+		delete p;
+	}
+}
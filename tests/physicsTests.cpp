@@ -17,8 +17,25 @@
 #include <Physics3D/hardconstraints/motorConstraint.h>
 #include <Physics3D/hardconstraints/sinusoidalPistonConstraint.h>
 #include <Physics3D/hardconstraints/fixedConstraint.h>
+#include <Physics3D/singleBodyStore.h>
+#include <Physics3D/softlinks/springLink.h>
+#include <Physics3D/worldPhysics.h>
+#include <Physics3D/threading/threadPool.h>
+#include <Physics3D/threading/upgradeableMutex.h>
+#include <Physics3D/misc/cpuid.h>
+#include <Physics3D/misc/physicsProfiler.h>
+#include <Physics3D/misc/allocationTracker.h>
+#include <Physics3D/misc/debug.h>
+#include <Physics3D/geometry/builtinShapeClasses.h>
+#include <Physics3D/geometry/intersection.h>
 #include "../util/log.h"
 
+#include <thread>
+#include <atomic>
+#include <sstream>
+#include <fstream>
+#include <filesystem>
+
 
 using namespace P3D;
 #define REMAINS_CONSTANT(v) REMAINS_CONSTANT_TOLERANT(v, 0.0005)
@@ -980,6 +997,983 @@ TEST_CASE(conservationOfCenterOfMass) {
 	}
 }
 
+TEST_CASE(incrementalPhysicalPropertiesMatchFullRefresh) {
+	std::vector<Part> phys = produceMotorizedPhysical();
+	Part& weldedPart = phys.emplace_back(boxShape(0.5, 1.0, 0.3), phys[2],
+									 new FixedConstraint(),
+									 CFrame(0.4, -0.3, 0.2, Rotation::fromEulerAngles(0.3, 0.1, -0.2)),
+									 CFrame(-0.2, 0.5, 0.1), basicProperties);
+	Part& attachedPart = phys.emplace_back(cylinderShape(0.4, 1.2), weldedPart, CFrame(0.0, 0.7, 0.0), basicProperties);
+
+	MotorizedPhysical* motorPhys = phys[0].getMainPhysical();
+
+	motorPhys->motionOfCenterOfMass = Motion(Vec3(0.0, 0.0, 0.0), Vec3(-1.7, 3.3, 12.0));
+
+	for(int i = 0; i < TICKS; i++) {
+		if(i == TICKS / 2) {
+			// attachments changed outside of the regular attach/detach path must be picked up as well
+			weldedPart.getPhysical()->rigidBody.setAttachFor(&attachedPart, CFrame(0.3, 0.2, 0.9, Rotation::fromEulerAngles(0.5, 0.0, 0.2)));
+		}
+
+		motorPhys->update(DELTA_T);
+
+		ALLOCA_COMMotionTree(t, motorPhys, size);
+
+		ASSERT(motorPhys->totalMass == t.totalMass);
+		ASSERT(motorPhys->totalCenterOfMass == t.centerOfMass);
+		ASSERT(motorPhys->momentResponse == ~t.getInertia());
+	}
+}
+
+static void compareSingleBodyStoreToUpdate(ThreadPool& threadPool) {
+	const int bodyCount = 11; // not a multiple of the lane width
+
+	std::vector<Part> regularParts;
+	std::vector<Part> storedParts;
+	regularParts.reserve(bodyCount);
+	storedParts.reserve(bodyCount);
+	std::vector<MotorizedPhysical*> storedPhysicals;
+
+	for(int i = 0; i < bodyCount; i++) {
+		GlobalCFrame cframe(Position(i * 5.0, 0.3 * i, -2.0 * i), Rotation::fromEulerAngles(0.3 * i, 0.7, -0.2 * i));
+		Shape shape = boxShape(1.0 + 0.1 * i, 2.0, 0.5);
+		Motion motion(Vec3(0.1 * i, -0.3, 0.7), Vec3(1.3, -0.2 * i, 2.1));
+
+		Part& regularPart = regularParts.emplace_back(shape, cframe, basicProperties);
+		Part& storedPart = storedParts.emplace_back(shape, cframe, basicProperties);
+		regularPart.ensureHasPhysical();
+		storedPart.ensureHasPhysical();
+		regularPart.getMainPhysical()->motionOfCenterOfMass = motion;
+		storedPart.getMainPhysical()->motionOfCenterOfMass = motion;
+		storedPhysicals.push_back(storedPart.getMainPhysical());
+	}
+
+	SingleBodyStore store;
+	for(int tick = 0; tick < 100; tick++) {
+		for(int i = 0; i < bodyCount; i++) {
+			Vec3 origin(0.2, -0.1 * i, 0.3);
+			Vec3 force(std::sin(tick * 0.1 + i), 0.5, -0.2 * i);
+			regularParts[i].getMainPhysical()->applyForce(origin, force);
+			storedParts[i].getMainPhysical()->applyForce(origin, force);
+			regularParts[i].getMainPhysical()->update(DELTA_T);
+		}
+		store.update(storedPhysicals, DELTA_T, threadPool);
+	}
+
+	ASSERT_TRUE(store.getBodyCount() == bodyCount);
+	for(int i = 0; i < bodyCount; i++) {
+		ASSERT(regularParts[i].getCFrame() == storedParts[i].getCFrame());
+		ASSERT(regularParts[i].getMainPhysical()->motionOfCenterOfMass == storedParts[i].getMainPhysical()->motionOfCenterOfMass);
+	}
+}
+
+TEST_CASE(singleBodyStoreMatchesUpdate) {
+	constexpr unsigned int AVX_TECH = CPUIDCheck::AVX | CPUIDCheck::AVX2 | CPUIDCheck::FMA;
+	bool hadAVX = CPUIDCheck::hasTechnology(AVX_TECH);
+
+	ThreadPool singleThread(1);
+	ThreadPool multiThread(4);
+	compareSingleBodyStoreToUpdate(singleThread);
+	compareSingleBodyStoreToUpdate(multiThread);
+
+	CPUIDCheck::disableTechnology(AVX_TECH);
+	compareSingleBodyStoreToUpdate(singleThread);
+	if(hadAVX) CPUIDCheck::enableTechnology(AVX_TECH);
+}
+
+TEST_CASE(updatePhysicalsParallelMatchesSerial) {
+	const int bodyCount = 75; // spans several chunks, the last one partially filled
+
+	std::vector<Part> serialParts;
+	std::vector<Part> parallelParts;
+	serialParts.reserve(bodyCount);
+	parallelParts.reserve(bodyCount);
+	std::vector<MotorizedPhysical*> parallelPhysicals;
+
+	for(int i = 0; i < bodyCount; i++) {
+		GlobalCFrame cframe(Position(i * 3.0, 0.1 * i, -1.0 * i), Rotation::fromEulerAngles(0.2 * i, -0.4, 0.1 * i));
+		Motion motion(Vec3(0.05 * i, 0.3, -0.6), Vec3(-0.7, 0.1 * i, 1.4));
+
+		Part& serialPart = serialParts.emplace_back(boxShape(1.0, 1.5, 0.5 + 0.01 * i), cframe, basicProperties);
+		Part& parallelPart = parallelParts.emplace_back(boxShape(1.0, 1.5, 0.5 + 0.01 * i), cframe, basicProperties);
+		serialPart.ensureHasPhysical();
+		parallelPart.ensureHasPhysical();
+		serialPart.getMainPhysical()->motionOfCenterOfMass = motion;
+		parallelPart.getMainPhysical()->motionOfCenterOfMass = motion;
+		parallelPhysicals.push_back(parallelPart.getMainPhysical());
+	}
+
+	ThreadPool threadPool(4);
+	for(int tick = 0; tick < 20; tick++) {
+		for(int i = 0; i < bodyCount; i++) {
+			serialParts[i].getMainPhysical()->update(DELTA_T);
+		}
+		updatePhysicalsParallel(parallelPhysicals, DELTA_T, threadPool);
+	}
+
+	for(int i = 0; i < bodyCount; i++) {
+		ASSERT(serialParts[i].getCFrame() == parallelParts[i].getCFrame());
+		ASSERT(serialParts[i].getMainPhysical()->motionOfCenterOfMass == parallelParts[i].getMainPhysical()->motionOfCenterOfMass);
+	}
+}
+
+TEST_CASE(handleColissionsParallelMatchesSerial) {
+	WorldPrototype serialWorld(DELTA_T);
+	WorldPrototype parallelWorld(DELTA_T);
+	const int pileCount = 6;
+	const int pileHeight = 4;
+	std::vector<Part> serialParts;
+	std::vector<Part> parallelParts;
+	serialParts.reserve(pileCount * pileHeight + 1);
+	parallelParts.reserve(pileCount * pileHeight + 1);
+	for(WorldPrototype* world : {&serialWorld, &parallelWorld}) {
+		std::vector<Part>& parts = (world == &serialWorld) ? serialParts : parallelParts;
+		world->addExternalForce(new DirectionalGravity(Vec3(0, -10, 0)));
+		parts.emplace_back(boxShape(30.0, 1.0, 30.0), GlobalCFrame(0.0, 0.0, 0.0), basicProperties);
+		world->addTerrainPart(&parts.back());
+		for(int pile = 0; pile < pileCount; pile++) {
+			for(int i = 0; i < pileHeight; i++) {
+				GlobalCFrame cframe(pile * 3.0 - 8.0, 1.0 + i * 0.95, 0.1 * i, Rotation::fromEulerAngles(0.1 * i, 0.3 * pile, -0.05 * i));
+				parts.emplace_back(boxShape(1.0, 1.0, 1.0), cframe, basicProperties);
+				world->addPart(&parts.back());
+			}
+		}
+	}
+
+	ThreadPool threadPool(4);
+	std::size_t maxPartitionCount = 0;
+	for(int tick = 0; tick < 100; tick++) {
+		findColissions(serialWorld, serialWorld.curColissions);
+		findColissions(parallelWorld, parallelWorld.curColissions);
+		applyExternalForces(serialWorld);
+		applyExternalForces(parallelWorld);
+
+		handleColissions(serialWorld.curColissions);
+		handleColissionsParallel(parallelWorld, threadPool);
+		maxPartitionCount = std::max(maxPartitionCount, parallelWorld.colissionPartition.getPartitionCount());
+
+		update(serialWorld);
+		update(parallelWorld);
+
+		for(std::size_t i = 1; i < serialParts.size(); i++) {
+			ASSERT_TRUE(serialParts[i].getCFrame().getPosition() == parallelParts[i].getCFrame().getPosition());
+			ASSERT_TRUE(serialParts[i].getMainPhysical()->motionOfCenterOfMass.getVelocity() == parallelParts[i].getMainPhysical()->motionOfCenterOfMass.getVelocity());
+			ASSERT_TRUE(serialParts[i].getMainPhysical()->motionOfCenterOfMass.getAngularVelocity() == parallelParts[i].getMainPhysical()->motionOfCenterOfMass.getAngularVelocity());
+		}
+	}
+	// the piles must have been handled as separate islands
+	ASSERT_TRUE(maxPartitionCount >= pileCount);
+
+	for(std::size_t i = 0; i < serialParts.size(); i++) {
+		serialParts[i].removeFromWorld();
+		parallelParts[i].removeFromWorld();
+	}
+}
+
+static std::thread::id visualLogThread;
+static std::atomic<int> loggedIntersectionPoints;
+static std::atomic<int> loggedForces;
+static std::atomic<int> visualLogsOnOtherThreads;
+
+TEST_CASE(visualLogRedirectBuffersUntilFlush) {
+	visualLogThread = std::this_thread::get_id();
+	loggedIntersectionPoints = 0;
+	loggedForces = 0;
+	visualLogsOnOtherThreads = 0;
+	Debug::setPointLogAction([](Position, Debug::PointType type) {
+		if(std::this_thread::get_id() != visualLogThread) visualLogsOnOtherThreads++;
+		if(type == Debug::INTERSECTION) loggedIntersectionPoints++;
+	});
+	Debug::setVectorLogAction([](Position, Vec3, Debug::VectorType type) {
+		if(std::this_thread::get_id() != visualLogThread) visualLogsOnOtherThreads++;
+		if(type == Debug::FORCE) loggedForces++;
+	});
+
+	Debug::VisualLogBuffer buffer;
+	std::thread worker([&buffer]() {
+		Debug::VisualLogRedirect redirect(buffer);
+		Debug::logPoint(Position(1.0, 2.0, 3.0), Debug::INTERSECTION);
+		Debug::logVector(Position(1.0, 2.0, 3.0), Vec3(0.0, 1.0, 0.0), Debug::FORCE);
+		Debug::logVector(Position(1.0, 2.0, 3.0), Vec3(1.0, 0.0, 0.0), Debug::FORCE);
+	});
+	worker.join();
+	int pointsBeforeFlush = loggedIntersectionPoints;
+	buffer.flush();
+	int pointsAfterFlush = loggedIntersectionPoints;
+	int forcesAfterFlush = loggedForces;
+	buffer.flush();
+
+	Debug::setPointLogAction([](Position, Debug::PointType) {});
+	Debug::setVectorLogAction([](Position, Vec3, Debug::VectorType) {});
+
+	ASSERT_TRUE(pointsBeforeFlush == 0);
+	ASSERT_TRUE(visualLogsOnOtherThreads.load() == 0);
+	// flushing empties the buffer
+	ASSERT_TRUE(loggedIntersectionPoints.load() == pointsAfterFlush);
+	ASSERT_TRUE(loggedForces.load() == forcesAfterFlush);
+#if P3D_DEBUG_VIS
+	ASSERT_TRUE(pointsAfterFlush == 1);
+	ASSERT_TRUE(forcesAfterFlush == 2);
+#endif
+}
+
+TEST_CASE(handleColissionsParallelLogsOnCallingThread) {
+	WorldPrototype serialWorld(DELTA_T);
+	WorldPrototype parallelWorld(DELTA_T);
+	const int boxCount = 40;
+	std::vector<Part> serialParts;
+	std::vector<Part> parallelParts;
+	serialParts.reserve(boxCount + 1);
+	parallelParts.reserve(boxCount + 1);
+	for(WorldPrototype* world : {&serialWorld, &parallelWorld}) {
+		std::vector<Part>& parts = (world == &serialWorld) ? serialParts : parallelParts;
+		parts.emplace_back(boxShape(200.0, 1.0, 2.0), GlobalCFrame(0.0, 0.0, 0.0), basicProperties);
+		world->addTerrainPart(&parts.back());
+		for(int i = 0; i < boxCount; i++) {
+			parts.emplace_back(boxShape(1.0, 1.0, 1.0), GlobalCFrame(i * 3.0 - 60.0, 0.9, 0.0), basicProperties);
+			world->addPart(&parts.back());
+		}
+	}
+
+	visualLogThread = std::this_thread::get_id();
+	Debug::setPointLogAction([](Position, Debug::PointType type) {
+		if(std::this_thread::get_id() != visualLogThread) visualLogsOnOtherThreads++;
+		if(type == Debug::INTERSECTION) loggedIntersectionPoints++;
+	});
+	Debug::setVectorLogAction([](Position, Vec3, Debug::VectorType type) {
+		if(std::this_thread::get_id() != visualLogThread) visualLogsOnOtherThreads++;
+		if(type == Debug::FORCE) loggedForces++;
+	});
+
+	ThreadPool threadPool(4);
+	findColissions(serialWorld, serialWorld.curColissions);
+	findColissions(parallelWorld, parallelWorld.curColissions);
+
+	loggedIntersectionPoints = 0;
+	loggedForces = 0;
+	handleColissions(serialWorld.curColissions);
+	int serialPoints = loggedIntersectionPoints;
+	int serialForces = loggedForces;
+
+	loggedIntersectionPoints = 0;
+	loggedForces = 0;
+	visualLogsOnOtherThreads = 0;
+	handleColissionsParallel(parallelWorld, threadPool);
+	int parallelPoints = loggedIntersectionPoints;
+	int parallelForces = loggedForces;
+
+	Debug::setPointLogAction([](Position, Debug::PointType) {});
+	Debug::setVectorLogAction([](Position, Vec3, Debug::VectorType) {});
+
+	// every colission logs on the calling thread, none are lost in the per chunk buffers
+	ASSERT_TRUE(visualLogsOnOtherThreads.load() == 0);
+	ASSERT_TRUE(parallelPoints == serialPoints);
+	ASSERT_TRUE(parallelForces == serialForces);
+#if P3D_DEBUG_VIS
+	ASSERT_TRUE(serialPoints == boxCount);
+#endif
+
+	for(std::size_t i = 0; i < serialParts.size(); i++) {
+		serialParts[i].removeFromWorld();
+		parallelParts[i].removeFromWorld();
+	}
+}
+
+static void hashBytes(std::uint64_t& hash, const void* data, std::size_t size) {
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	for(std::size_t i = 0; i < size; i++) {
+		hash = (hash ^ bytes[i]) * 1099511628211ULL;
+	}
+}
+
+static std::uint64_t hashWorldState(const WorldPrototype& world) {
+	std::uint64_t hash = 14695981039346656037ULL;
+	for(const MotorizedPhysical* phys : world.physicals) {
+		GlobalCFrame cframe = phys->getCFrame();
+		Mat3 rotation = cframe.getRotation().asRotationMatrix();
+		Vec3 velocity = phys->motionOfCenterOfMass.getVelocity();
+		Vec3 angularVelocity = phys->motionOfCenterOfMass.getAngularVelocity();
+		hashBytes(hash, &cframe.position, sizeof(cframe.position));
+		hashBytes(hash, &rotation, sizeof(rotation));
+		hashBytes(hash, &velocity, sizeof(velocity));
+		hashBytes(hash, &angularVelocity, sizeof(angularVelocity));
+	}
+	return hash;
+}
+
+TEST_CASE(deterministicThreadingIndependentOfThreadCount) {
+	const int boxCount = 60;
+	std::uint64_t hashes[4];
+	std::size_t threadCounts[4]{1, 2, 8, 32};
+	for(int run = 0; run < 4; run++) {
+		WorldPrototype world(DELTA_T);
+		world.useDeterministicThreading = true;
+		world.useParallelColissionResponse = true;
+		world.addExternalForce(new DirectionalGravity(Vec3(0, -10, 0)));
+
+		std::vector<Part> parts;
+		parts.reserve(boxCount + 1);
+		parts.emplace_back(boxShape(20.0, 1.0, 20.0), GlobalCFrame(0.0, 0.0, 0.0), basicProperties);
+		world.addTerrainPart(&parts.back());
+		for(int i = 0; i < boxCount; i++) {
+			GlobalCFrame cframe(i % 5 * 1.3 - 3.0, 1.0 + i / 5 * 0.9, i % 3 * 0.4, Rotation::fromEulerAngles(0.1 * i, -0.2 * i, 0.05 * i));
+			parts.emplace_back((i % 2 == 0) ? boxShape(1.0, 0.8, 1.2) : sphereShape(0.5), cframe, basicProperties);
+			world.addPart(&parts.back());
+		}
+
+		ThreadPool threadPool(threadCounts[run]);
+		for(int tick = 0; tick < 200; tick++) {
+			tickWorldUnsynchronized(world, threadPool);
+		}
+		hashes[run] = hashWorldState(world);
+
+		for(Part& part : parts) {
+			part.removeFromWorld();
+		}
+	}
+	for(int run = 1; run < 4; run++) {
+		ASSERT_STRICT(hashes[run] == hashes[0]);
+	}
+}
+
+TEST_CASE(colissionEventsBeginPersistEnd) {
+	WorldPrototype world(DELTA_T);
+	world.colissionEvents.enabled = true;
+
+	Part floor(boxShape(10.0, 1.0, 10.0), GlobalCFrame(0.0, 0.0, 0.0), basicProperties);
+	Part box(boxShape(1.0, 1.0, 1.0), GlobalCFrame(0.0, 0.9, 0.0), basicProperties);
+	world.addTerrainPart(&floor);
+	world.addPart(&box);
+
+	std::vector<ColissionEvent> taken;
+	ASSERT_STRICT(world.colissionEvents.takeEvents(taken) == 0u);
+	const std::vector<ColissionEvent>& events = world.colissionEvents.getEvents();
+
+	world.tick();
+	ASSERT_STRICT(events.size() == 1u);
+	ASSERT_TRUE(events[0].type == ColissionEventType::BEGIN);
+	ASSERT_TRUE(events[0].p1 == &box && events[0].p2 == &floor);
+	ASSERT_TRUE(events[0].normal.y < -0.9);
+	ASSERT_TRUE(events[0].impulse.y > 0.0);
+
+	world.tick();
+	ASSERT_STRICT(events.size() == 1u);
+	ASSERT_TRUE(events[0].type == ColissionEventType::PERSIST);
+
+	box.setCFrame(GlobalCFrame(0.0, 5.0, 0.0));
+	world.tick();
+	ASSERT_STRICT(events.size() == 1u);
+	ASSERT_TRUE(events[0].type == ColissionEventType::END);
+	ASSERT_TRUE(events[0].p1 == &box);
+	ASSERT_TRUE(events[0].impulse == Vec3(0.0, 0.0, 0.0));
+
+	world.tick();
+	ASSERT_TRUE(events.empty());
+
+	ASSERT_STRICT(world.colissionEvents.takeEvents(taken) == 4u);
+	ASSERT_STRICT(taken.size() == 3u);
+	ASSERT_TRUE(taken[0].type == ColissionEventType::BEGIN && taken[1].type == ColissionEventType::PERSIST && taken[2].type == ColissionEventType::END);
+
+	// pairs in layers outside the mask produce no events
+	world.colissionEvents.layerMask = ~LayerMask(1);
+	box.setCFrame(GlobalCFrame(0.0, 0.9, 0.0));
+	world.tick();
+	ASSERT_TRUE(events.empty());
+
+	world.colissionEvents.layerMask = ALL_LAYERS;
+	box.setCFrame(GlobalCFrame(0.0, 0.9, 0.0));
+	world.tick();
+	ASSERT_STRICT(events.size() == 1u);
+	ASSERT_TRUE(events[0].type == ColissionEventType::BEGIN);
+
+	// removed parts end their contacts silently
+	world.removePart(&box);
+	world.tick();
+	ASSERT_TRUE(events.empty());
+}
+
+TEST_CASE(snapshotsMatchPartsAndKeepIDs) {
+	WorldPrototype world(DELTA_T);
+	world.snapshots.enabled = true;
+	ASSERT_FALSE(world.snapshots.acquire().isValid());
+
+	Part floor(boxShape(10.0, 1.0, 10.0), GlobalCFrame(0.0, 0.0, 0.0), basicProperties);
+	Part boxA(boxShape(1.0, 1.0, 1.0), GlobalCFrame(0.0, 3.0, 0.0), basicProperties);
+	Part boxB(boxShape(1.0, 1.0, 1.0), GlobalCFrame(3.0, 3.0, 0.0), basicProperties);
+	world.addTerrainPart(&floor);
+	world.addPart(&boxA);
+	world.addPart(&boxB);
+	boxA.getMainPhysical()->setVelocity(Vec3(1.0, 0.0, 0.0));
+
+	world.tick();
+	std::uint32_t idA = boxA.snapshotID;
+	std::uint32_t idB = boxB.snapshotID;
+	{
+		WorldSnapshotReader reader = world.snapshots.acquire();
+		ASSERT_TRUE(reader.isValid());
+		ASSERT_STRICT(reader->age == world.age);
+		ASSERT_STRICT(reader->size() == 3u);
+		for(const Part* part : {&floor, &boxA, &boxB}) {
+			ASSERT_TRUE(reader->isPresent[part->snapshotID] == 1);
+			ASSERT_TRUE(reader->cframes[part->snapshotID].getPosition() == part->getCFrame().getPosition());
+			ASSERT_TRUE(reader->motions[part->snapshotID].getVelocity() == part->getMotion().getVelocity());
+		}
+		ASSERT_TRUE(reader->motions[floor.snapshotID].getVelocity() == Vec3(0.0, 0.0, 0.0));
+		ASSERT_TRUE(reader->motions[idA].getVelocity().x > 0.9);
+	}
+
+	world.tick();
+	ASSERT_STRICT(boxA.snapshotID == idA);
+	ASSERT_STRICT(boxB.snapshotID == idB);
+
+	// the ID of a removed part is reused by the next new part
+	world.removePart(&boxB);
+	Part boxC(sphereShape(0.5), GlobalCFrame(-3.0, 3.0, 0.0), basicProperties);
+	world.tick();
+	ASSERT_FALSE(world.snapshots.acquire()->isPresent[idB] == 1);
+	world.addPart(&boxC);
+	world.tick();
+	ASSERT_STRICT(boxC.snapshotID == idB);
+	WorldSnapshotReader reader = world.snapshots.acquire();
+	ASSERT_STRICT(reader->size() == 3u);
+	ASSERT_TRUE(reader->cframes[idB].getPosition() == boxC.getCFrame().getPosition());
+}
+
+TEST_CASE(heldSnapshotsStayUnchanged) {
+	WorldPrototype world(DELTA_T);
+	world.snapshots.enabled = true;
+	world.addExternalForce(new DirectionalGravity(Vec3(0, -10, 0)));
+
+	Part box(boxShape(1.0, 1.0, 1.0), GlobalCFrame(0.0, 3.0, 0.0), basicProperties);
+	world.addPart(&box);
+
+	world.tick();
+	WorldSnapshotReader held = world.snapshots.acquire();
+	Position heldPosition = held->cframes[box.snapshotID].getPosition();
+	for(int i = 0; i < 5; i++) {
+		world.tick();
+	}
+	ASSERT_STRICT(held->age == 1u);
+	ASSERT_TRUE(held->cframes[box.snapshotID].getPosition() == heldPosition);
+	ASSERT_STRICT(world.snapshots.skippedPublishes.load() == 0u);
+	ASSERT_STRICT(world.snapshots.acquire()->age == 6u);
+
+	// once readers hold every buffer but the latest, the tick skips its publish
+	held.release();
+	std::vector<WorldSnapshotReader> readers;
+	for(int i = 0; i < WORLD_SNAPSHOT_MAX_READERS + 2; i++) {
+		readers.push_back(world.snapshots.acquire());
+		world.tick();
+	}
+	ASSERT_STRICT(world.snapshots.skippedPublishes.load() == 1u);
+	ASSERT_STRICT(world.snapshots.acquire()->age == world.age - 1);
+	readers.clear();
+	world.tick();
+	ASSERT_STRICT(world.snapshots.acquire()->age == world.age);
+}
+
+TEST_CASE(snapshotReadersSeeConsistentTicks) {
+	const int partCount = 20;
+	WorldPrototype world(DELTA_T);
+	world.snapshots.enabled = true;
+
+	std::vector<Part> parts;
+	parts.reserve(partCount);
+	for(int i = 0; i < partCount; i++) {
+		parts.emplace_back(boxShape(1.0, 1.0, 1.0), GlobalCFrame(i * 3.0, 0.0, 0.0), basicProperties);
+		world.addPart(&parts.back());
+		parts.back().getMainPhysical()->setVelocity(Vec3(0.0, 1.0 + i, 0.0));
+	}
+
+	// without forces every part moves by its velocity each tick, a torn snapshot would mix the positions of different ticks
+	std::atomic<bool> done(false);
+	std::atomic<int> inconsistentReads(0);
+	std::atomic<int> reads(0);
+	std::thread readerThread([&]() {
+		std::size_t lastAge = 0;
+		while(!done.load()) {
+			WorldSnapshotReader reader = world.snapshots.acquire();
+			if(!reader.isValid()) continue;
+			if(reader->age < lastAge) inconsistentReads++;
+			lastAge = reader->age;
+			for(int i = 0; i < partCount; i++) {
+				double expectedY = reader->age * DELTA_T * (1.0 + i);
+				double y = static_cast<double>(reader->cframes[parts[i].snapshotID].getPosition().y);
+				if(std::abs(y - expectedY) > 0.001) inconsistentReads++;
+			}
+			reads++;
+		}
+	});
+	for(int tick = 0; tick < 500; tick++) {
+		world.tick();
+	}
+	done.store(true);
+	readerThread.join();
+
+	ASSERT_STRICT(inconsistentReads.load() == 0);
+	ASSERT_TRUE(reads.load() > 0);
+	for(Part& part : parts) {
+		part.removeFromWorld();
+	}
+}
+
+TEST_CASE(queuedCommandsApplyInOrderAtTick) {
+	WorldPrototype world(DELTA_T);
+
+	Part floor(boxShape(10.0, 1.0, 10.0), GlobalCFrame(0.0, -5.0, 0.0), basicProperties);
+	Part boxA(boxShape(1.0, 1.0, 1.0), GlobalCFrame(0.0, 3.0, 0.0), basicProperties);
+	Part boxB(boxShape(1.0, 1.0, 1.0), GlobalCFrame(5.0, 3.0, 0.0), basicProperties);
+	world.commands.addTerrainPart(&floor);
+	world.commands.addPart(&boxA);
+	world.commands.setCFrame(&boxA, GlobalCFrame(0.0, 4.0, 0.0));
+	world.commands.applyImpulse(&boxA, boxA.getCFrame().getPosition(), Vec3(1.0, 0.0, 0.0));
+	ASSERT_TRUE(world.commands.hasCommands());
+	ASSERT_TRUE(boxA.layer == nullptr);
+
+	world.tick();
+	ASSERT_FALSE(world.commands.hasCommands());
+	ASSERT_TRUE(floor.layer != nullptr && boxA.layer != nullptr);
+	ASSERT_TRUE(world.isValid());
+	ASSERT_TRUE(boxA.getMotion().getVelocity().x > 0.0);
+	ASSERT_TRUE(static_cast<double>(boxA.getCFrame().getPosition().y) > 3.5);
+
+	world.commands.attach(&boxA, &boxB, CFrame(2.0, 0.0, 0.0));
+	world.tick();
+	ASSERT_TRUE(boxB.getMainPhysical() == boxA.getMainPhysical());
+	ASSERT_TRUE(world.isValid());
+
+	world.commands.detach(&boxB);
+	world.commands.removePart(&boxA);
+	world.tick();
+	ASSERT_TRUE(boxA.layer == nullptr);
+	ASSERT_TRUE(boxB.layer != nullptr);
+	ASSERT_TRUE(world.isValid());
+
+	world.removePart(&boxB);
+	world.removePart(&floor);
+}
+
+TEST_CASE(queuedCommandsFromManyThreads) {
+	const int threadCount = 4;
+	const int partsPerThread = 50;
+	WorldPrototype world(DELTA_T);
+	UpgradeableMutex worldMutex;
+	ThreadPool threadPool(2);
+
+	std::vector<Part> parts;
+	parts.reserve(threadCount * partsPerThread);
+	for(int i = 0; i < threadCount * partsPerThread; i++) {
+		parts.emplace_back(boxShape(1.0, 1.0, 1.0), GlobalCFrame(i * 2.0, 0.0, 0.0), basicProperties);
+	}
+
+	// producers never touch worldMutex while the world keeps ticking
+	std::vector<std::thread> producers;
+	for(int t = 0; t < threadCount; t++) {
+		producers.emplace_back([&parts, &world, t]() {
+			for(int i = t * partsPerThread; i < (t + 1) * partsPerThread; i++) {
+				world.commands.addPart(&parts[i]);
+				world.commands.setCFrame(&parts[i], GlobalCFrame(i * 2.0, 1.0, 0.0));
+			}
+		});
+	}
+	for(int tick = 0; tick < 20; tick++) {
+		tickWorldSynchronized(world, threadPool, worldMutex);
+	}
+	for(std::thread& producer : producers) {
+		producer.join();
+	}
+	tickWorldSynchronized(world, threadPool, worldMutex);
+
+	ASSERT_STRICT(world.physicals.size() == parts.size());
+	ASSERT_TRUE(world.isValid());
+	for(Part& part : parts) {
+		ASSERT_TRUE(part.layer != nullptr);
+		ASSERT_TRUE(static_cast<double>(part.getCFrame().getPosition().y) > 0.5);
+		part.removeFromWorld();
+	}
+}
+
+#if P3D_PROFILING
+TEST_CASE(threadedProfilerMergesThreads) {
+	const char* labels[static_cast<std::size_t>(PhysicsProcess::COUNT)];
+	for(const char*& label : labels) {
+		label = "";
+	}
+	ThreadedBreakdownProfiler<PhysicsProcess> profiler(labels, 10);
+	ThreadPool threadPool(4);
+
+	std::atomic<std::size_t> threadsRun(0);
+	profiler.mark(PhysicsProcess::COLISSION_OTHER);
+	threadPool.doInParallel([&profiler, &threadsRun]() {
+		threadsRun++;
+		PhysicsProcess previousProcess = profiler.getCurrentProcess();
+		profiler.mark(PhysicsProcess::GJK_COL);
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		profiler.mark(previousProcess);
+	});
+	ASSERT_TRUE(profiler.getCurrentProcess() == PhysicsProcess::COLISSION_OTHER);
+	profiler.end();
+	ASSERT_TRUE(profiler.getCurrentProcess() == ThreadedBreakdownProfiler<PhysicsProcess>::NO_PROCESS);
+
+	// every thread that ran spent 5ms in GJK_COL, the sleeping threads took almost no CPU time
+	ASSERT_STRICT(profiler.lastTickThreadTimes.size() == threadsRun.load());
+	std::chrono::nanoseconds gjkTime = profiler.history.front()[static_cast<std::size_t>(PhysicsProcess::GJK_COL)];
+	ASSERT_TRUE(gjkTime >= std::chrono::milliseconds(5) * threadsRun.load());
+	ASSERT_TRUE(profiler.history.front()[static_cast<std::size_t>(PhysicsProcess::COLISSION_OTHER)] > std::chrono::nanoseconds(0));
+	ASSERT_TRUE(profiler.cpuTimeHistory.front() < gjkTime);
+
+	profiler.end();
+	ASSERT_TRUE(profiler.lastTickThreadTimes.empty());
+	ASSERT_TRUE(profiler.history.front()[static_cast<std::size_t>(PhysicsProcess::GJK_COL)] == std::chrono::nanoseconds(0));
+}
+
+TEST_CASE(profilersOnOneThreadKeepTheirOwnState) {
+	const char* labels[static_cast<std::size_t>(PhysicsProcess::COUNT)];
+	for(const char*& label : labels) {
+		label = "";
+	}
+
+	// a profiler created where a destroyed one was starts out fresh
+	for(int i = 0; i < 2; i++) {
+		ThreadedBreakdownProfiler<PhysicsProcess> profiler(labels, 10);
+		ASSERT_TRUE(profiler.getCurrentProcess() == ThreadedBreakdownProfiler<PhysicsProcess>::NO_PROCESS);
+		profiler.mark(PhysicsProcess::GJK_COL);
+		ASSERT_TRUE(profiler.getCurrentProcess() == PhysicsProcess::GJK_COL);
+	}
+
+	ThreadedBreakdownProfiler<PhysicsProcess> first(labels, 10);
+	ThreadedBreakdownProfiler<PhysicsProcess> second(labels, 10);
+	first.mark(PhysicsProcess::GJK_COL);
+	second.mark(PhysicsProcess::EPA);
+	ASSERT_TRUE(first.getCurrentProcess() == PhysicsProcess::GJK_COL);
+	ASSERT_TRUE(second.getCurrentProcess() == PhysicsProcess::EPA);
+}
+#endif
+
+static std::size_t countOccurrences(const std::string& str, const std::string& part) {
+	std::size_t count = 0;
+	for(std::size_t i = str.find(part); i != std::string::npos; i = str.find(part, i + 1)) {
+		count++;
+	}
+	return count;
+}
+
+TEST_CASE(tracersOnOneThreadKeepTheirOwnEvents) {
+	std::chrono::high_resolution_clock::time_point now = std::chrono::high_resolution_clock::now();
+
+	// a tracer created where a destroyed one was starts out empty
+	for(int i = 0; i < 2; i++) {
+		EventTracer tracer(8);
+		tracer.enabled = true;
+		tracer.record("Event", now, now);
+		std::ostringstream out;
+		tracer.writeJSON(out);
+		ASSERT_STRICT(countOccurrences(out.str(), "\"ph\":\"X\"") == 1u);
+	}
+
+	EventTracer first(8);
+	EventTracer second(8);
+	first.enabled = true;
+	second.enabled = true;
+	first.record("First", now, now);
+	second.record("Second", now, now);
+	first.record("First", now, now);
+	std::ostringstream firstOut;
+	first.writeJSON(firstOut);
+	std::ostringstream secondOut;
+	second.writeJSON(secondOut);
+	ASSERT_STRICT(countOccurrences(firstOut.str(), "\"name\":\"First\"") == 2u);
+	ASSERT_STRICT(countOccurrences(firstOut.str(), "\"name\":\"Second\"") == 0u);
+	ASSERT_STRICT(countOccurrences(secondOut.str(), "\"name\":\"Second\"") == 1u);
+}
+
+#if P3D_PROFILING
+TEST_CASE(tracerRecordsProcessesAndScopes) {
+	const char* labels[static_cast<std::size_t>(PhysicsProcess::COUNT)];
+	for(const char*& label : labels) {
+		label = "Process";
+	}
+	labels[static_cast<std::size_t>(PhysicsProcess::GJK_COL)] = "GJK Col";
+	EventTracer tracer(64);
+	ThreadedBreakdownProfiler<PhysicsProcess> profiler(labels, 10, &tracer);
+	ThreadPool threadPool(3);
+
+	// not every thread of the pool is guaranteed to run the work
+	std::atomic<std::size_t> threadsRun(0);
+	tracer.enabled = true;
+	profiler.mark(PhysicsProcess::COLISSION_OTHER);
+	threadPool.doInParallel([&]() {
+		threadsRun++;
+		PhysicsProcess previousProcess = profiler.getCurrentProcess();
+		profiler.mark(PhysicsProcess::GJK_COL);
+		{
+			TraceScope scope(tracer, "User \"scope\"");
+		}
+		profiler.mark(previousProcess);
+	});
+	profiler.end();
+
+	std::ostringstream out;
+	tracer.writeJSON(out);
+	std::string json = out.str();
+	ASSERT_TRUE(json.front() == '{');
+	ASSERT_TRUE(json.find("]}") != std::string::npos);
+	ASSERT_STRICT(countOccurrences(json, "\"thread_name\"") == threadsRun.load());
+	ASSERT_STRICT(countOccurrences(json, "\"name\":\"GJK Col\"") == threadsRun.load());
+	ASSERT_STRICT(countOccurrences(json, "\"name\":\"User \\\"scope\\\"\"") == threadsRun.load());
+	// COLISSION_OTHER of the calling thread is cut in two by its own GJK_COL
+	ASSERT_STRICT(countOccurrences(json, "\"name\":\"Process\"") == 2u);
+
+	// a disabled tracer records nothing
+	tracer.clear();
+	tracer.enabled = false;
+	profiler.mark(PhysicsProcess::COLISSION_OTHER);
+	{
+		TraceScope scope(tracer, "Not traced");
+	}
+	profiler.end();
+	std::ostringstream disabledOut;
+	tracer.writeJSON(disabledOut);
+	ASSERT_STRICT(countOccurrences(disabledOut.str(), "\"ph\":\"X\"") == 0u);
+}
+
+TEST_CASE(tracerCapturesByTickCountAndSlowTicks) {
+	const char* labels[static_cast<std::size_t>(PhysicsProcess::COUNT)];
+	for(const char*& label : labels) {
+		label = "Process";
+	}
+	EventTracer tracer(64);
+	ThreadedBreakdownProfiler<PhysicsProcess> profiler(labels, 10, &tracer);
+	std::string path = (std::filesystem::temp_directory_path() / "p3dTracerTest.json").string();
+	tracer.outputPath = path;
+
+	tracer.captureTicksSlowerThan = std::chrono::milliseconds(2);
+	tracer.enabled = true;
+	profiler.mark(PhysicsProcess::UPDATING);
+	profiler.end();
+	ASSERT_STRICT(tracer.captureCount == 0u);
+	profiler.mark(PhysicsProcess::UPDATING);
+	std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	profiler.end();
+	ASSERT_STRICT(tracer.captureCount == 1u);
+	ASSERT_TRUE(std::filesystem::exists(path));
+
+	tracer.captureTicksSlowerThan = std::chrono::nanoseconds(0);
+	tracer.captureAfterTicks = 4;
+	profiler.mark(PhysicsProcess::UPDATING);
+	profiler.end();
+	ASSERT_TRUE(tracer.enabled);
+	profiler.mark(PhysicsProcess::UPDATING);
+	profiler.end();
+	ASSERT_STRICT(tracer.captureCount == 2u);
+	ASSERT_FALSE(tracer.enabled);
+
+	std::ifstream file(path);
+	std::stringstream contents;
+	contents << file.rdbuf();
+	ASSERT_STRICT(countOccurrences(contents.str(), "\"ph\":\"X\"") == 4u);
+	file.close();
+	std::filesystem::remove(path);
+}
+#endif
+
+static const PartProperties restingProperties{1.0, 0.8, 0.0};
+
+TEST_CASE(restingStackFallsAsleepAndWakes) {
+	WorldPrototype world(DELTA_T);
+	world.useSleeping = true;
+	world.addExternalForce(new DirectionalGravity(Vec3(0, -1, 0)));
+
+	Part floor(boxShape(10.0, 1.0, 10.0), GlobalCFrame(0.0, 0.0, 0.0), restingProperties);
+	Part bottom(boxShape(1.0, 1.0, 1.0), GlobalCFrame(0.0, 1.05, 0.0), restingProperties);
+	Part top(boxShape(1.0, 1.0, 1.0), GlobalCFrame(0.0, 2.1, 0.0), restingProperties);
+	world.addTerrainPart(&floor);
+	world.addPart(&bottom);
+	world.addPart(&top);
+	MotorizedPhysical* bottomPhys = bottom.getMainPhysical();
+	MotorizedPhysical* topPhys = top.getMainPhysical();
+
+	for(int i = 0; i < 2000 && !(bottomPhys->isAsleep && topPhys->isAsleep); i++) {
+		world.tick();
+	}
+	ASSERT_TRUE(bottomPhys->isAsleep);
+	ASSERT_TRUE(topPhys->isAsleep);
+
+	Position restingPosition = top.getCFrame().getPosition();
+	for(int i = 0; i < 100; i++) {
+		world.tick();
+	}
+	ASSERT_TRUE(topPhys->isAsleep);
+	ASSERT_STRICT(top.getCFrame().getPosition() == restingPosition);
+	ASSERT_STRICT(world.curColissions.freePartColissions.size() == 0u);
+
+	// a box dropped on top wakes the stack it lands on
+	Part dropped(boxShape(1.0, 1.0, 1.0), GlobalCFrame(0.0, 3.5, 0.0), restingProperties);
+	world.addPart(&dropped);
+	bool topWoken = false;
+	bool bottomWoken = false;
+	for(int i = 0; i < 200 && !(topWoken && bottomWoken); i++) {
+		world.tick();
+		topWoken = topWoken || !topPhys->isAsleep;
+		bottomWoken = bottomWoken || !bottomPhys->isAsleep;
+	}
+	ASSERT_TRUE(topWoken);
+	ASSERT_TRUE(bottomWoken);
+
+	world.removePart(&dropped);
+	world.removePart(&top);
+	world.removePart(&bottom);
+	world.removePart(&floor);
+}
+
+TEST_CASE(sleepingContactsPersistInColissionEvents) {
+	WorldPrototype world(DELTA_T);
+	world.useSleeping = true;
+	world.colissionEvents.enabled = true;
+	world.addExternalForce(new DirectionalGravity(Vec3(0, -1, 0)));
+
+	Part floor(boxShape(10.0, 1.0, 10.0), GlobalCFrame(0.0, 0.0, 0.0), restingProperties);
+	Part box(boxShape(1.0, 1.0, 1.0), GlobalCFrame(0.0, 1.05, 0.0), restingProperties);
+	world.addTerrainPart(&floor);
+	world.addPart(&box);
+	MotorizedPhysical* boxPhys = box.getMainPhysical();
+	const std::vector<ColissionEvent>& events = world.colissionEvents.getEvents();
+
+	for(int i = 0; i < 2000 && !boxPhys->isAsleep; i++) {
+		world.tick();
+	}
+	ASSERT_TRUE(boxPhys->isAsleep);
+
+	// the sleeping box skips the narrow phase, but its contact with the floor doesn't end
+	for(int i = 0; i < 10; i++) {
+		world.tick();
+		ASSERT_STRICT(events.size() == 1u);
+		ASSERT_TRUE(events[0].type == ColissionEventType::PERSIST);
+		ASSERT_TRUE(events[0].p1 == &box && events[0].p2 == &floor);
+		ASSERT_TRUE(events[0].impulse == Vec3(0.0, 0.0, 0.0));
+	}
+
+	// nor does it begin again once the box wakes
+	boxPhys->setVelocity(Vec3(0.0, 0.0, 0.0));
+	ASSERT_FALSE(boxPhys->isAsleep);
+	world.tick();
+	ASSERT_STRICT(events.size() == 1u);
+	ASSERT_TRUE(events[0].type == ColissionEventType::PERSIST);
+
+	world.removePart(&box);
+	world.removePart(&floor);
+}
+
+TEST_CASE(linkedPhysicalsSleepAndWakeAsOneIsland) {
+	WorldPrototype world(DELTA_T);
+	world.useSleeping = true;
+
+	Part a(boxShape(1.0, 1.0, 1.0), GlobalCFrame(0.0, 0.0, 0.0), restingProperties);
+	Part b(boxShape(1.0, 1.0, 1.0), GlobalCFrame(3.0, 0.0, 0.0), restingProperties);
+	Part loner(boxShape(1.0, 1.0, 1.0), GlobalCFrame(0.0, 0.0, 3.0), restingProperties);
+	world.addPart(&a);
+	world.addPart(&b);
+	world.addPart(&loner);
+	world.addLink(new SpringLink(AttachedPart{CFrame(), &a}, AttachedPart{CFrame(), &b}, 3.0, 1.0));
+	MotorizedPhysical* physA = a.getMainPhysical();
+	MotorizedPhysical* physB = b.getMainPhysical();
+	MotorizedPhysical* physLoner = loner.getMainPhysical();
+
+	for(int i = 0; i < world.ticksBeforeSleep; i++) {
+		ASSERT_FALSE(physA->isAsleep);
+		world.tick();
+	}
+	ASSERT_TRUE(physA->isAsleep && physB->isAsleep && physLoner->isAsleep);
+	ASSERT_STRICT(physA->sleepingIslandID == physB->sleepingIslandID);
+	ASSERT_TRUE(physA->sleepingIslandID != physLoner->sleepingIslandID);
+
+	physA->setVelocity(Vec3(0.0, 1.0, 0.0));
+	ASSERT_FALSE(physA->isAsleep);
+	ASSERT_TRUE(physB->isAsleep);
+	world.tick();
+	ASSERT_FALSE(physB->isAsleep);
+	ASSERT_TRUE(physLoner->isAsleep);
+	ASSERT_TRUE(a.getCFrame().getPosition().y > 0.0);
+
+	world.removePart(&a);
+	world.removePart(&b);
+	world.removePart(&loner);
+}
+
+TEST_CASE(sleepingPhysicalWakesWhenMovedOrPushed) {
+	WorldPrototype world(DELTA_T);
+	world.useSleeping = true;
+	world.addExternalForce(new DirectionalGravity(Vec3(0, -10, 0)));
+
+	Part floor(boxShape(10.0, 1.0, 10.0), GlobalCFrame(0.0, 0.0, 0.0), basicProperties);
+	Part box(boxShape(1.0, 1.0, 1.0), GlobalCFrame(0.0, 1.05, 0.0), basicProperties);
+	world.addTerrainPart(&floor);
+	world.addPart(&box);
+	MotorizedPhysical* phys = box.getMainPhysical();
+
+	auto tickUntilAsleep = [&]() {
+		for(int i = 0; i < 2000 && !phys->isAsleep; i++) {
+			world.tick();
+		}
+		return phys->isAsleep;
+	};
+
+	ASSERT_TRUE(tickUntilAsleep());
+	box.setCFrame(GlobalCFrame(0.0, 3.0, 0.0));
+	ASSERT_FALSE(phys->isAsleep);
+	world.tick();
+	ASSERT_TRUE(box.getCFrame().getPosition().y < 3.0); // falls again
+
+	ASSERT_TRUE(tickUntilAsleep());
+	phys->applyForceAtCenterOfMass(Vec3(50.0, 0.0, 0.0));
+	ASSERT_FALSE(phys->isAsleep);
+	world.tick();
+	ASSERT_TRUE(phys->getVelocityOfCenterOfMass().x > 0.0);
+
+	ASSERT_TRUE(tickUntilAsleep());
+	phys->setVelocity(Vec3(0.0, 5.0, 0.0));
+	world.tick();
+	ASSERT_TRUE(box.getCFrame().getPosition().y > 1.0);
+
+	world.removePart(&box);
+	world.removePart(&floor);
+}
+
+TEST_CASE(sleepingDoesNotChangeMovingPhysicals) {
+	WorldPrototype sleepingWorld(DELTA_T);
+	WorldPrototype normalWorld(DELTA_T);
+	sleepingWorld.useSleeping = true;
+	std::vector<Part> sleepingParts;
+	std::vector<Part> normalParts;
+	sleepingParts.reserve(10);
+	normalParts.reserve(10);
+	for(WorldPrototype* world : {&sleepingWorld, &normalWorld}) {
+		std::vector<Part>& parts = (world == &sleepingWorld) ? sleepingParts : normalParts;
+		world->addExternalForce(new DirectionalGravity(Vec3(0, -10, 0)));
+		parts.emplace_back(boxShape(20.0, 1.0, 20.0), GlobalCFrame(0.0, 0.0, 0.0), basicProperties);
+		world->addTerrainPart(&parts.back());
+		for(int i = 0; i < 9; i++) {
+			parts.emplace_back(boxShape(1.0, 1.0, 1.0), GlobalCFrame(i % 3 * 1.5, 1.0 + i * 0.7, i / 3 * 1.5, Rotation::fromEulerAngles(0.1 * i, 0.2, -0.1 * i)), basicProperties);
+			world->addPart(&parts.back());
+		}
+	}
+
+	// nothing can rest long enough to sleep yet, so the sleeping bookkeeping must not change the simulation
+	for(int tick = 0; tick < sleepingWorld.ticksBeforeSleep - 1; tick++) {
+		sleepingWorld.tick();
+		normalWorld.tick();
+	}
+	for(int i = 1; i < 10; i++) {
+		ASSERT_FALSE(sleepingParts[i].getMainPhysical()->isAsleep);
+		ASSERT(sleepingParts[i].getCFrame() == normalParts[i].getCFrame());
+	}
+
+	for(int i = 0; i < 10; i++) {
+		sleepingParts[i].removeFromWorld();
+		normalParts[i].removeFromWorld();
+	}
+}
+
 TEST_CASE(angularMomentumVelocityInvariance) {
 	std::vector<Part> phys = produceMotorizedPhysical();
 
@@ -1032,3 +2026,228 @@ TEST_CASE(setVelocity) {
 		}
 	}
 }
+
+TEST_CASE(latencyHistogramPercentiles) {
+	LatencyHistogram histogram;
+	ASSERT_STRICT(histogram.getPercentile(99.0).count() == 0);
+
+	// 1us to 1000us
+	for(long long i = 1; i <= 1000; i++) {
+		histogram.record(std::chrono::microseconds(i));
+	}
+	ASSERT_STRICT(histogram.getCount() == 1000u);
+	ASSERT_TRUE(histogram.getMin() == std::chrono::microseconds(1));
+	ASSERT_TRUE(histogram.getMax() == std::chrono::microseconds(1000));
+	ASSERT_TRUE(histogram.getMean() == std::chrono::nanoseconds(500500));
+	ASSERT_TRUE(histogram.getPercentile(100.0) == std::chrono::microseconds(1000));
+	std::pair<double, long long> expectedPercentiles[]{{50.0, 500000}, {90.0, 900000}, {99.0, 990000}, {99.9, 999000}};
+	for(std::pair<double, long long> expected : expectedPercentiles) {
+		long long value = histogram.getPercentile(expected.first).count();
+		ASSERT_TRUE(value >= expected.second && value <= expected.second + expected.second / 64);
+	}
+
+	// small values are exact
+	histogram.reset();
+	ASSERT_STRICT(histogram.getCount() == 0u);
+	for(long long i = 0; i < 100; i++) {
+		histogram.record(std::chrono::nanoseconds(i));
+	}
+	ASSERT_STRICT(histogram.getPercentile(50.0).count() == 49);
+	ASSERT_STRICT(histogram.getPercentile(99.0).count() == 98);
+}
+
+#if P3D_PROFILING
+TEST_CASE(profilerRecordsLatencyHistograms) {
+	const char* labels[static_cast<std::size_t>(PhysicsProcess::COUNT)];
+	for(const char*& label : labels) {
+		label = "Process";
+	}
+	labels[static_cast<std::size_t>(PhysicsProcess::UPDATING)] = "Updates";
+	ThreadedBreakdownProfiler<PhysicsProcess> profiler(labels, 10);
+
+	for(int i = 0; i < 5; i++) {
+		profiler.mark(PhysicsProcess::UPDATING);
+		std::this_thread::sleep_for(std::chrono::milliseconds(i == 4 ? 6 : 1));
+		profiler.mark(PhysicsProcess::OTHER);
+		profiler.end();
+	}
+	// a tick without marks has no start
+	profiler.end();
+
+	ASSERT_STRICT(profiler.getTickLatency().getCount() == 5u);
+	ASSERT_STRICT(profiler.getProcessLatency(PhysicsProcess::UPDATING).getCount() == 6u);
+	ASSERT_TRUE(profiler.getTickLatency().getMax() >= std::chrono::milliseconds(6));
+	ASSERT_TRUE(profiler.getProcessLatency(PhysicsProcess::UPDATING).getPercentile(50.0) >= std::chrono::milliseconds(1));
+	ASSERT_TRUE(profiler.getProcessLatency(PhysicsProcess::UPDATING).getPercentile(50.0) < profiler.getProcessLatency(PhysicsProcess::UPDATING).getMax());
+
+	std::ostringstream csv;
+	writeLatencyCSV(csv, profiler.getLatencyHistograms());
+	ASSERT_STRICT(countOccurrences(csv.str(), "\n") == static_cast<std::size_t>(PhysicsProcess::COUNT) + 2);
+	ASSERT_STRICT(countOccurrences(csv.str(), "\nTick,5,") == 1u);
+	ASSERT_STRICT(countOccurrences(csv.str(), "\nUpdates,6,") == 1u);
+
+	std::ostringstream json;
+	writeLatencyJSON(json, profiler.getLatencyHistograms());
+	ASSERT_STRICT(countOccurrences(json.str(), "\"Tick\":{\"count\":5,") == 1u);
+	ASSERT_STRICT(countOccurrences(json.str(), "\"p999_us\"") == static_cast<std::size_t>(PhysicsProcess::COUNT) + 1);
+
+	profiler.resetLatency();
+	ASSERT_STRICT(profiler.getTickLatency().getCount() == 0u);
+}
+
+TEST_CASE(hardwareCountersAttributeToProcessesOrDegrade) {
+	const char* labels[static_cast<std::size_t>(PhysicsProcess::COUNT)];
+	for(const char*& label : labels) {
+		label = "Process";
+	}
+	labels[static_cast<std::size_t>(PhysicsProcess::UPDATING)] = "Updates";
+	ThreadedBreakdownProfiler<PhysicsProcess> profiler(labels, 10);
+	profiler.hardwareCountersEnabled = true;
+
+	volatile double sum = 0.0;
+	for(int tick = 0; tick < 3; tick++) {
+		profiler.mark(PhysicsProcess::UPDATING);
+		for(int i = 0; i < 100000; i++) {
+			sum = sum + i * 0.5;
+		}
+		profiler.mark(PhysicsProcess::OTHER);
+		profiler.end();
+	}
+	ASSERT_STRICT(profiler.getTickLatency().getCount() == 3u);
+
+	ThreadHardwareCounters probe;
+	std::ostringstream csv;
+	writeLatencyCSV(csv, profiler.getLatencyHistograms());
+	if(probe.open()) {
+		ASSERT_STRICT(profiler.getProcessCounters(PhysicsProcess::UPDATING).getTickCount() == 3u);
+		ASSERT_TRUE(profiler.getProcessCounters(PhysicsProcess::UPDATING).getTotals()[HardwareCounter::INSTRUCTIONS] > 100000);
+		ASSERT_TRUE(profiler.getProcessCounters(PhysicsProcess::UPDATING).getTotals()[HardwareCounter::INSTRUCTIONS] > profiler.getProcessCounters(PhysicsProcess::OTHER).getTotals()[HardwareCounter::INSTRUCTIONS]);
+		ASSERT_TRUE(csv.str().find(",ipc\n") != std::string::npos);
+	} else {
+		// no counters on this machine, time is still profiled
+		ASSERT_STRICT(profiler.getTickCounters().getTickCount() == 0u);
+		ASSERT_TRUE(csv.str().find("cycles") == std::string::npos);
+		ASSERT_TRUE(probe.read()[HardwareCounter::CYCLES] == 0);
+	}
+}
+#endif
+
+TEST_CASE(latencyExportsIncludeHardwareCounts) {
+	LatencyHistogram histogram;
+	histogram.record(std::chrono::microseconds(10));
+	HardwareCounterTotals counters;
+	HardwareCounterValues tickValues;
+	tickValues[HardwareCounter::CYCLES] = 1000;
+	tickValues[HardwareCounter::INSTRUCTIONS] = 2000;
+	tickValues[HardwareCounter::LLC_MISSES] = 3;
+	tickValues[HardwareCounter::BRANCH_MISSES] = 4;
+	counters.addTick(tickValues);
+	counters.addTick(tickValues);
+	LatencyHistogram uncounted;
+
+	std::vector<NamedLatencyHistogram> histograms{{"Counted", &histogram, &counters}, {"Uncounted", &uncounted}};
+	std::ostringstream csv;
+	writeLatencyCSV(csv, histograms);
+	ASSERT_TRUE(csv.str().find("max_us,cycles_per_tick,instructions_per_tick,llc_misses_per_tick,branch_misses_per_tick,ipc\n") != std::string::npos);
+	ASSERT_TRUE(csv.str().find(",1000.000,2000.000,3.000,4.000,2.000\n") != std::string::npos);
+	ASSERT_TRUE(csv.str().find("\nUncounted,0,0.000,0.000,0.000,0.000,0.000,0.000,0.000,,,,,\n") != std::string::npos);
+
+	std::ostringstream json;
+	writeLatencyJSON(json, histograms);
+	ASSERT_STRICT(countOccurrences(json.str(), "\"ipc\":2.000") == 1u);
+	ASSERT_STRICT(countOccurrences(json.str(), "\"llc_misses_per_tick\"") == 1u);
+}
+
+// only measures when compiled with P3D_ALLOCATION_TRACKING
+TEST_CASE_SLOW(manyCubesSteadyStateAllocations) {
+	if(!AllocationTracker::isCompiledIn()) return;
+
+	WorldPrototype world(0.005);
+	world.addExternalForce(new DirectionalGravity(Vec3(0, -10, 0)));
+	world.addTerrainPart(new Part(boxShape(50.0, 1.0, 50.0), GlobalCFrame(0.0, 0.0, 0.0), basicProperties));
+	GlobalCFrame ref(0, 15, 0, Rotation::fromEulerAngles(3.1415 / 4, 3.1415 / 4, 0.0));
+	for(double x = -5; x < 5; x += 1.01) {
+		for(double y = -5; y < 5; y += 1.01) {
+			for(double z = -5; z < 5; z += 1.01) {
+				world.addPart(new Part(polyhedronShape(ShapeLibrary::createBox(1.0, 1.0, 1.0)), ref.localToGlobal(CFrame(x, y, z)), basicProperties));
+			}
+		}
+	}
+	auto runTicks = [&world](int tickCount) {
+		for(int i = 0; i < tickCount; i++) {
+			physicsMeasure.mark(PhysicsProcess::OTHER);
+			world.tick();
+			physicsMeasure.end();
+		}
+	};
+
+	// the pile settles and every buffer reaches its steady state size
+	runTicks(200);
+	const int TICK_COUNT = 1000;
+	AllocationTracker::reset();
+	AllocationTracker::enabled = true;
+	runTicks(TICK_COUNT);
+	AllocationTracker::enabled = false;
+
+	AllocationCounts total = AllocationTracker::getTotalCounts();
+	Log::print("Allocations per tick: %.1f, %.0f bytes\n", double(total.allocations) / TICK_COUNT, double(total.bytes) / TICK_COUNT);
+	for(std::size_t i = 0; i < static_cast<std::size_t>(PhysicsProcess::COUNT); i++) {
+		AllocationCounts counts = AllocationTracker::getCounts(static_cast<PhysicsProcess>(i));
+		if(counts.allocations == 0) continue;
+		Log::print("  %s: %.1f, %.0f bytes\n", physicsMeasure.labels[i], double(counts.allocations) / TICK_COUNT, double(counts.bytes) / TICK_COUNT);
+	}
+
+	// steady state ticks only reuse memory, whatever a tick allocates it frees again
+	ASSERT_TRUE(total.allocations > 0);
+	ASSERT_TRUE(total.frees + TICK_COUNT >= total.allocations);
+}
+
+TEST_CASE(intersectionPairStatisticsByShapeClass) {
+	IntersectionPairStatistics statistics;
+	statistics.record(CONVEX_POLYHEDRON_CLASS_ID, SPHERE_CLASS_ID, true, std::chrono::microseconds(3), 5, 7);
+	statistics.record(SPHERE_CLASS_ID, CONVEX_POLYHEDRON_CLASS_ID, false, std::chrono::microseconds(1), 2, 0);
+	statistics.record(CUBE_CLASS_ID, CUBE_CLASS_ID, false, std::chrono::microseconds(2), 3, 0);
+	// IDs beyond the matrix are counted together
+	statistics.record(100, 200, false, std::chrono::microseconds(1), 1, 0);
+
+	IntersectionPairCounts sphereVsPolyhedron = statistics.getCounts(SPHERE_CLASS_ID, CONVEX_POLYHEDRON_CLASS_ID);
+	ASSERT_STRICT(sphereVsPolyhedron.calls == 2u);
+	ASSERT_STRICT(sphereVsPolyhedron.hits == 1u);
+	ASSERT_TRUE(sphereVsPolyhedron.time == std::chrono::microseconds(4));
+	ASSERT_STRICT(sphereVsPolyhedron.gjkIterations == 7u);
+	ASSERT_STRICT(sphereVsPolyhedron.epaIterations == 7u);
+	ASSERT_STRICT(statistics.getCounts(150, 101).calls == 1u);
+
+	std::vector<IntersectionPair> pairs = statistics.getPairs();
+	ASSERT_STRICT(pairs.size() == 3u);
+	ASSERT_STRICT(pairs[0].firstClassID == std::size_t(SPHERE_CLASS_ID));
+	ASSERT_STRICT(pairs[0].secondClassID == std::size_t(CONVEX_POLYHEDRON_CLASS_ID));
+
+	std::ostringstream csv;
+	statistics.writeCSV(csv);
+	ASSERT_TRUE(csv.str().find("\nSphere,Polyhedron,2,1,0.500,0.004,2.000,3.500,7.000\n") != std::string::npos);
+	ASSERT_TRUE(csv.str().find("\nOther,Other,1,") != std::string::npos);
+
+	statistics.reset();
+	ASSERT_STRICT(statistics.getPairs().size() == 0u);
+
+	// narrowphase calls are recorded in intersectionPairStatistics
+	if(P3D_PROFILING) {
+		intersectionPairStatistics.reset();
+		Shape sphere = sphereShape(1.0);
+		Shape box = boxShape(1.0, 1.0, 1.0);
+		Shape polyhedron = polyhedronShape(ShapeLibrary::createBox(1.0, 1.0, 1.0));
+		ASSERT_TRUE(intersectsTransformed(sphere, box, CFrame(1.0, 0.0, 0.0)).has_value());
+		ASSERT_FALSE(intersectsTransformed(polyhedron, box, CFrame(3.0, 0.0, 0.0)).has_value());
+
+		IntersectionPairCounts sphereVsBox = intersectionPairStatistics.getCounts(CUBE_CLASS_ID, SPHERE_CLASS_ID);
+		ASSERT_STRICT(sphereVsBox.calls == 1u);
+		ASSERT_STRICT(sphereVsBox.hits == 1u);
+		ASSERT_TRUE(sphereVsBox.gjkIterations > 0);
+		ASSERT_TRUE(sphereVsBox.epaIterations > 0);
+		IntersectionPairCounts boxVsPolyhedron = intersectionPairStatistics.getCounts(CONVEX_POLYHEDRON_CLASS_ID, CUBE_CLASS_ID);
+		ASSERT_STRICT(boxVsPolyhedron.calls == 1u);
+		ASSERT_STRICT(boxVsPolyhedron.hits == 0u);
+		ASSERT_STRICT(boxVsPolyhedron.epaIterations == 0u);
+	}
+}
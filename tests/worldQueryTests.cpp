@@ -0,0 +1,357 @@
+#include "testsMain.h"
+
+#include "compare.h"
+#include "generators.h"
+#include <Physics3D/misc/toString.h>
+
+#include <Physics3D/world.h>
+#include <Physics3D/worldIteration.h>
+#include <Physics3D/geometry/shape.h>
+#include <Physics3D/geometry/shapeCreation.h>
+#include <Physics3D/misc/cpuid.h>
+#include <Physics3D/geometry/intersection.h>
+#include <Physics3D/boundstree/filters/visibilityFilter.h>
+
+#include <vector>
+#include <set>
+#include <limits>
+#include <algorithm>
+
+using namespace P3D;
+#define ASSERT(v) ASSERT_TOLERANT(v, 0.0005)
+
+static const PartProperties basicProperties{0.7, 0.2, 0.6};
+
+// fills the world with a 5x5x5 grid of rotated boxes and spheres
+static void createPartGrid(WorldPrototype& world, std::vector<Part>& parts) {
+	parts.reserve(125);
+	for(int x = 0; x < 5; x++) {
+		for(int y = 0; y < 5; y++) {
+			for(int z = 0; z < 5; z++) {
+				GlobalCFrame cframe(Position(x * 4.0, y * 4.0, z * 4.0), Rotation::fromEulerAngles(0.3 * x, 0.2 * y, 0.5 * z));
+				Shape shape = ((x + y + z) % 2 == 0) ? boxShape(1.0 + 0.2 * x, 1.5, 2.0) : sphereShape(0.8 + 0.1 * z);
+				parts.emplace_back(shape, cframe, basicProperties);
+			}
+		}
+	}
+	for(Part& p : parts) {
+		world.addPart(&p);
+	}
+}
+
+static double bruteForceRaycast(const std::vector<Part>& parts, const Ray& ray, const Part*& hitPart) {
+	double nearest = std::numeric_limits<float>::max();
+	hitPart = nullptr;
+	for(const Part& p : parts) {
+		double distance = p.hitbox.getIntersectionDistance(p.getCFrame().globalToLocal(ray.origin), p.getCFrame().relativeToLocal(ray.direction));
+		if(distance >= 0.0 && distance < nearest) {
+			nearest = distance;
+			hitPart = &p;
+		}
+	}
+	return nearest;
+}
+
+static Ray generateRayTowardsGrid() {
+	Position origin(generateDouble(-20.0, 36.0), generateDouble(-20.0, 36.0), generateDouble(-20.0, 36.0));
+	Position target(generateDouble(0.0, 16.0), generateDouble(0.0, 16.0), generateDouble(0.0, 16.0));
+	return Ray{origin, normalize(Vec3(target - origin))};
+}
+
+TEST_CASE(raycastHitsNearestPartWithNormal) {
+	WorldPrototype world(0.01);
+
+	Part nearBox(boxShape(2.0, 2.0, 2.0), GlobalCFrame(Position(0.0, 0.0, 0.0)), basicProperties);
+	Part farBox(boxShape(2.0, 2.0, 2.0), GlobalCFrame(Position(6.0, 0.0, 0.0)), basicProperties);
+	world.addPart(&farBox);
+	world.addPart(&nearBox);
+
+	Ray ray{Position(-10.0, 0.1, 0.2), Vec3(1.0, 0.0, 0.0)};
+
+	RaycastHit hit = world.raycast(ray);
+	ASSERT_TRUE(hit.hasHit());
+	ASSERT_TRUE(hit.part == &nearBox);
+	ASSERT(hit.distance == 9.0);
+	ASSERT(hit.position == Position(-1.0, 0.1, 0.2));
+	ASSERT(hit.normal == Vec3(-1.0, 0.0, 0.0));
+
+	ASSERT_FALSE(world.raycast(ray, 8.5).hasHit());
+
+	Ray backwards{Position(-10.0, 0.1, 0.2), Vec3(-1.0, 0.0, 0.0)};
+	ASSERT_FALSE(world.raycast(backwards).hasHit());
+}
+
+TEST_CASE(raycastRespectsLayerMask) {
+	WorldPrototype world(0.01);
+	int otherLayer = world.createLayer(true, true);
+
+	Part defaultLayerBox(boxShape(2.0, 2.0, 2.0), GlobalCFrame(Position(6.0, 0.0, 0.0)), basicProperties);
+	Part otherLayerBox(boxShape(2.0, 2.0, 2.0), GlobalCFrame(Position(0.0, 0.0, 0.0)), basicProperties);
+	world.addPart(&defaultLayerBox);
+	world.addPart(&otherLayerBox, otherLayer);
+
+	Ray ray{Position(-10.0, 0.0, 0.0), Vec3(1.0, 0.0, 0.0)};
+
+	ASSERT_TRUE(world.raycast(ray).part == &otherLayerBox);
+	ASSERT_TRUE(world.raycast(ray, std::numeric_limits<float>::max(), ~(LayerMask(1) << otherLayer)).part == &defaultLayerBox);
+	ASSERT_FALSE(world.raycast(ray, std::numeric_limits<float>::max(), 0).hasHit());
+}
+
+TEST_CASE(raycastMatchesBruteForce) {
+	WorldPrototype world(0.01);
+	std::vector<Part> parts;
+	createPartGrid(world, parts);
+
+	for(int i = 0; i < 200; i++) {
+		Ray ray = generateRayTowardsGrid();
+		const Part* expectedPart;
+		double expectedDistance = bruteForceRaycast(parts, ray, expectedPart);
+
+		RaycastHit hit = world.raycast(ray);
+		ASSERT_TRUE(hit.part == expectedPart);
+		if(expectedPart != nullptr) {
+			ASSERT(hit.distance == expectedDistance);
+		}
+	}
+}
+
+static void compareRaycastManyToRaycast(const WorldPrototype& world) {
+	// a coherent fan of rays, like a sensor would cast
+	std::vector<Ray> rays;
+	for(int i = 0; i < 61; i++) {
+		double angle = -0.6 + 0.02 * i;
+		rays.push_back(Ray{Position(-10.0, 7.0, 8.0), Vec3(std::cos(angle), 0.1 * std::sin(3 * angle), std::sin(angle))});
+	}
+	for(int i = 0; i < 19; i++) {
+		rays.push_back(generateRayTowardsGrid());
+	}
+
+	std::vector<RaycastHit> hits(rays.size());
+	world.raycastMany(rays.data(), rays.size(), hits.data(), 30.0);
+
+	for(std::size_t i = 0; i < rays.size(); i++) {
+		RaycastHit expected = world.raycast(rays[i], 30.0);
+		ASSERT_TRUE(hits[i].part == expected.part);
+		// both paths run the same exact test, but may be contracted to fma differently under fast math
+		if(expected.hasHit()) {
+			ASSERT(hits[i].distance == expected.distance);
+			ASSERT(hits[i].normal == expected.normal);
+		}
+	}
+}
+
+TEST_CASE(raycastManyMatchesRaycast) {
+	WorldPrototype world(0.01);
+	std::vector<Part> parts;
+	createPartGrid(world, parts);
+
+	compareRaycastManyToRaycast(world);
+
+	bool hadAVX = CPUIDCheck::hasTechnology(CPUIDCheck::AVX);
+	CPUIDCheck::disableTechnology(CPUIDCheck::AVX);
+	compareRaycastManyToRaycast(world);
+	if(hadAVX) CPUIDCheck::enableTechnology(CPUIDCheck::AVX);
+}
+
+static std::set<Part*> bruteForceOverlaps(std::vector<Part>& parts, const Shape& shape, const GlobalCFrame& cframe) {
+	std::set<Part*> result;
+	for(Part& p : parts) {
+		if(intersectsTransformed(p.hitbox, shape, p.getCFrame().globalToLocal(cframe))) {
+			result.insert(&p);
+		}
+	}
+	return result;
+}
+
+TEST_CASE(overlapQueriesMatchBruteForce) {
+	WorldPrototype world(0.01);
+	std::vector<Part> parts;
+	createPartGrid(world, parts);
+
+	Part* found[125];
+	for(int i = 0; i < 50; i++) {
+		Position center(generateDouble(-2.0, 18.0), generateDouble(-2.0, 18.0), generateDouble(-2.0, 18.0));
+		double size = generateDouble(0.5, 5.0);
+
+		Shape sphere = sphereShape(size);
+		std::set<Part*> expectedInSphere = bruteForceOverlaps(parts, sphere, GlobalCFrame(center));
+		std::size_t sphereCount = world.querySphere(center, size, found, 125);
+		ASSERT_STRICT(sphereCount == expectedInSphere.size());
+		ASSERT_TRUE(std::set<Part*>(found, found + sphereCount) == expectedInSphere);
+
+		Bounds box(center - Vec3(size, size * 0.5, size * 2.0), center + Vec3(size, size * 0.5, size * 2.0));
+		std::set<Part*> expectedInBox = bruteForceOverlaps(parts, boxShape(size * 2.0, size, size * 4.0), GlobalCFrame(center));
+		std::size_t boxCount = world.queryBox(box, found, 125);
+		ASSERT_STRICT(boxCount == expectedInBox.size());
+		ASSERT_TRUE(std::set<Part*>(found, found + boxCount) == expectedInBox);
+
+		GlobalCFrame shapeCFrame(center, Rotation::fromEulerAngles(generateDouble(-1.0, 1.0), generateDouble(-1.0, 1.0), generateDouble(-1.0, 1.0)));
+		Shape cylinder = cylinderShape(size * 0.5, size * 3.0);
+		std::set<Part*> expectedInShape = bruteForceOverlaps(parts, cylinder, shapeCFrame);
+		std::size_t shapeCount = world.queryShape(cylinder, shapeCFrame, found, 125);
+		ASSERT_STRICT(shapeCount == expectedInShape.size());
+		ASSERT_TRUE(std::set<Part*>(found, found + shapeCount) == expectedInShape);
+	}
+
+	// results past maxResults are counted but not written
+	Part* single[1];
+	ASSERT_STRICT(world.querySphere(Position(8.0, 8.0, 8.0), 6.0, single, 1) > 1u);
+}
+
+static float distanceSquaredToBounds(const BoundsTemplate<float>& bounds, const Vec3f& point) {
+	float dx = std::max(std::max(bounds.min.x - point.x, point.x - bounds.max.x), 0.0f);
+	float dy = std::max(std::max(bounds.min.y - point.y, point.y - bounds.max.y), 0.0f);
+	float dz = std::max(std::max(bounds.min.z - point.z, point.z - bounds.max.z), 0.0f);
+	return dx * dx + dy * dy + dz * dz;
+}
+
+TEST_CASE(queryKNearestMatchesBruteForce) {
+	WorldPrototype world(0.01);
+	std::vector<Part> parts;
+	createPartGrid(world, parts);
+
+	Part terrain(boxShape(100.0, 1.0, 100.0), GlobalCFrame(Position(8.0, -30.0, 8.0)), basicProperties);
+	world.addTerrainPart(&terrain);
+
+	Part* found[8];
+	float distancesSq[8];
+	for(int i = 0; i < 50; i++) {
+		Position point(generateDouble(-20.0, 36.0), generateDouble(-40.0, 36.0), generateDouble(-20.0, 36.0));
+		Vec3f treePoint = castPositionToVec3f(point);
+
+		std::vector<float> expectedDistancesSq;
+		for(const Part& p : parts) {
+			expectedDistancesSq.push_back(distanceSquaredToBounds(p.getBounds(), treePoint));
+		}
+		expectedDistancesSq.push_back(distanceSquaredToBounds(terrain.getBounds(), treePoint));
+		std::sort(expectedDistancesSq.begin(), expectedDistancesSq.end());
+
+		ASSERT_STRICT(world.queryKNearest(point, 8, found, distancesSq) == 8u);
+		for(int k = 0; k < 8; k++) {
+			ASSERT_TOLERANT(distancesSq[k] == expectedDistancesSq[k], 0.001);
+			ASSERT_TOLERANT(distanceSquaredToBounds(found[k]->getBounds(), treePoint) == distancesSq[k], 0.001);
+		}
+	}
+
+	WorldPrototype emptyWorld(0.01);
+	ASSERT_STRICT(emptyWorld.queryKNearest(Position(0.0, 0.0, 0.0), 8, found, distancesSq) == 0u);
+}
+
+TEST_CASE(forEachPartInFrustumMatchesVisibilityFilter) {
+	WorldPrototype world(0.01);
+	std::vector<Part> parts;
+	createPartGrid(world, parts);
+
+	for(int i = 0; i < 20; i++) {
+		Position origin(generateDouble(-20.0, 36.0), generateDouble(-20.0, 36.0), generateDouble(-20.0, 36.0));
+		Vec3 forward = normalize(Vec3(Position(8.0, 8.0, 8.0) - origin));
+		Vec3 up = normalize(forward % Vec3(0.0, 1.0, 0.0) % forward);
+		VisibilityFilter filter = VisibilityFilter::forWindow(origin, forward, up, 0.6, 1.5, 40.0);
+
+		std::set<Part*> expected;
+		world.forEachPart([&](Part& part) {
+			if(filter(Bounds(part.getBounds()))) expected.insert(&part);
+		});
+
+		std::set<Part*> found;
+		world.forEachPartInFrustum(filter.getTreeFrustum(), [&](Part& part) {
+			found.insert(&part);
+		});
+		ASSERT_TRUE(found == expected);
+	}
+}
+
+TEST_CASE(shapeCastFindsAnalyticTimeOfImpact) {
+	WorldPrototype world(0.01);
+
+	Part box(boxShape(2.0, 2.0, 2.0), GlobalCFrame(Position(0.0, 0.0, 0.0)), basicProperties);
+	Part ball(sphereShape(1.0), GlobalCFrame(Position(0.0, -10.0, 0.0)), basicProperties);
+	world.addPart(&box);
+	world.addPart(&ball);
+
+	ShapeCastHit sphereHit = world.shapeCast(sphereShape(0.5), GlobalCFrame(Position(-5.0, 0.3, 0.2)), Vec3(10.0, 0.0, 0.0));
+	ASSERT_TRUE(sphereHit.part == &box);
+	ASSERT(sphereHit.timeOfImpact == 0.35);
+	// the contact point is only as exact as the simplex GJK ends with
+	ASSERT_TOLERANT(sphereHit.position == Position(-1.0, 0.3, 0.2), 0.01);
+	ASSERT(sphereHit.normal == Vec3(-1.0, 0.0, 0.0));
+
+	ShapeCastHit boxHit = world.shapeCast(boxShape(1.0, 1.0, 1.0), GlobalCFrame(Position(0.0, -5.0, 0.0)), Vec3(0.0, -10.0, 0.0));
+	ASSERT_TRUE(boxHit.part == &ball);
+	ASSERT(boxHit.timeOfImpact == 0.35);
+	ASSERT(boxHit.position == Position(0.0, -9.0, 0.0));
+	ASSERT(boxHit.normal == Vec3(0.0, 1.0, 0.0));
+
+	ASSERT_FALSE(world.shapeCast(sphereShape(0.5), GlobalCFrame(Position(-5.0, 0.3, 0.2)), Vec3(3.0, 0.0, 0.0)).hasHit());
+	ASSERT_FALSE(world.shapeCast(sphereShape(0.5), GlobalCFrame(Position(-5.0, 0.3, 0.2)), Vec3(-10.0, 0.0, 0.0)).hasHit());
+	ASSERT_FALSE(world.shapeCast(sphereShape(0.5), GlobalCFrame(Position(-5.0, 1.6, 0.2)), Vec3(10.0, 0.0, 0.0)).hasHit());
+	ASSERT_FALSE(world.shapeCast(sphereShape(0.5), GlobalCFrame(Position(-5.0, 0.3, 0.2)), Vec3(10.0, 0.0, 0.0), 0).hasHit());
+
+	ShapeCastHit startInside = world.shapeCast(sphereShape(0.5), GlobalCFrame(Position(0.5, 0.0, 0.0)), Vec3(10.0, 0.0, 0.0));
+	ASSERT_TRUE(startInside.part == &box);
+	ASSERT_STRICT(startInside.timeOfImpact == 0.0);
+}
+
+TEST_CASE(shapeCastDoesNotTunnelThroughThinParts) {
+	WorldPrototype world(0.01);
+
+	Part wall(boxShape(0.01, 4.0, 4.0), GlobalCFrame(Position(0.0, 0.0, 0.0), Rotation::fromEulerAngles(0.0, 0.3, 0.0)), basicProperties);
+	world.addPart(&wall);
+
+	// samples at the start and end of the motion are both far from the wall
+	Shape box = boxShape(0.2, 0.2, 0.2);
+	GlobalCFrame start(Position(-50.0, 0.5, 0.0), Rotation::fromEulerAngles(0.4, 0.0, 0.2));
+	ASSERT_FALSE(world.queryShape(box, start, nullptr, 0) != 0);
+	ASSERT_FALSE(world.queryShape(box, GlobalCFrame(start.getPosition() + Vec3(100.0, 0.0, 0.0), start.getRotation()), nullptr, 0) != 0);
+
+	ShapeCastHit hit = world.shapeCast(box, start, Vec3(100.0, 0.0, 0.0));
+	ASSERT_TRUE(hit.part == &wall);
+	ASSERT_TOLERANT(hit.timeOfImpact == 0.5, 0.01);
+	ASSERT_TRUE(hit.normal.x < -0.9);
+}
+
+TEST_CASE(shapeCastMatchesSampledMotion) {
+	WorldPrototype world(0.01);
+	std::vector<Part> parts;
+	createPartGrid(world, parts);
+
+	Shape castShapes[2]{boxShape(0.6, 1.0, 0.4), sphereShape(0.7)};
+	for(int i = 0; i < 100; i++) {
+		const Shape& shape = castShapes[i % 2];
+		Ray ray = generateRayTowardsGrid();
+		GlobalCFrame start(ray.origin, Rotation::fromEulerAngles(generateDouble(-1.0, 1.0), generateDouble(-1.0, 1.0), generateDouble(-1.0, 1.0)));
+		Vec3 motion = ray.direction * 60.0;
+		if(world.queryShape(shape, start, nullptr, 0) != 0) continue;
+		auto placedAt = [&](double t) { return GlobalCFrame(start.getPosition() + motion * t, start.getRotation()); };
+
+		ShapeCastHit hit = world.shapeCast(shape, start, motion);
+		double freeUntil = hit.hasHit() ? std::max(hit.timeOfImpact - 0.001, 0.0) : 1.0;
+		ASSERT_FALSE(world.queryShape(shape, placedAt(freeUntil), nullptr, 0) != 0);
+
+		// no sample along the motion may overlap a part before the cast hit
+		for(int step = 0; step < 200; step++) {
+			double t = step / 200.0;
+			if(t >= freeUntil) break;
+			ASSERT_FALSE(world.queryShape(shape, placedAt(t), nullptr, 0) != 0);
+		}
+
+		if(hit.hasHit()) {
+			// the contact position lies on the surface of both the part and the cast shape at the time of impact, so they are at most 2 * eps apart
+			// checked with the exact shapes, GJK can miss overlaps of shapes that only just touch
+			const double eps = 0.01;
+			GlobalCFrame impact = placedAt(hit.timeOfImpact);
+			const GlobalCFrame& partCFrame = hit.part->getCFrame();
+			Vec3 towardsPartCenter = normalize(Vec3(partCFrame.getPosition() - hit.position));
+			Vec3 towardsShapeCenter = normalize(Vec3(impact.getPosition() - hit.position));
+			ASSERT_TRUE(hit.part->hitbox.containsPoint(partCFrame.globalToLocal(hit.position + towardsPartCenter * eps)));
+			ASSERT_TRUE(shape.containsPoint(impact.globalToLocal(hit.position + towardsShapeCenter * eps)));
+			// shapes that already overlap at the start have no separating normal
+			if(hit.timeOfImpact > 0.0) {
+				ASSERT_FALSE(hit.part->hitbox.containsPoint(partCFrame.globalToLocal(hit.position + hit.normal * eps)));
+				ASSERT_FALSE(shape.containsPoint(impact.globalToLocal(hit.position - hit.normal * eps)));
+			}
+			ASSERT_TOLERANT(length(hit.normal) == 1.0, 0.001);
+			ASSERT_TRUE(hit.normal * motion < 0.0);
+		}
+	}
+}